@@ -0,0 +1,208 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+/** \file benchAllocationPolicies
+ * Replays an add/remove trace against the vdfs MemoryManager with every allocation policy
+ * and reports the resulting dispersion ratio and the time spent for allocations.
+ *
+ * Usage: benchAllocationPolicies [traceFile] [--write-trace outputFile]
+ *   Without a trace file, a synthetic patch trace is generated.
+ *
+ * Trace format, one operation per line:
+ *   + <id> <bytes>   Adds a payload of the given size, identified by id.
+ *   - <id>           Removes the payload identified by id.
+ */
+
+#include <ClippedUtils/cLogger.h>
+#include <ClippedFilesystem/Archives/cVdfsArchive.h>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <unordered_map>
+
+using namespace Clipped;
+
+/**
+ * @brief The TraceOperation struct is a single operation of an add/remove trace.
+ */
+struct TraceOperation
+{
+    bool add;       //!< true for add, false for remove.
+    size_t id;      //!< Identifier of the payload.
+    size_t bytes;   //!< Size of the payload (add only).
+};
+
+bool readTrace(const Path& filepath, std::vector<TraceOperation>& trace);
+bool writeTrace(const Path& filepath, const std::vector<TraceOperation>& trace);
+std::vector<TraceOperation> generateTrace();
+void replay(const std::vector<TraceOperation>& trace, const AllocationPolicy policy, const String& name);
+
+int main(int argc, char** argv)
+{
+    Logger() << Logger::MessageType::Info;
+    std::vector<TraceOperation> trace;
+    Path traceFile;
+    Path outputFile;
+
+    for(int i = 1; i < argc; i++)
+    {
+        String arg = argv[i];
+        if(arg == "--write-trace" && i + 1 < argc)
+            outputFile = argv[++i];
+        else
+            traceFile = arg;
+    }
+
+    if(!traceFile.empty())
+    {
+        if(!readTrace(traceFile, trace))
+        {
+            LogError() << "Can't read trace file: " << traceFile;
+            return 1;
+        }
+    }
+    else
+    {
+        trace = generateTrace();
+    }
+    if(!outputFile.empty() && !writeTrace(outputFile, trace))
+    {
+        LogError() << "Can't write trace file: " << outputFile;
+        return 1;
+    }
+
+    LogInfo() << "Replaying " << trace.size() << " operations.";
+    replay(trace, AllocationPolicy::FIRST_FIT, "first fit");
+    replay(trace, AllocationPolicy::BEST_FIT, "best fit");
+    replay(trace, AllocationPolicy::NEXT_FIT, "next fit");
+    replay(trace, AllocationPolicy::APPEND_ONLY, "append only");
+    return 0;
+}
+
+bool readTrace(const Path& filepath, std::vector<TraceOperation>& trace)
+{
+    std::ifstream input(filepath);
+    if(!input.is_open()) return false;
+
+    char operation;
+    while(input >> operation)
+    {
+        TraceOperation op = {operation == '+', 0, 0};
+        input >> op.id;
+        if(op.add) input >> op.bytes;
+        if(!input) return false;
+        trace.push_back(op);
+    }
+    return true;
+}
+
+bool writeTrace(const Path& filepath, const std::vector<TraceOperation>& trace)
+{
+    std::ofstream output(filepath);
+    if(!output.is_open()) return false;
+
+    for(const auto& op : trace)
+    {
+        if(op.add)
+            output << "+ " << op.id << " " << op.bytes << "\n";
+        else
+            output << "- " << op.id << "\n";
+    }
+    return output.good();
+}
+
+/**
+ * @brief generateTrace creates a trace of an archive, that gets built and then patched many times.
+ *   Payload sizes are log-normal distributed, like assets of a game.
+ * @return the trace.
+ */
+std::vector<TraceOperation> generateTrace()
+{
+    const size_t initialFiles = 20000;
+    const size_t patchOperations = 60000;
+    std::mt19937 random(42);
+    std::lognormal_distribution<double> sizes(9.0, 1.5);
+    std::vector<TraceOperation> trace;
+    std::vector<size_t> alive;
+    size_t nextId = 0;
+
+    for(size_t i = 0; i < initialFiles; i++)
+    {
+        trace.push_back({true, nextId, static_cast<size_t>(sizes(random)) + 1});
+        alive.push_back(nextId++);
+    }
+    for(size_t i = 0; i < patchOperations; i++)
+    {
+        if(!alive.empty() && (random() % 2)) //Replace an existing file: remove and add a new version.
+        {
+            const size_t index = random() % alive.size();
+            trace.push_back({false, alive[index], 0});
+            alive[index] = alive.back();
+            alive.pop_back();
+        }
+        trace.push_back({true, nextId, static_cast<size_t>(sizes(random)) + 1});
+        alive.push_back(nextId++);
+    }
+    return trace;
+}
+
+void replay(const std::vector<TraceOperation>& trace, const AllocationPolicy policy, const String& name)
+{
+    MemoryManager manager;
+    manager.setAllocationPolicy(policy);
+    std::unordered_map<size_t, MemoryBlock> blocks;
+    std::chrono::nanoseconds allocTime(0);
+    size_t allocCount = 0;
+
+    for(const auto& op : trace)
+    {
+        if(op.add)
+        {
+            MemoryBlock block;
+            auto start = std::chrono::steady_clock::now();
+            manager.alloc(op.bytes, block);
+            allocTime += std::chrono::steady_clock::now() - start;
+            allocCount++;
+            blocks[op.id] = block;
+        }
+        else
+        {
+            auto it = blocks.find(op.id);
+            if(it == blocks.end()) continue; //Unknown id - Ignore it.
+            manager.free(it->second);
+            blocks.erase(it);
+        }
+    }
+
+    const double totalMs = std::chrono::duration<double, std::milli>(allocTime).count();
+    LogInfo() << "Policy " << name
+              << ": dispersion ratio " << manager.getDispersionRatio()
+              << ", archive size " << MemorySize(manager.getHandledMemorySize()).toString()
+              << ", free blocks " << manager.getFreeMemoryBlockCount()
+              << ", alloc time " << totalMs << " ms ("
+              << (allocCount ? totalMs * 1000000.0 / allocCount : 0.0) << " ns/alloc)";
+}
@@ -0,0 +1,122 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+/** \file benchDirectoryLookup
+ * Creates a loose directory tree and the same files in a vdfs archive. Compares the lookup of
+ * every file in the DirectoryArchive cache and the archive with a filesystem stat per file.
+ *
+ * Usage: benchDirectoryLookup [fileCount]
+ */
+
+#include <ClippedUtils/cLogger.h>
+#include <ClippedFilesystem/cExplorer.h>
+#include <ClippedFilesystem/cFile.h>
+#include <ClippedFilesystem/Archives/cDirectoryArchive.h>
+#include <ClippedFilesystem/Archives/cVdfsArchive.h>
+#include <chrono>
+
+using namespace Clipped;
+
+Path pathOf(const size_t i)
+{
+    return String("Dir" + String((int)(i % 16)) + "/file" + String((int)i) + ".dat");
+}
+
+/**
+ * @brief measure runs a lookup for every path.
+ * @return the time per lookup in ns or a negative value, if a lookup failed.
+ */
+template <class Lookup>
+double measure(const std::vector<Path>& paths, Lookup lookup)
+{
+    auto start = std::chrono::steady_clock::now();
+    for(const Path& path : paths)
+    {
+        if(!lookup(path)) return -1.0;
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e9 / paths.size();
+}
+
+int main(int argc, char** argv)
+{
+    Logger() << Logger::MessageType::Info;
+    const size_t fileCount = (1 < argc) ? std::stoul(argv[1]) : 10000;
+    const Path root = "benchDirectoryLookup";
+    const Path archivePath = "benchDirectoryLookup.vdfs";
+    const std::vector<char> content(16, 'x');
+
+    Explorer::Remove(root, true);
+    VDFSArchive vdfs(archivePath);
+    if(!Explorer::CreateDir(root) || !vdfs.create()) return 1;
+    for(size_t dir = 0; dir < 16; dir++)
+    {
+        if(!Explorer::CreateDir(String(root + "/Dir" + String((int)dir)))) return 1;
+    }
+    std::vector<Path> paths;
+    for(size_t i = 0; i < fileCount; i++)
+    {
+        paths.push_back(pathOf(i));
+        NativeFile file(String(root + "/" + paths.back()));
+        if(!file.open(FileAccessMode::TRUNC) || !file.writeAt(0, content.data(), content.size()) ||
+           !vdfs.writeFile(vdfs.createFile(paths.back()), content))
+        {
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    DirectoryArchive directory(root);
+    if(!directory.open()) return 1;
+    const double openSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const double statNs = measure(paths, [&](const Path& path) {
+        ExplorerEntry info;
+        return Explorer::Stat(String(root + "/" + path), info);
+    });
+    const double directoryNs = measure(paths, [&](const Path& path) { return nullptr != directory.getFile(path); });
+    const double vdfsNs = measure(paths, [&](const Path& path) { return nullptr != vdfs.getFile(path); });
+
+    start = std::chrono::steady_clock::now();
+    directory.refresh();
+    const double refreshSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    directory.close();
+    vdfs.close();
+    Explorer::Remove(root, true);
+    File(archivePath).remove();
+    if(statNs < 0.0 || directoryNs < 0.0 || vdfsNs < 0.0)
+    {
+        LogError() << "Lookups failed!";
+        return 1;
+    }
+
+    LogInfo() << fileCount << " files. Directory scanned in " << openSeconds << " s, unchanged refresh: " << refreshSeconds << " s.";
+    LogInfo() << "Stat per lookup: " << statNs << " ns.";
+    LogInfo() << "DirectoryArchive: " << directoryNs << " ns per lookup.";
+    LogInfo() << "VDFSArchive: " << vdfsNs << " ns per lookup.";
+    return 0;
+}
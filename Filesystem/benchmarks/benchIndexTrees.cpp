@@ -0,0 +1,127 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+/** \file benchIndexTrees
+ * Compares building, scanning and tearing down a big archive index with Tree and FlatTree.
+ *
+ * Usage: benchIndexTrees [entryCount]
+ */
+
+#include <ClippedUtils/cLogger.h>
+#include <ClippedUtils/DataStructures/cTree.h>
+#include <ClippedUtils/DataStructures/cFlatTree.h>
+#include <chrono>
+#include <cstdlib>
+
+using namespace Clipped;
+
+/**
+ * @brief The IndexEntry struct resembles the payload of an archive index entry.
+ */
+struct IndexEntry
+{
+    uint32_t offset;
+    uint32_t size;
+};
+
+const size_t FilesPerDirectory = 200;
+
+String directoryOf(const size_t i)
+{
+    return "LEVEL" + String((int)(i / FilesPerDirectory % 8));
+}
+
+String subdirectoryOf(const size_t i)
+{
+    return "DIR" + String((int)(i / FilesPerDirectory));
+}
+
+String filenameOf(const size_t i)
+{
+    return "ASSET_" + String((int)(i % FilesPerDirectory)) + ".DAT";
+}
+
+double secondsSince(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    Logger() << Logger::MessageType::Info;
+    const size_t entryCount = (1 < argc) ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    std::vector<String> keys; //Keys get created up front, to measure the containers only.
+    keys.reserve(entryCount * 3);
+    for(size_t i = 0; i < entryCount; i++)
+    {
+        keys.push_back(directoryOf(i));
+        keys.push_back(subdirectoryOf(i));
+        keys.push_back(filenameOf(i));
+    }
+
+    uint64_t checksum = 0;
+    double treeBuild, treeScan, treeClear;
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto* tree = new Tree<String, IndexEntry>();
+        for(size_t i = 0; i < entryCount; i++)
+            tree->getSubtree(keys[3 * i]).getSubtree(keys[3 * i + 1]).addElement(keys[3 * i + 2], IndexEntry{ (uint32_t)i, 1 });
+        treeBuild = secondsSince(start);
+        start = std::chrono::steady_clock::now();
+        for(auto& element : *tree)
+            checksum += element.second.offset;
+        treeScan = secondsSince(start);
+        start = std::chrono::steady_clock::now();
+        delete tree;
+        treeClear = secondsSince(start);
+    }
+
+    double flatBuild, flatScan, flatClear;
+    {
+        using Index = FlatTree<IndexEntry>;
+        auto start = std::chrono::steady_clock::now();
+        auto* tree = new Index();
+        tree->reserve(entryCount + entryCount / FilesPerDirectory + 8, entryCount * 12);
+        for(size_t i = 0; i < entryCount; i++)
+        {
+            const Index::NodeId stage = tree->getSubtree(tree->getSubtree(Index::Root, keys[3 * i]), keys[3 * i + 1]);
+            tree->addElement(stage, keys[3 * i + 2], IndexEntry{ (uint32_t)i, 1 });
+        }
+        flatBuild = secondsSince(start);
+        start = std::chrono::steady_clock::now();
+        for(const IndexEntry& element : tree->getElements())
+            checksum -= element.offset;
+        flatScan = secondsSince(start);
+        start = std::chrono::steady_clock::now();
+        delete tree;
+        flatClear = secondsSince(start);
+    }
+
+    LogInfo() << "Entries: " << entryCount << " (checksum " << (checksum == 0 ? "ok" : "MISMATCH") << ")";
+    LogInfo() << "Tree:     build " << treeBuild * 1000.0 << " ms, scan " << treeScan * 1000.0 << " ms, teardown " << treeClear * 1000.0 << " ms";
+    LogInfo() << "FlatTree: build " << flatBuild * 1000.0 << " ms, scan " << flatScan * 1000.0 << " ms, teardown " << flatClear * 1000.0 << " ms";
+    return checksum == 0 ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+/** \file benchOverlayLookup
+ * Mounts a stack of archives and compares the lookup of every file through the merged
+ * lookup of an OverlayArchive with searching the archives top down.
+ *
+ * Usage: benchOverlayLookup [layerCount] [filesPerLayer]
+ */
+
+#include <ClippedUtils/cLogger.h>
+#include <ClippedFilesystem/cFile.h>
+#include <ClippedFilesystem/Archives/cVdfsArchive.h>
+#include <ClippedFilesystem/Archives/cOverlayArchive.h>
+#include <chrono>
+#include <memory>
+
+using namespace Clipped;
+
+Path pathOf(const size_t layer, const size_t i)
+{
+    return String("Layer" + String((int)layer) + "/Dir" + String((int)(i % 16)) + "/file" + String((int)i) + ".dat");
+}
+
+int main(int argc, char** argv)
+{
+    Logger() << Logger::MessageType::Info;
+    const size_t layerCount = (1 < argc) ? std::stoul(argv[1]) : 8;
+    const size_t filesPerLayer = (2 < argc) ? std::stoul(argv[2]) : 5000;
+    const std::vector<char> content(16, 'x');
+
+    std::vector<std::unique_ptr<VDFSArchive>> layers;
+    for(size_t layer = 0; layer < layerCount; layer++)
+    {
+        const Path filepath = String("benchOverlayLayer" + String((int)layer) + ".vdfs");
+        {
+            VDFSArchive archive(filepath);
+            if(!archive.create()) return 1;
+            for(size_t i = 0; i < filesPerLayer; i++)
+            {
+                if(!archive.writeFile(archive.createFile(pathOf(layer, i)), content)) return 1;
+            }
+            if(!archive.close()) return 1;
+        }
+        layers.emplace_back(new VDFSArchive(filepath));
+        if(!layers.back()->open(VdfsAccessMode::READ_ONLY_MAPPED)) return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    OverlayArchive overlay;
+    for(auto& layer : layers)
+    {
+        overlay.mount(*layer);
+    }
+    const double mountSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    //Paths of all layers, looked up by both strategies:
+    std::vector<Path> paths;
+    for(size_t layer = 0; layer < layerCount; layer++)
+        for(size_t i = 0; i < filesPerLayer; i++)
+            paths.push_back(pathOf(layer, i));
+
+    size_t found = 0;
+    start = std::chrono::steady_clock::now();
+    for(const Path& path : paths)
+    {
+        for(auto layer = layers.rbegin(); layer != layers.rend(); layer++)
+        {
+            if((*layer)->getFile(path))
+            {
+                found++;
+                break;
+            }
+        }
+    }
+    const double stackSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for(const Path& path : paths)
+    {
+        if(overlay.getFile(path)) found++;
+    }
+    const double overlaySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    overlay.close();
+    for(size_t layer = 0; layer < layerCount; layer++)
+    {
+        layers[layer]->close();
+        File(layers[layer]->getBasePath()).remove();
+    }
+    if(found != 2 * paths.size())
+    {
+        LogError() << "Lookups failed!";
+        return 1;
+    }
+
+    LogInfo() << layerCount << " layers, " << paths.size() << " files. Mounted in " << mountSeconds << " s.";
+    LogInfo() << "Searching the layers: " << stackSeconds * 1e9 / paths.size() << " ns per lookup.";
+    LogInfo() << "Merged lookup: " << overlaySeconds * 1e9 / paths.size() << " ns per lookup.";
+    return 0;
+}
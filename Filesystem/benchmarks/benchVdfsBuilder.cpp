@@ -0,0 +1,94 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+/** \file benchVdfsBuilder
+ * Packs a set of source files into a vdfs archive with an increasing amount of worker threads
+ * and reports the packing throughput.
+ *
+ * Usage: benchVdfsBuilder [fileCount] [maxWorkers]
+ *   Source files get generated in the directory benchVdfsBuilderSources.
+ */
+
+#include <ClippedUtils/cLogger.h>
+#include <ClippedFilesystem/Archives/cVdfsBuilder.h>
+#include <ClippedFilesystem/cBinFile.h>
+#include <ClippedFilesystem/cExplorer.h>
+#include <chrono>
+#include <random>
+#include <thread>
+
+using namespace Clipped;
+
+int main(int argc, char** argv)
+{
+    Logger() << Logger::MessageType::Info;
+    const size_t fileCount = (1 < argc) ? std::stoul(argv[1]) : 5000;
+    size_t maxWorkers = (2 < argc) ? std::stoul(argv[2]) : std::thread::hardware_concurrency();
+    if(0 == maxWorkers) maxWorkers = 1;
+
+    const Path sourceDir = "benchVdfsBuilderSources";
+    Explorer::CreateDir(sourceDir);
+    std::mt19937 random(42);
+    std::lognormal_distribution<double> sizes(9.0, 1.5);
+    std::vector<Path> sourceFiles;
+    size_t totalBytes = 0;
+    for(size_t i = 0; i < fileCount; i++)
+    {
+        std::vector<char> content(static_cast<size_t>(sizes(random)) % (16 * 1024 * 1024));
+        for(size_t j = 0; j < content.size(); j++)
+            content[j] = static_cast<char>(random() & 0xFF);
+        Path filepath = String(sourceDir + "/file" + String((int)i) + ".bin");
+        BinFile file(filepath);
+        if(!file.open(FileAccessMode::TRUNC) || !file.writeBytes(content))
+        {
+            LogError() << "Can't create source file: " << filepath;
+            return 1;
+        }
+        sourceFiles.push_back(filepath);
+        totalBytes += content.size();
+    }
+    LogInfo() << "Packing " << fileCount << " files with " << MemorySize(totalBytes).toString() << ".";
+
+    for(size_t workers = 1; workers <= maxWorkers; workers *= 2)
+    {
+        VDFSBuilder builder("benchVdfsBuilder.vdfs");
+        builder.setWorkerCount(workers);
+        for(const Path& sourceFile : sourceFiles)
+            builder.addFile(Path("Data/" + sourceFile.getFilenameWithExt()), sourceFile);
+
+        auto start = std::chrono::steady_clock::now();
+        if(!builder.build())
+        {
+            LogError() << "Build failed!";
+            return 1;
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        LogInfo() << "Workers " << workers << ": " << seconds << " s ("
+                  << (totalBytes / (1024.0 * 1024.0)) / seconds << " MB/s)";
+    }
+    return 0;
+}
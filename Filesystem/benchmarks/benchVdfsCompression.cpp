@@ -0,0 +1,146 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+/** \file benchVdfsCompression
+ * Builds a raw and a compressed vdfs archive from the same generated assets and compares
+ * archive size and the time to load all files.
+ *
+ * Usage: benchVdfsCompression [fileCount]
+ *   On Linux the archive gets dropped from the page cache before each load (best effort), to
+ *   approximate cold loads.
+ */
+
+#include <ClippedUtils/cLogger.h>
+#include <ClippedUtils/cOsDetect.h>
+#include <ClippedFilesystem/Archives/cVdfsBuilder.h>
+#include <chrono>
+#include <cstring>
+#include <random>
+
+#if defined(LINUX)
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+using namespace Clipped;
+
+/**
+ * @brief dropFromPageCache asks the os to forget the cached pages of a file.
+ */
+void dropFromPageCache(const Path& filepath)
+{
+#if defined(LINUX)
+    int fileDescriptor = ::open(filepath.c_str(), O_RDONLY);
+    if(0 <= fileDescriptor)
+    {
+        ::fdatasync(fileDescriptor);
+        ::posix_fadvise(fileDescriptor, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fileDescriptor);
+    }
+#else
+    (void)filepath;
+#endif
+}
+
+/**
+ * @brief load reads all files of an archive.
+ * @return the time in seconds or a negative value on errors.
+ */
+double load(const Path& filepath, const std::vector<Path>& files)
+{
+    dropFromPageCache(filepath);
+    auto start = std::chrono::steady_clock::now();
+    VDFSArchive archive(filepath);
+    if(!archive.open()) return -1.0;
+    std::vector<char> buffer;
+    for(const Path& file : files)
+    {
+        const FileEntry* entry = archive.getFile(file);
+        if(!entry) return -1.0;
+        buffer.resize(entry->getSize());
+        if(!archive.readFile(entry, buffer.data())) return -1.0;
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    Logger() << Logger::MessageType::Info;
+    const size_t fileCount = (1 < argc) ? std::stoul(argv[1]) : 2000;
+
+    //Assets: Text like content with a vocabulary, so it compresses like scripts or meshes in text format.
+    std::mt19937 random(42);
+    std::lognormal_distribution<double> sizes(9.5, 1.2);
+    const char* words[] = { "vertex ", "normal ", "texture ", "material ", "0.000 ", "1.000 ", "-0.5 ", "\n", "instance ", "mesh " };
+    std::vector<std::vector<char>> assets(fileCount);
+    std::vector<Path> files;
+    size_t rawBytes = 0;
+    for(size_t i = 0; i < fileCount; i++)
+    {
+        const size_t size = static_cast<size_t>(sizes(random)) + 1;
+        while(assets[i].size() < size)
+        {
+            const char* word = words[random() % 10];
+            assets[i].insert(assets[i].end(), word, word + std::strlen(word));
+        }
+        assets[i].resize(size);
+        files.push_back(String("Assets/asset" + String((int)i) + ".txt"));
+        rawBytes += size;
+    }
+
+    const Path rawArchive = "benchVdfsRaw.vdfs";
+    const Path compressedArchive = "benchVdfsCompressed.vdfs";
+    for(const bool compress : { false, true })
+    {
+        VDFSBuilder builder(compress ? compressedArchive : rawArchive);
+        builder.setCompression(compress);
+        for(size_t i = 0; i < fileCount; i++)
+            builder.addBuffer(files[i], assets[i]);
+        auto start = std::chrono::steady_clock::now();
+        if(!builder.build())
+        {
+            LogError() << "Build failed!";
+            return 1;
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        LogInfo() << (compress ? "Compressed" : "Raw") << " build: " << seconds << " s.";
+    }
+
+    LogInfo() << fileCount << " files with " << MemorySize(rawBytes).toString() << ". Raw archive: "
+              << MemorySize(File(rawArchive).getSize()).toString() << ", compressed archive: "
+              << MemorySize(File(compressedArchive).getSize()).toString() << ".";
+    const double rawSeconds = load(rawArchive, files);
+    const double compressedSeconds = load(compressedArchive, files);
+    if(rawSeconds < 0.0 || compressedSeconds < 0.0)
+    {
+        LogError() << "Load failed!";
+        return 1;
+    }
+    LogInfo() << "Load raw: " << rawSeconds << " s (" << (rawBytes / (1024.0 * 1024.0)) / rawSeconds << " MB/s)";
+    LogInfo() << "Load compressed: " << compressedSeconds << " s (" << (rawBytes / (1024.0 * 1024.0)) / compressedSeconds << " MB/s)";
+    return 0;
+}
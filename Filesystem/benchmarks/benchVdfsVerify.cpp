@@ -0,0 +1,153 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+/** \file benchVdfsVerify
+ * Builds an archive, calculates the checksums of all payloads and verifies it.
+ * Compares the verification throughput with a plain sequential read of the archive file.
+ *
+ * Usage: benchVdfsVerify [fileCount]
+ *   On Linux the archive gets dropped from the page cache before each pass (best effort), to
+ *   approximate cold reads.
+ */
+
+#include <ClippedUtils/cLogger.h>
+#include <ClippedUtils/cOsDetect.h>
+#include <ClippedFilesystem/cNativeFile.h>
+#include <ClippedFilesystem/Archives/cVdfsBuilder.h>
+#include <chrono>
+#include <random>
+
+#if defined(LINUX)
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+using namespace Clipped;
+
+/**
+ * @brief dropFromPageCache asks the os to forget the cached pages of a file.
+ */
+void dropFromPageCache(const Path& filepath)
+{
+#if defined(LINUX)
+    int fileDescriptor = ::open(filepath.c_str(), O_RDONLY);
+    if(0 <= fileDescriptor)
+    {
+        ::fdatasync(fileDescriptor);
+        ::posix_fadvise(fileDescriptor, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fileDescriptor);
+    }
+#else
+    (void)filepath;
+#endif
+}
+
+/**
+ * @brief readSequential reads the whole file front to back.
+ * @return the time in seconds or a negative value on errors.
+ */
+double readSequential(const Path& filepath)
+{
+    dropFromPageCache(filepath);
+    auto start = std::chrono::steady_clock::now();
+    NativeFile file(filepath);
+    if(!file.open(FileAccessMode::READ_ONLY)) return -1.0;
+    std::vector<char> buffer(1024 * 1024);
+    for(size_t offset = 0; offset < file.getSize(); offset += buffer.size())
+    {
+        const size_t chunk = std::min(buffer.size(), file.getSize() - offset);
+        if(!file.readAt(offset, buffer.data(), chunk)) return -1.0;
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief verify verifies all entries of the archive.
+ * @return the time in seconds or a negative value on errors.
+ */
+double verify(const Path& filepath, const VdfsAccessMode mode)
+{
+    dropFromPageCache(filepath);
+    auto start = std::chrono::steady_clock::now();
+    VDFSArchive archive(filepath);
+    size_t valid = 0;
+    if(!archive.open(mode) || !archive.verify([&valid](const FileEntry*, VerifyResult result)
+                                              { if(VerifyResult::VALID == result) valid++; }))
+        return -1.0;
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    Logger() << Logger::MessageType::Info;
+    const size_t fileCount = (1 < argc) ? std::stoul(argv[1]) : 2000;
+
+    //Binary assets with sizes like textures and meshes:
+    std::mt19937 random(42);
+    std::lognormal_distribution<double> sizes(11.0, 1.0);
+    const Path filepath = "benchVdfsVerify.vdfs";
+    {
+        VDFSBuilder builder(filepath);
+        for(size_t i = 0; i < fileCount; i++)
+        {
+            std::vector<char> asset(static_cast<size_t>(sizes(random)) + 1);
+            for(char& byte : asset) byte = static_cast<char>(random());
+            builder.addBuffer(String("Assets/asset" + String((int)i) + ".bin"), asset);
+        }
+        if(!builder.build())
+        {
+            LogError() << "Build failed!";
+            return 1;
+        }
+    }
+    {
+        auto start = std::chrono::steady_clock::now();
+        VDFSArchive archive(filepath);
+        if(!archive.open() || !archive.setChecksums(true) || !archive.close())
+        {
+            LogError() << "Can't calculate the checksums!";
+            return 1;
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        LogInfo() << "Checksums calculated in " << seconds << " s.";
+    }
+
+    const double archiveMB = File(filepath).getSize() / (1024.0 * 1024.0);
+    const double readSeconds = readSequential(filepath);
+    const double verifySeconds = verify(filepath, VdfsAccessMode::READ_WRITE);
+    const double mappedSeconds = verify(filepath, VdfsAccessMode::READ_ONLY_MAPPED);
+    if(readSeconds < 0.0 || verifySeconds < 0.0 || mappedSeconds < 0.0)
+    {
+        LogError() << "Verification failed!";
+        return 1;
+    }
+    LogInfo() << fileCount << " files, archive: " << MemorySize(File(filepath).getSize()).toString() << ".";
+    LogInfo() << "Sequential read: " << readSeconds << " s (" << archiveMB / readSeconds << " MB/s)";
+    LogInfo() << "Verify: " << verifySeconds << " s (" << archiveMB / verifySeconds << " MB/s)";
+    LogInfo() << "Verify mapped: " << mappedSeconds << " s (" << archiveMB / mappedSeconds << " MB/s)";
+    return 0;
+}
@@ -0,0 +1,238 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+/** \file cDirectoryArchive
+ * An archiver serving the files of a directory tree on the filesystem.
+ * Implemented functionalities:
+ *  - Walks the tree once on open and caches paths and sizes. Lookups don't touch the filesystem.
+ *  - Lazy refresh: Directories are rescanned, if their modification time changed.
+ *    The size of a file gets rechecked, when it is read.
+ *  - Read, range read, write, create and remove files.
+ *  - Iterate over files, optionally filtered by a glob pattern.
+ *  - Refresh handlers get notified, whenever a refresh might have invalidated cached entries.
+ */
+
+#pragma once
+
+#include <ClippedFilesystem/cIArchiver.h>
+#include <ClippedFilesystem/cExplorer.h>
+#include <ClippedFilesystem/cNativeFile.h>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Clipped
+{
+    /**
+     * @brief The DirectoryEntry is a regular FileEntry, cached by a DirectoryArchive.
+     */
+    class DirectoryEntry : public FileEntry
+    {
+    public:
+        DirectoryEntry(const Path& path, const MemorySize size)
+            : FileEntry(path, size)
+        {}
+    }; //class DirectoryEntry
+
+    /**
+     * @brief The DirectoryArchive class implements the IArchiver interface on a directory of the filesystem.
+     *   Paths of the entries are relative to the base directory, separated by '/'.
+     */
+    class DirectoryArchive : public IArchiver
+    {
+    public:
+        using RefreshHandler = std::function<void()>; //!< Called after the cache has been rescanned.
+
+        /**
+         * @brief DirectoryArchive creates an archive instance for the given directory.
+         * @param basePath root directory of the archive.
+         */
+        DirectoryArchive(const Path& basePath);
+
+        virtual ~DirectoryArchive() override;
+
+        /**
+         * @brief open walks the directory tree and caches all files. Notifies the refresh handlers.
+         * @return true, if the base path is a readable directory.
+         */
+        virtual bool open() override;
+
+        /**
+         * @brief close drops the cache. Notifies the refresh handlers.
+         * @return true.
+         */
+        virtual bool close() override;
+
+        /**
+         * @brief refresh rescans all cached directories, whose modification time changed.
+         *   Costs one stat per directory. Entries of removed files get invalid.
+         *   Notifies the refresh handlers, if anything changed.
+         * @return true, if anything changed.
+         */
+        bool refresh();
+
+        /**
+         * @brief attachRefreshHandler adds a callback, that gets called after cached entries might have been
+         *   dropped or added. Holders of entries have to look them up again.
+         * @param owner identifies the handler. Replaces a handler attached by the same owner.
+         * @param handler to call.
+         */
+        void attachRefreshHandler(const void* owner, const RefreshHandler& handler);
+
+        /**
+         * @brief removeRefreshHandler removes the callback of an owner.
+         * @param owner of the handler.
+         */
+        void removeRefreshHandler(const void* owner);
+
+        /**
+         * @brief getFile looks up a file in the cache.
+         *   If the file isn't cached, its directory gets refreshed lazily, in case it has been added meanwhile.
+         * @param filepath relative to the base directory.
+         * @return file handle or nullptr, if file doesn't exist.
+         */
+        virtual FileEntry* getFile(const Path& filepath) override;
+
+        /**
+         * @brief getCachedFile looks up a file in the cache only. Never refreshes, so no cached entry gets dropped.
+         * @param filepath relative to the base directory.
+         * @return file handle or nullptr, if the file isn't cached.
+         */
+        FileEntry* getCachedFile(const Path& filepath);
+
+        virtual FileEntry* searchFile(const Path& filename) override;
+
+        /**
+         * @brief createFile creates an empty file including missing directories. Existing files are returned.
+         * @param filepath relative to the base directory.
+         * @return the file handle or nullptr, if it couldn't be created.
+         */
+        virtual FileEntry* createFile(const Path& filepath) override;
+
+        /**
+         * @brief readFile reads a file to dest. If the file changed on disk since it has been cached, its
+         *   entry gets updated and the read fails, because dest was sized with the outdated size.
+         */
+        virtual bool readFile(const FileEntry* fileEntry, char* dest) override;
+
+        /**
+         * @brief readFile reads the current content of a file to dest and updates the cached size.
+         */
+        virtual bool readFile(const FileEntry* fileEntry, std::vector<char>& dest) override;
+
+        virtual bool readFileRange(const FileEntry* fileEntry, const size_t offset, const size_t length, char* dest) override;
+
+        virtual bool writeFile(FileEntry* fileEntry, const char* src, const size_t length) override;
+
+        virtual bool writeFile(FileEntry* fileEntry, const std::vector<char>& src) override;
+
+        virtual bool removeFile(FileEntry* fileEntry) override;
+
+    protected:
+        virtual std::unique_ptr<IFileEntryCursor> createFileCursor() override;
+
+    private:
+        /**
+         * @brief The CachedDirectory struct holds the state of a directory at the time it has been scanned.
+         */
+        struct CachedDirectory
+        {
+            int64_t modified;                       //!< Modification time of the directory.
+            std::unordered_set<String> files;       //!< Names of the files inside.
+            std::unordered_set<String> directories; //!< Names of the subdirectories.
+        };
+
+        /**
+         * @brief join appends a name to a key.
+         */
+        static String join(const String& directory, const String& name);
+
+        /**
+         * @brief getParent returns the key of the directory containing the given key.
+         */
+        static String getParent(const String& key);
+
+        /**
+         * @brief getFullPath returns the path on the filesystem of a key.
+         */
+        Path getFullPath(const String& key) const;
+
+        /**
+         * @brief scanDirectory caches a directory and all of its contents recursively.
+         * @param key of the directory. Empty for the base directory.
+         * @param modified modification time of the directory.
+         */
+        void scanDirectory(const String& key, const int64_t modified);
+
+        /**
+         * @brief refreshDirectory rescans a cached directory, if its modification time changed.
+         *   Removed directories get dropped from the cache.
+         * @param key of the directory.
+         * @return true, if the directory changed.
+         */
+        bool refreshDirectory(const String& key);
+
+        /**
+         * @brief addFile caches a file or updates its cached metadata.
+         */
+        DirectoryEntry* addFile(const String& key, const ExplorerEntry& info);
+
+        /**
+         * @brief dropFile removes a file from the cache.
+         */
+        void dropFile(const String& key);
+
+        /**
+         * @brief dropDirectory removes a directory and all of its contents from the cache.
+         */
+        void dropDirectory(const String& key);
+
+        /**
+         * @brief getCached looks up the cached entry of a file handle.
+         * @return the cached entry or nullptr, if the handle isn't cached by this archive. Logs an error.
+         */
+        DirectoryEntry* getCached(const FileEntry* fileEntry) const;
+
+        /**
+         * @brief openCurrent opens a cached file and updates the size of its entry, if the file changed on disk.
+         * @param entry of the file.
+         * @param file handle to open.
+         * @return true, if the file has been opened.
+         */
+        bool openCurrent(DirectoryEntry* entry, NativeFile& file);
+
+        /**
+         * @brief notifyRefresh calls all refresh handlers.
+         */
+        void notifyRefresh();
+
+        std::unordered_map<String, DirectoryEntry> files;               //!< Relative path -> cached file.
+        std::unordered_multimap<String, DirectoryEntry*> nameLookup;    //!< Filename -> cached files.
+        std::unordered_map<String, CachedDirectory> directories;        //!< Relative path -> cached directory.
+        std::unordered_map<const void*, RefreshHandler> refreshHandlers; //!< Owner -> handler to notify on refreshes.
+    }; //class DirectoryArchive
+} //namespace Clipped
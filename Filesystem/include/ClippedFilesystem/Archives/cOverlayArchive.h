@@ -0,0 +1,212 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+/** \file cOverlayArchive
+ * An archiver stacking several archives on top of each other.
+ * Implemented functionalities:
+ *  - Mount archives in priority order. Files of later mounted layers shadow the ones of earlier layers.
+ *  - Mount plain directories of the filesystem as layers (DirectoryArchive). Refreshes of them re-merge the lookup.
+ *  - One merged lookup table. Finding a file is a single hash probe, independent of the layer count.
+ *  - Read, range read and iterate the visible files.
+ *  - Write to the top layer. Files created there shadow the files of the layers below.
+ */
+
+#pragma once
+
+#include <ClippedFilesystem/cIArchiver.h>
+#include <ClippedFilesystem/Archives/cDirectoryArchive.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Clipped
+{
+    /**
+     * @brief The OverlayArchive class serves the files of several mounted archives as one file storage.
+     *   Typical usage is a base archive with patch archives mounted on top of it.
+     *   Mounted archives aren't owned and have to be opened before they get mounted.
+     */
+    class OverlayArchive : public IArchiver
+    {
+    public:
+        /**
+         * @brief The OverlayFile struct is the lookup entry of a visible file.
+         */
+        struct OverlayFile
+        {
+            FileEntry* entry;   //!< The entry of the layer serving the file.
+            size_t layer;       //!< Index of the serving layer. 0 is the lowest.
+        };
+
+        OverlayArchive();
+
+        /**
+         * @brief ~OverlayArchive unmounts all layers. Mounted archives stay open.
+         */
+        virtual ~OverlayArchive() override;
+
+        /**
+         * @brief mount puts an archive on top of the stack. Its files shadow the files of the layers below.
+         * @param archive opened archive. Has to outlive the mount.
+         * @return true, if mounted. False, if the archive is mounted already.
+         */
+        bool mount(IArchiver& archive);
+
+        /**
+         * @brief mountDirectory opens a directory as DirectoryArchive and puts it on top of the stack.
+         *   The overlay owns the created archive until it gets unmounted or the overlay is closed.
+         * @param directory to mount.
+         * @return the mounted archive or nullptr, if the directory couldn't be opened.
+         */
+        DirectoryArchive* mountDirectory(const Path& directory);
+
+        /**
+         * @brief unmount removes an archive from the stack. Files shadowed by it become visible again.
+         * @param archive to remove.
+         * @return true, if unmounted. False, if the archive isn't mounted.
+         */
+        bool unmount(IArchiver& archive);
+
+        /**
+         * @brief getLayerCount returns the amount of mounted layers.
+         */
+        size_t getLayerCount() const;
+
+        /**
+         * @brief getLayer returns the layer serving a visible file.
+         * @param fileEntry got from this overlay.
+         * @return the serving layer or nullptr, if the entry isn't visible in this overlay.
+         */
+        IArchiver* getLayer(const FileEntry* fileEntry) const;
+
+        /**
+         * @brief open merges the files of all mounted layers into the lookup.
+         *   Call it again, if layers got modified directly instead of through this overlay.
+         *   Directory layers call it by themselves, whenever they got refreshed.
+         * @return true, if at least one layer is mounted.
+         */
+        virtual bool open() override;
+
+        /**
+         * @brief close unmounts all layers. Mounted archives stay open, mounted directories get closed.
+         * @return true.
+         */
+        virtual bool close() override;
+
+        /**
+         * @brief finalize finalizes the top layer, which receives all writes.
+         * @return true, if written successfully.
+         */
+        virtual bool finalize() override;
+
+        virtual FileEntry* getFile(const Path& filepath) override;
+
+        /**
+         * @brief searchFile looks up a file by its name in all directories.
+         *   If several directories contain the name, a file of the highest layer is returned.
+         * @param filename to look for.
+         * @return a pointer to the entry or nullptr, if not found.
+         */
+        virtual FileEntry* searchFile(const Path& filename) override;
+
+        /**
+         * @brief createFile creates a file in the top layer.
+         *   An existing file of a lower layer gets shadowed by the new one.
+         * @param filepath to the file.
+         * @return the file of the top layer or nullptr, if it couldn't be created.
+         */
+        virtual FileEntry* createFile(const Path& filepath) override;
+
+        virtual bool readFile(const FileEntry* fileEntry, char* dest) override;
+
+        virtual bool readFile(const FileEntry* fileEntry, std::vector<char>& dest) override;
+
+        virtual bool readFileRange(const FileEntry* fileEntry, const size_t offset, const size_t length, char* dest) override;
+
+        /**
+         * @brief writeFile writes a file of the top layer. Files of lower layers are read only.
+         *   Use createFile to shadow them.
+         */
+        virtual bool writeFile(FileEntry* fileEntry, const char* src, const size_t length) override;
+
+        virtual bool writeFile(FileEntry* fileEntry, const std::vector<char>& src) override;
+
+        /**
+         * @brief removeFile removes a file of the top layer. A shadowed file of a lower layer becomes visible again.
+         * @param fileEntry to remove.
+         * @return true, if removed successfully. False for files of lower layers.
+         */
+        virtual bool removeFile(FileEntry* fileEntry) override;
+
+    protected:
+        virtual std::unique_ptr<IFileEntryCursor> createFileCursor() override;
+
+    private:
+        /**
+         * @brief mergeLayer adds the files of a layer to the lookup. They shadow files of lower layers.
+         * @param layer index of the layer to merge.
+         */
+        void mergeLayer(const size_t layer);
+
+        /**
+         * @brief getLayerFile looks up a file in a layer without refreshing directory layers.
+         *   A refresh could drop entries, which are still referenced by the lookup.
+         * @param layer index of the layer.
+         * @param key normalized path of the file.
+         * @return the entry of the layer or nullptr, if the layer doesn't contain the file.
+         */
+        FileEntry* getLayerFile(const size_t layer, const String& key);
+
+        /**
+         * @brief addToLookup makes an entry of a layer visible under the given key.
+         */
+        void addToLookup(const String& key, FileEntry* entry, const size_t layer);
+
+        /**
+         * @brief removeFromLookup removes the visible file of the given key.
+         */
+        void removeFromLookup(const String& key);
+
+        /**
+         * @brief getVisible looks up the visible file of an entry.
+         * @return the lookup entry or nullptr, if the entry isn't visible in this overlay.
+         */
+        const OverlayFile* getVisible(const FileEntry* fileEntry) const;
+
+        /**
+         * @brief getWritable looks up a visible file of the top layer.
+         * @return the serving top layer or nullptr, logs an error otherwise.
+         */
+        IArchiver* getWritable(const FileEntry* fileEntry) const;
+
+        std::vector<IArchiver*> layers;                                  //!< Mounted layers. The last one has the highest priority.
+        std::vector<std::unique_ptr<IArchiver>> ownedLayers;             //!< Layers created by this overlay.
+        std::unordered_map<String, OverlayFile> pathLookup;              //!< Normalized full path -> visible file.
+        std::unordered_multimap<String, OverlayFile*> nameLookup;        //!< Filename -> visible files.
+        std::unordered_map<const FileEntry*, OverlayFile*> entryLookup;  //!< Visible entry -> its lookup entry.
+    }; //class OverlayArchive
+} //namespace Clipped
@@ -0,0 +1,122 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+/** \file cPayloadCache
+ * A size bounded, thread safe least recently used cache for the contents of archive entries.
+ */
+
+#pragma once
+
+#include <ClippedFilesystem/cIArchiver.h>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Clipped
+{
+    using SharedFileContent = std::shared_ptr<const std::vector<char>>; //!< Read only content of a file, shared between readers.
+
+    /**
+     * @brief The PayloadCache class keeps the contents of recently read entries.
+     *   If the cached bytes exceed the size of the cache, the least recently used entries get dropped.
+     *   Contents are handed out as shared read only buffers, so dropping an entry never invalidates a reader.
+     *   A cache with size 0 is disabled and doesn't count hits or misses.
+     */
+    class PayloadCache
+    {
+    public:
+        /**
+         * @brief PayloadCache creates a cache.
+         * @param size maximum amount of cached bytes.
+         */
+        PayloadCache(const size_t size);
+
+        /**
+         * @brief get looks up the content of an entry and marks it as most recently used.
+         * @param fileEntry to look up.
+         * @param content of the entry, if cached.
+         * @return true on a cache hit.
+         */
+        bool get(const FileEntry* fileEntry, SharedFileContent& content);
+
+        /**
+         * @brief insert stores the content of an entry. Contents larger than the cache aren't stored.
+         * @param fileEntry the content belongs to.
+         * @param content to store.
+         */
+        void insert(const FileEntry* fileEntry, const SharedFileContent& content);
+
+        /**
+         * @brief invalidate drops the content of an entry.
+         * @param fileEntry to drop.
+         */
+        void invalidate(const FileEntry* fileEntry);
+
+        /**
+         * @brief clear drops all contents. The counters are kept.
+         */
+        void clear();
+
+        /**
+         * @brief setSize sets the maximum amount of cached bytes. Drops least recently used entries, if exceeded.
+         * @param size in bytes. 0 disables the cache.
+         */
+        void setSize(const size_t size);
+
+        /**
+         * @brief isEnabled checks, if the cache has a size.
+         */
+        bool isEnabled() const;
+
+        size_t getSize() const;         //!< Getter for the maximum amount of cached bytes.
+        size_t getCachedBytes() const;  //!< Getter for the amount of cached bytes.
+        size_t getHits() const;         //!< Getter for the amount of lookups, that found the entry.
+        size_t getMisses() const;       //!< Getter for the amount of lookups, that didn't find the entry.
+
+        /**
+         * @brief resetCounters sets the hit and miss counters to 0.
+         */
+        void resetCounters();
+
+    private:
+        /**
+         * @brief shrink drops least recently used entries, until the cache fits in size. Needs the mutex to be locked.
+         * @param size the cache has to fit in.
+         */
+        void shrink(const size_t size);
+
+        using UsageList = std::list<std::pair<const FileEntry*, SharedFileContent>>;
+        UsageList usage;                                                    //!< Cached entries from most to least recently used.
+        std::unordered_map<const FileEntry*, UsageList::iterator> lookup;   //!< Entry -> position in the usage list.
+        size_t size;                                                        //!< Maximum amount of cached bytes.
+        size_t cachedBytes;                                                 //!< Sum of the cached content sizes.
+        size_t hits;                                                        //!< Lookups, that found the entry.
+        size_t misses;                                                      //!< Lookups, that didn't find the entry.
+        mutable std::mutex mutex;                                           //!< Guards all members above.
+    }; //class PayloadCache
+
+} //namespace Clipped
@@ -31,19 +31,35 @@
  *  - Access contents as directory tree with paths.
  *  - Add a file to the archive.
  *  - Remove a file from the archive.
+ *  - Read only memory mapped access with zero-copy file views.
+ *  - Optional per entry compression (LzCodec), decompressed chunk by chunk on read.
+ *  - Optional deduplication of identical payloads.
+ *  - Random access reads of entry ranges, also for compressed entries.
+ *  - Asynchronous prefetching of entries in payload order.
+ *  - Optional LRU cache of read entries.
+ *  - Iterate over files, optionally filtered by a glob pattern.
+ *  - Crash safe index updates. The new index is written to free memory and committed by a single header write.
+ *  - Optional CRC32C checksums of the payloads in a side table and parallel verification.
  * Todo:
  * - Create a new VDFS Archive from scratch, without opening an existing.
- * - Iterate over files.
  */
 
 #pragma once
 
 #include <ClippedFilesystem/cIArchiver.h>
 #include <ClippedFilesystem/cBinFile.h>
+#include <ClippedFilesystem/cMappedFile.h>
+#include <ClippedFilesystem/cNativeFile.h>
+#include <ClippedFilesystem/Archives/cVdfsPrefetcher.h>
+#include <ClippedFilesystem/Archives/cVdfsChecksums.h>
 #include <ClippedUtils/cTime.h>
 #include <ClippedUtils/DataStructures/cTree.h>
+#include <functional>
 #include <sstream>
-#include <list>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace Clipped
 {
@@ -65,6 +81,16 @@ namespace Clipped
     {
         NORMAL  = 0,    //!< The item is normal. That is, the item doesn't have any of the other values in the enumeration.
         ARCHIVE = 32u,  //!< The item is archived.
+        COMPRESSED = 0x800u //!< The item is compressed. Payloads compressed by a VDFSArchive carry it, too.
+    };
+
+    /**
+     * @brief The VdfsAccessMode enum declares the modes a vdfs archive can be opened with.
+     */
+    enum class VdfsAccessMode
+    {
+        READ_WRITE,         //!< Read write access through the file stream.
+        READ_ONLY_MAPPED    //!< Read only access. The archive gets mapped to memory and is served zero-copy.
     };
 
     /**
@@ -89,6 +115,7 @@ namespace Clipped
             , vdfs_size(0)
             , vdfs_type(EntryType::BLANK)
             , vdfs_attribute(EntryAttribute::ARCHIVE)
+            , compressed(false)
         {}
 
         static size_t getByteSize(const size_t vdfsNameSize)
@@ -111,6 +138,7 @@ namespace Clipped
         uint32_t vdfs_size;             //!< Size of the payload data.
         EntryType vdfs_type;            //!< Type of this entry.
         EntryAttribute vdfs_attribute;  //!< Attributes of this entry.
+        bool compressed;                //!< Payload is in the compressed format. Not stored in the index.
     };
 
     /**
@@ -152,10 +180,37 @@ namespace Clipped
         size_t size;    //!< Amount of bytes.
     }; //class MemoryBlock
 
+    /**
+     * @brief The AllocationPolicy enum declares the strategies to place new data in free memory regions.
+     */
+    enum class AllocationPolicy
+    {
+        FIRST_FIT,  //!< Uses the free region with the smallest offset, that fits. O(n).
+        BEST_FIT,   //!< Uses the smallest free region, that fits. O(log n).
+        NEXT_FIT,   //!< Uses the next free region behind the last allocation, that fits. O(n).
+        APPEND_ONLY //!< Never reuses free regions, appends all data. For write once archives. O(1).
+    };
+
+    /**
+     * @brief The VerifyResult enum declares the results of the verification of an entry.
+     */
+    enum class VerifyResult
+    {
+        VALID,      //!< The payload matches its checksum.
+        CORRUPT,    //!< The payload doesn't match its checksum.
+        UNCHECKED,  //!< No checksum known for the payload.
+        UNREADABLE  //!< The payload can't be read.
+    };
+
+    using VerifyCallback = std::function<void(const FileEntry*, VerifyResult)>; //!< Receives the result of each entry.
+
     /**
      * @brief The MemoryManager class handles the memory layout.
      *   It's used to store a memory map and takes care of free memory regions.
      *   handledBytes size will grow automatically, if memory in the outside region is requested.
+     *   Free regions are indexed by offset and by size, so allocations (best fit) and the
+     *   combination of adjacent free regions cost O(log n) in the number of free regions.
+     *   Allocated blocks may be shared by several users. A shared block gets freed with its last reference.
      */
     class MemoryManager
     {
@@ -165,6 +220,9 @@ namespace Clipped
          */
         MemoryManager()
             : handledBytes(0)
+            , totalFreeBytes(0)
+            , policy(AllocationPolicy::BEST_FIT)
+            , nextFitOffset(0)
         {}
 
         /**
@@ -175,7 +233,7 @@ namespace Clipped
 
         /**
          * @brief alloc requests 'requestedBytes' amount of bytes.
-         *   Memory location isn't requested. The caller gets some free storage location.
+         *   Memory location isn't requested. The caller gets a free region chosen by the allocation policy.
          * @param requestedBytes amount of bytes to allocate.
          * @param allocatedMemoryInfo informations about the given memory (pos/size).
          * @return true, if the memory has been allocated. False, if not.
@@ -192,7 +250,8 @@ namespace Clipped
 
         /**
          * @brief free frees the memory, specified by the freeMemoryInfo informations.
-         *   Combines narrowing free memory sections to a bigger one to optimize memory gaps.
+         *   Combines the freed region with adjacent free memory sections to a bigger one.
+         *   If the block is shared, only one reference gets dropped and the memory stays allocated.
          * @param freeMemoryInfo infos about the memory to free.
          * @return true, if the memory has been freed successfully. False, if not.
          */
@@ -206,11 +265,70 @@ namespace Clipped
          */
         bool free(const size_t offset, const size_t length);
 
+        /**
+         * @brief addReference registers another user of an allocated block. It has to be freed once more.
+         * @param block allocated memory to share.
+         * @return true, if the block is allocated completely. False otherwise.
+         */
+        bool addReference(const MemoryBlock& block);
+
+        /**
+         * @brief isShared checks if the block at offset has more than one user.
+         * @param offset of the block.
+         * @return true, if the block is shared.
+         */
+        bool isShared(const size_t offset) const
+        {
+            return references.find(offset) != references.end();
+        }
+
+        /**
+         * @brief moveReferences transfers the additional references of a block to its new location.
+         *   Required, if the contents of a shared block get moved.
+         * @param oldOffset previous location of the block.
+         * @param newOffset new location of the block.
+         */
+        void moveReferences(const size_t oldOffset, const size_t newOffset);
+
         /**
          * @brief optimizeFreeMemoryBlocks combines adjacent free memory regions to one big memory region.
+         *   Note: free combines regions already. Kept to repair a layout after external changes.
          */
         void optimizeFreeMemoryBlocks();
 
+        /**
+         * @brief getNextFreeBlock looks up the first free memory region located at or behind offset.
+         * @param offset to start the search at.
+         * @param block informations about the found region.
+         * @return true, if a free region has been found. False, if there is none behind offset.
+         */
+        bool getNextFreeBlock(const size_t offset, MemoryBlock& block) const;
+
+        /**
+         * @brief trimFreeEnd drops the free region at the end of the handled memory, if there is one.
+         *   The amount of handled bytes shrinks accordingly.
+         * @return the amount of handled bytes after trimming.
+         */
+        size_t trimFreeEnd();
+
+        /**
+         * @brief setAllocationPolicy sets the strategy used to place new allocations.
+         * @param policy to use for following allocations.
+         */
+        void setAllocationPolicy(const AllocationPolicy policy)
+        {
+            this->policy = policy;
+        }
+
+        /**
+         * @brief getAllocationPolicy getter for the strategy used to place new allocations.
+         * @return the current allocation policy.
+         */
+        AllocationPolicy getAllocationPolicy() const
+        {
+            return policy;
+        }
+
         /**
          * @brief getHandledMemorySize getter for the amount of handled bytes.
          * @return the current amount of bytes handled by this manager.
@@ -220,6 +338,24 @@ namespace Clipped
             return handledBytes;
         }
 
+        /**
+         * @brief getFreeMemorySize getter for the amount of free bytes in the handled memory.
+         * @return the sum of all free memory regions.
+         */
+        size_t getFreeMemorySize() const
+        {
+            return totalFreeBytes;
+        }
+
+        /**
+         * @brief getFreeMemoryBlockCount getter for the amount of free memory regions.
+         * @return the amount of free memory regions (gaps).
+         */
+        size_t getFreeMemoryBlockCount() const
+        {
+            return freeBlocksByOffset.size();
+        }
+
         /**
          * @brief getDispersionRatio calculates the dispersion ratio.
          *  e.g. a totally compressed file without gaps has a dispersion ratio of 0.0.
@@ -228,30 +364,52 @@ namespace Clipped
          */
         double getDispersionRatio() const
         {
-            unsigned long long totalFreeBytes = 0;
-
-            for(const auto& freeBlock : freeMemoryBlocks) //Sum up all freeMemory Blocks.
-            {
-                LogDebug() << "MemoryManager::getDispertionRatio Free Block: " << freeBlock.offset << " size: " << freeBlock.size;
-                totalFreeBytes += freeBlock.size;
-            }
+            if(0 == handledBytes) return 0.0; //Nothing handled, nothing dispersed.
             return ((double)totalFreeBytes) / ((double)handledBytes);
         }
 
     private:
-        std::list<MemoryBlock> freeMemoryBlocks;    //!< List of free memory blocks.
-        MemorySize handledBytes;                    //!< Total size of the handled memory
+        std::map<size_t, size_t> freeBlocksByOffset;            //!< Free memory blocks: offset -> size.
+        std::set<std::pair<size_t, size_t>> freeBlocksBySize;   //!< Free memory blocks: (size, offset).
+        MemorySize handledBytes;                                //!< Total size of the handled memory
+        size_t totalFreeBytes;                                  //!< Sum of all free memory blocks.
+        AllocationPolicy policy;                                //!< Strategy to place new allocations.
+        size_t nextFitOffset;                                   //!< End of the last allocation (next fit policy).
+        std::unordered_map<size_t, size_t> references;          //!< Offset of shared blocks -> additional references.
+
+        /**
+         * @brief insertFreeBlock adds a free block to both indices. The block must not touch other free blocks.
+         * @param offset of the free block.
+         * @param size of the free block.
+         */
+        void insertFreeBlock(const size_t offset, const size_t size);
 
         /**
-         * @brief allocateInFreeBlock tries to alloc. with existing free blocks.
+         * @brief eraseFreeBlock removes a free block from both indices.
+         * @param block iterator of the offset index pointing to the block.
+         * @return iterator to the following block of the offset index.
+         */
+        std::map<size_t, size_t>::iterator eraseFreeBlock(std::map<size_t, size_t>::iterator block);
+
+        /**
+         * @brief allocateInFreeBlock tries to alloc. with existing free blocks chosen by the allocation policy.
          * @param requestedBytes bytes to allocate.
          * @param allocatedMemoryInfo returned memory info.
          * @return true, if it has allocated. False otherwise.
          */
         bool allocateInFreeBlock(const size_t requestedBytes, MemoryBlock& allocatedMemoryInfo);
 
+        /**
+         * @brief findFreeBlock looks up a free block, that can store requestedBytes, as the policy says.
+         * @param requestedBytes bytes to store.
+         * @return iterator of the offset index pointing to the block or end(), if none fits.
+         */
+        std::map<size_t, size_t>::iterator findFreeBlock(const size_t requestedBytes);
+
         /**
          * @brief allocateExpandLastFreeBlock enlarges the last free memory block and uses it to allocate.
+         *   Only possible, if the last free memory block reaches the end of the handled memory.
+         *   Never used by the APPEND_ONLY policy, which appends behind the last free block instead.
          * @param requestedBytes bytes to allocate.
          * @param allocatedMemoryInfo returned memory info.
          * @return true, if it has allocated. False otherwise.
@@ -270,9 +428,13 @@ namespace Clipped
 
     /**
      * @brief The VDFSArchive class implements the vdfs file protocol.
+     *   readFile, readFileRange and getFileView may be called concurrently from multiple threads, as long as
+     *   no modifying call (createFile, writeFile, removeFile, finalize, ...) runs at the same time.
      */
     class VDFSArchive : public IArchiver
     {
+        friend class VDFSBuilder; //The builder plans the layout of new archives.
+
         /**
          * @brief The VDFS File Header contains informations about the vdfs file.
          */
@@ -322,6 +484,12 @@ namespace Clipped
                 return out;
             }
 
+            uint32_t getEntryCount() const { return entryCount; } //!< Getter for the count of entries.
+
+            uint32_t getFileCount() const { return fileCount; } //!< Getter for the count of files.
+
+            uint32_t getContentSize() const { return contentSize; } //!< Getter for the bytes of all stored payloads.
+
             String comment;            //!< Comment describing the file.
             String signature;          //!< A signature, e.g. a version indicator.
 
@@ -342,16 +510,24 @@ namespace Clipped
         VDFSArchive(const Path& filepath);
 
         /**
-         * @brief ~VDFSArchive destructs this archive. Calls finalize to ensure a clean index on file close.
+         * @brief ~VDFSArchive destructs this archive. Calls close to ensure a clean index on file close.
          */
         virtual ~VDFSArchive();
 
         /**
          * @brief open checks if this Archiver can work with the given basePath.
+         *   Opens the archive with read write access.
          * @return true, if the initialization has been successfull.
          */
         virtual bool open() override;
 
+        /**
+         * @brief open opens the archive with the requested access mode.
+         * @param accessMode READ_WRITE or READ_ONLY_MAPPED to map the archive to memory.
+         * @return true, if the initialization has been successfull.
+         */
+        bool open(const VdfsAccessMode accessMode);
+
         /**
          * @brief create starts the creation of a new vdfs archive with the given path.
          *   Note: It gets finally written on disk on a close or finalize call.
@@ -360,33 +536,30 @@ namespace Clipped
         bool create();
 
         /**
-         * @brief close closes the vdfs archive. Updates the header / index on disk.
+         * @brief close finalizes and closes the vdfs archive.
          * @return true, if closed successfully.
          */
         virtual bool close() override;
 
         /**
-         * @brief finalize does closing tasks. Updates the header and vdfs index.
-         * @return true, if successfully closed.
+         * @brief finalize commits all modifications to disk. The archive stays open and may be finalized periodically.
+         *   Once the header on disk references an index, the new index is written to free memory and committed
+         *   by rewriting the header only. Payloads released since the last commit stay untouched until then.
+         *   An interrupted finalize leaves the last committed state readable.
+         *   New archives and compacted archives get their index written in place behind the header.
+         * @return true, if committed successfully.
          */
         virtual bool finalize() override;
 
         /**
          * @brief getVdfsFile gets a vdfs file entry handle.
+         *   Existing entries are looked up with a single probe of the path index.
          * @param filepath the path inside the vdfs directory.
          * @param createIfNotFound creates the structure and file entry, if it doesn't exists.
          * @return a FileEntry handle.
          */
         FileEntry* getVdfsFile(const Path& filepath, bool createIfNotFound = false);
 
-        /**
-         * @brief searchVdfsFile search for a file recursivly in the index.
-         * @param filename to look for.
-         * @param tree to look at.
-         * @return a FileEntry, if found or a nullptr otherwise.
-         */
-        FileEntry* searchVdfsFile(const Path& filename, Tree<String, VdfsEntry>& tree);
-
         /**
          * @brief getFile returns a FileEntry with informations about the stored file.
          * @param filename file to lookup.
@@ -395,7 +568,12 @@ namespace Clipped
          */
         virtual FileEntry* getFile(const Path& filepath) override;
 
-        /** \copydoc cIArchiver::searchFile */
+        /**
+         * @brief searchFile looks up a file by its name with a single probe of the name index.
+         *   If several entries share the name, one of them is returned.
+         * @param filename to look for.
+         * @return a pointer to the entry or nullptr, if not found.
+         */
         virtual FileEntry* searchFile(const Path& filename) override;
 
         /**
@@ -411,7 +589,23 @@ namespace Clipped
         /** \copydoc cIArchiver::readFile(const FileEntry&,std::vector<char>&) */
         virtual bool readFile(const FileEntry* fileEntry, std::vector<char>& dest) override;
 
-        /** \copydoc cIArchiver::writeFile(FileEntry&,const char*) */
+        /**
+         * @brief readFileShared reads the file data to a shared read only buffer.
+         *   With an enabled payload cache, hot entries are returned without any copy.
+         * @param fileEntry describing the file to read.
+         * @param content buffer with the file data.
+         * @return true, if the file has been read successfully.
+         */
+        bool readFileShared(const FileEntry* fileEntry, SharedFileContent& content);
+
+        /** \copydoc cIArchiver::readFileRange(const FileEntry*,size_t,size_t,char*) */
+        virtual bool readFileRange(const FileEntry* fileEntry, const size_t offset, const size_t length, char* dest) override;
+
+        /**
+         * @brief writeFile writes the payload of an entry. The size of the entry reports length afterwards.
+         *   Overwriting an entry releases its previous payload, unless other entries share it (see setDeduplication).
+         *   The released space gets reused after the next commit of the index.
+         */
         virtual bool writeFile(FileEntry* fileEntry, const char* src, const size_t length) override;
 
         /** \copydoc cIArchiver::writeFile(FileEntry&,const std::vector<char>&) */
@@ -419,21 +613,239 @@ namespace Clipped
 
         virtual bool removeFile(FileEntry* fileEntry) override;
 
+        /**
+         * @brief getFileView returns a zero-copy view of the payload of an entry.
+         *   Only available if the archive has been opened with VdfsAccessMode::READ_ONLY_MAPPED.
+         *   The view stays valid until the archive gets closed.
+         * @param fileEntry describing the file to view.
+         * @param data pointer to the first byte of the payload.
+         * @param length amount of payload bytes.
+         * @return true, if the view has been set up successfully.
+         */
+        bool getFileView(const FileEntry* fileEntry, const char*& data, size_t& length) const;
+
         double getDispersionRatio() const
         {
             return memoryManager.getDispersionRatio();
         }
 
+        /**
+         * @brief compact relocates payloads to close all gaps in the archive and truncates the file afterwards.
+         *   The index moves behind the header again. Payloads are moved in place, so compact isn't crash safe.
+         *   Note: The index on disk gets updated by finalize.
+         * @return true, if the archive has been compacted successfully.
+         */
+        bool compact();
+
+        /**
+         * @brief compact does an incremental compaction step. Payloads behind the lowest gaps get moved to
+         *   the front, until byteBudget bytes have been moved. At least one payload is moved per call.
+         *   If no gap is left, the file gets truncated and completed is set.
+         *   Note: The index on disk gets updated by finalize.
+         * @param byteBudget amount of payload bytes to move in this step.
+         * @param completed set to true, if the archive is free of gaps and truncated. False otherwise.
+         * @return true, if the step has been processed successfully. False on errors.
+         */
+        bool compact(const size_t byteBudget, bool& completed);
+
+        /**
+         * @brief setCompression enables or disables the compression of payloads written by following writeFile calls.
+         *   Compressed payloads are stored in chunks of CompressionChunkSize bytes:
+         *   Header (magic, raw size, chunk size, chunk count as uint32), a table with the stored size of each
+         *   chunk (uint32, highest bit set if the chunk is stored uncompressed) and the chunks.
+         *   The entry gets flagged with EntryAttribute::COMPRESSED. Entries without flag are read as they are.
+         *   Legacy entries may carry the flag (FILE_ATTRIBUTE_COMPRESSED) for raw payloads. On open, only flagged
+         *   entries with a valid payload header are treated as compressed.
+         * @param enabled true to compress new payloads.
+         */
+        void setCompression(const bool enabled)
+        {
+            compression = enabled;
+        }
+
+        /**
+         * @brief getCompression getter for the compression of new payloads.
+         * @return true, if new payloads get compressed.
+         */
+        bool getCompression() const
+        {
+            return compression;
+        }
+
+        static const size_t CompressionChunkSize; //!< Amount of raw bytes compressed per chunk.
+
+        /**
+         * @brief setDeduplication enables or disables the deduplication of payloads written by writeFile.
+         *   A payload identical to a stored one isn't written again. Both entries share the stored data.
+         *   Payloads are identified by a content hash and compared byte by byte.
+         *   Note: Enabling reads and hashes all payloads, that are stored in the archive already.
+         * @param enabled true to share identical payloads.
+         * @return true, if the setting has been applied.
+         */
+        bool setDeduplication(const bool enabled);
+
+        /**
+         * @brief getDeduplication getter for the deduplication of new payloads.
+         * @return true, if identical payloads get shared.
+         */
+        bool getDeduplication() const
+        {
+            return deduplication;
+        }
+
+        /**
+         * @brief setIncrementalFlush enables or disables incremental index flushes.
+         *   If no entries have been added or removed since the last commit, finalize rewrites the file entries of
+         *   changed directory stages only. These get patched in place inside of the committed index.
+         *   Every entry stays valid on a crash, but the index may hold a mix of old and new entries then.
+         *   Disabled by default, the whole index gets committed atomically.
+         * @param enabled true to patch changed stages in place.
+         */
+        void setIncrementalFlush(const bool enabled)
+        {
+            incrementalFlush = enabled;
+        }
+
+        /**
+         * @brief getIncrementalFlush getter for incremental index flushes.
+         * @return true, if changed stages get patched in place.
+         */
+        bool getIncrementalFlush() const
+        {
+            return incrementalFlush;
+        }
+
+        /**
+         * @brief setChecksums enables or disables the CRC32C checksums of payloads.
+         *   Checksums are kept in a side table next to the archive (see VdfsChecksums), written on close.
+         *   The first commit marks a stored table stale, so archives closed without success have unknown checksums.
+         *   Archives opened with a side table maintain it automatically. Disabling removes the table on commit.
+         *   Note: Enabling reads all stored payloads without a checksum, in parallel.
+         * @param enabled true to maintain checksums.
+         * @return true, if the setting has been applied.
+         */
+        bool setChecksums(const bool enabled);
+
+        /**
+         * @brief getChecksums getter for the checksums of payloads.
+         * @return true, if checksums are maintained.
+         */
+        bool getChecksums() const
+        {
+            return checksums;
+        }
+
+        /**
+         * @brief verify checks the payloads of all entries against their checksums.
+         *   Payloads are split into contiguous ranges in offset order, each read front to back by a worker thread.
+         *   Results are streamed to the callback as soon as a payload is checked. Calls come from the workers,
+         *   one at a time. Entries sharing a payload get the same result. Empty entries have nothing to verify.
+         *   May be called in READ_ONLY_MAPPED mode. No modifying call may run at the same time.
+         * @param callback optional function, called for each verified entry.
+         * @return true, if no entry is corrupt or unreadable. Entries without checksum don't fail.
+         */
+        bool verify(const VerifyCallback& callback = nullptr);
+
+        /**
+         * @brief setAllocationPolicy sets the strategy to place new payloads in the archive.
+         * @param policy e.g. AllocationPolicy::APPEND_ONLY for write once archives.
+         */
+        void setAllocationPolicy(const AllocationPolicy policy)
+        {
+            memoryManager.setAllocationPolicy(policy);
+        }
+
+        /**
+         * @brief prefetch reads the given entries on a background thread, sorted by their payload offsets.
+         *   Read files are kept in a bounded cache (see setPrefetchCacheSize). A following readFile takes
+         *   a cached file instead of reading it again.
+         *   Modifying calls (writeFile, removeFile, compact, finalize, ...) cancel pending requests and clear the cache.
+         * @param fileEntries to read ahead.
+         * @param callback optional function, called on the prefetch thread for each entry, before its future gets ready.
+         * @return a future for each entry, in the order of fileEntries. It returns nullptr, if the entry couldn't be read
+         *   or the request has been canceled.
+         */
+        std::vector<std::shared_future<PrefetchedFile>> prefetch(const std::vector<const FileEntry*>& fileEntries,
+                                                                 const PrefetchCallback& callback = nullptr);
+
+        /**
+         * @brief cancelPrefetch drops all pending prefetch requests and the prefetch cache.
+         */
+        void cancelPrefetch()
+        {
+            prefetcher.cancel();
+        }
+
+        /**
+         * @brief setPrefetchCacheSize sets the maximum amount of prefetched bytes kept for readFile.
+         * @param bytes budget of the cache. Defaults to VdfsPrefetcher::DefaultCacheSize.
+         */
+        void setPrefetchCacheSize(const size_t bytes)
+        {
+            prefetcher.setCacheSize(bytes);
+        }
+
+        /**
+         * @brief getPrefetchCachedBytes returns the amount of prefetched bytes, that haven't been read yet.
+         */
+        size_t getPrefetchCachedBytes() const
+        {
+            return prefetcher.getCachedBytes();
+        }
+
+        /**
+         * @brief setPayloadCacheSize sets the size of the LRU cache for read entries.
+         *   Cached entries are returned by readFile and readFileShared without accessing the file.
+         *   writeFile and removeFile invalidate the affected entry, close clears the cache.
+         * @param bytes maximum amount of cached bytes. 0 (default) disables the cache.
+         */
+        void setPayloadCacheSize(const size_t bytes)
+        {
+            payloadCache.setSize(bytes);
+        }
+
+        /**
+         * @brief getPayloadCache returns the payload cache to query its counters.
+         */
+        const PayloadCache& getPayloadCache() const
+        {
+            return payloadCache;
+        }
+
         VDFSHeader& getHeader()
         {
             return header;
         }
 
+    protected:
+        /**
+         * @brief createFileCursor creates a depth first cursor over the index tree.
+         *   The files of a directory are visited before its subdirectories.
+         * @return a new cursor.
+         */
+        virtual std::unique_ptr<IFileEntryCursor> createFileCursor() override;
+
     private:
         BinFile file;                   //!< File handle to actually read/write to a file.
+        MappedFile mappedFile;          //!< Memory mapping of the file, used in read only mapped mode.
+        NativeFile nativeFile;          //!< Positional read handle, used for concurrent payload reads.
+        VdfsAccessMode accessMode;      //!< Mode the archive has been opened with.
         VDFSHeader header;              //!< Header of the vdfs file.
         size_t directoryOffsetCount;  //!< Counter for index writing. Offset to directory contents inside index.
         bool modified;                  //!< To be set if the index changes. finalize() will update it on archive closing.
+        bool indexCommitted;            //!< The header on disk references the current index region. It mustn't be overwritten.
+        std::vector<MemoryBlock> releasedBlocks; //!< Payloads released since the last commit. Freed by the next one.
+        bool incrementalFlush;          //!< Patch changed stages of the committed index in place.
+        bool checksums;                 //!< Maintain CRC32C checksums of the payloads in the side table.
+        VdfsChecksums checksumTable;    //!< Checksums of the stored payloads.
+        bool checksumTableStale;        //!< The side table on disk is outdated by a commit of this session.
+        bool layoutChanged;             //!< Entries have been added or removed since the last commit.
+        std::unordered_set<Tree<String, VdfsEntry>*> dirtyStages;                   //!< Stages with changed file entries.
+        std::unordered_map<const Tree<String, VdfsEntry>*, size_t> stagePositions;  //!< Stage -> first entry in the committed index.
+        bool compression;               //!< Compress payloads written by writeFile.
+        bool deduplication;             //!< Share identical payloads written by writeFile.
+        std::unordered_multimap<size_t, MemoryBlock> payloadLookup; //!< Content hash -> stored payload (deduplication).
+        std::unordered_map<size_t, size_t> payloadHashes;           //!< Offset of a stored payload -> content hash.
         MemoryManager memoryManager;    //!< Memory manager, that keeps track of used/free memory blocks.
 
         /**
@@ -441,9 +853,14 @@ namespace Clipped
          */
         struct
         {
-            MemorySize currentStoredSize = 0;   //!< Size of the index that is currently stored on the file in bytes.
+            MemorySize currentStoredSize = 0;   //!< Size of the index region behind the header in bytes. Marked as used.
             Tree<String, VdfsEntry> indexTree;  //!< Root stage of hierachical entry list.
+            std::unordered_map<String, VdfsEntry*> pathLookup;      //!< Normalized full path -> entry.
+            std::unordered_multimap<String, VdfsEntry*> nameLookup; //!< Filename -> entries.
+            std::multimap<size_t, VdfsEntry*> offsetLookup;         //!< Payload offset -> entries, ordered. Shared payloads have several.
         } vdfsIndex;                            //!< informations about the index and it's properties.
+        PayloadCache payloadCache;              //!< Recently read entries. Disabled by default.
+        VdfsPrefetcher prefetcher;              //!< Reads entries ahead. Declared last to be stopped first.
 
         //VDFS Archive specific properties:
         static const String CommentFillChar;    //!< Character used to fill up strings to target width.
@@ -451,6 +868,9 @@ namespace Clipped
         static const size_t SignatureLength;    //!< The length of the signature section inside the header.
         static const size_t EntryNameLength;    //!< The length of an entries name.
         static const size_t HeaderLength;       //!< The length of the header area, after which the index starts.
+        static const uint32_t CompressedMagic;  //!< Magic number at the start of compressed payloads.
+        static const size_t CompressedHeaderLength; //!< Length of the header of compressed payloads.
+        static const size_t ChecksumChunkSize;  //!< Bytes read at once by checksumPayloads.
 
         /**
          * @brief readHeader reads the vdfs header.
@@ -473,46 +893,134 @@ namespace Clipped
         bool readVDFSIndex();
 
         /**
-         * @brief writeVDFSIndex writes the index for the vdfs file.
+         * @brief writeVDFSIndex writes the index for the vdfs file and commits it with the header.
+         *   A committed index stays untouched. The new one is written to free memory then.
          * @return true, if index was successfully written.
          */
         bool writeVDFSIndex();
 
         /**
-         * @brief readIndexTree reads all entries to a directory tree.
-         *   Recursively called for subtrees.
+         * @brief flushDirtyStages patches the file entries of all dirty stages in the committed index.
+         *   Requires an unchanged layout and the position of every dirty stage.
+         * @return true, if all stages have been patched and the header is committed.
+         */
+        bool flushDirtyStages();
+
+        /**
+         * @brief markStageDirty marks the stage of an entry to be flushed by the next commit.
+         * @param entry with changed offset, size or attributes.
+         */
+        void markStageDirty(const VdfsEntry* entry);
+
+        /**
+         * @brief commitHeader syncs all written data and writes the header afterwards. Syncs the header, too.
+         *   The header write is the commit point of all modifications.
+         * @return true, if committed successfully.
+         */
+        bool commitHeader();
+
+        /**
+         * @brief checksumPayloads calculates the checksums of payloads in parallel.
+         *   The payloads are split into contiguous ranges of similar byte count, one per worker.
+         * @param payloads to process, ordered by offset.
+         * @param onResult called for every payload with its index, the read success and the checksum. Called by the workers.
+         */
+        void checksumPayloads(const std::vector<MemoryBlock>& payloads,
+                              const std::function<void(size_t, bool, uint32_t)>& onResult) const;
+
+        /**
+         * @brief freeReleasedBlocks frees the payloads released since the last commit.
+         */
+        void freeReleasedBlocks();
+
+        /**
+         * @brief readIndexTree parses all entries of a stage from the raw index to a directory tree.
+         *   Recursively called for subtrees, which are located by the offset of their directory entry.
+         *   Stages ordered like writeIndexTree orders them get their position recorded for incremental flushes.
          * @param tree to store objects in.
-         * @return Counter of extracted elements in this stage.
+         * @param directory normalized path of the stage including a trailing delimiter.
+         * @param indexData the complete raw index.
+         * @param stageStart number of the first entry of this stage inside the index.
+         * @param entriesRead counter of parsed entries. Gets increased by the entries of this stage and subtrees.
+         * @return true, if the stage has been parsed successfully.
          */
-        size_t readIndexTree(Tree<String, VdfsEntry>& tree);
+        bool readIndexTree(Tree<String, VdfsEntry>& tree, const String& directory,
+                           const char* indexData, const size_t stageStart, size_t& entriesRead);
 
         /**
-         * @brief writeIndexTree writes the local directory tree to the vdfs file.
+         * @brief writeIndexTree serializes the local directory tree into the index buffer.
+         *   Recursively called for subtrees.
          * @param tree to write.
-         * @return true, if index tree/subtree has been successfully written.
+         * @param indexData buffer, sized to hold all entries of the index.
+         * @param position byte position inside indexData to write the next entry at. Gets advanced.
+         */
+        void writeIndexTree(Tree<String, VdfsEntry>& tree, char* indexData, size_t& position);
+
+        /**
+         * @brief writeIndexEntry serializes a single index entry.
+         * @param target memory to write the entry to.
+         * @param name of the entry. Filled up with whitespaces to the entry name length.
+         * @param offset payload offset for files, first entry of the stage for directories.
+         * @param size of the payload.
+         * @param type flags of the entry.
+         * @param attribute flags of the entry.
          */
-        bool writeIndexTree(Tree<String, VdfsEntry>& tree);
+        static void writeIndexEntry(char* target, const String& name, const uint32_t offset,
+                                    const uint32_t size, const uint32_t type, const uint32_t attribute);
 
         /**
-         * @brief allocIndexMemory assures, that the index has free space at the right position.
-         *   Moves data to the end, if required, to free memeory for the index.
+         * @brief allocIndexMemory resizes the index region behind the header to the size of the current index.
+         *   Payloads located in the required region get relocated to free memory chosen by the memory manager.
          * @return true, if the index has enaugh place now.
          */
         bool allocIndexMemory();
 
         /**
-         * @brief getFirstStoredEntry gets the entry with the smallest offset from the index.
-         * @param entry pointer to vdfsEntry with smallest offset.
-         * @return true, if an entry has been found. false otherwise.
+         * @brief trackPayload adds an entry to the offset view. Empty entries don't occupy memory and are skipped.
+         * @param entry with its final offset and size set.
          */
-        bool getFirstStoredEntry(VdfsEntry*& entry);
+        void trackPayload(VdfsEntry* entry);
 
         /**
-         * @brief moveEntryDataToTheEnd moves the data of an entry to the file end and updates the offset in the index.
-         * @param entry to move.
+         * @brief untrackPayload removes an entry from the offset view.
+         * @param entry to remove. Its offset has to match the one it got tracked with.
+         */
+        void untrackPayload(const VdfsEntry* entry);
+
+        /**
+         * @brief movePayload copies a payload to newOffset and updates the offset of all entries sharing it.
+         *   Copied in chunks by NativeFile::copyRange. Source and target region may overlap.
+         *   The offset view, references and deduplication infos move along. Allocation and freeing is up to the caller.
+         * @param oldOffset current location of the payload.
+         * @param newOffset target location of the payload.
          * @return true, if moved successfully.
          */
-        bool moveEntryDataToTheEnd(VdfsEntry*& entry);
+        bool movePayload(const size_t oldOffset, const size_t newOffset);
+
+        /**
+         * @brief releasePayload frees the payload of an entry. Shared payloads are freed with their last entry.
+         *   The entry leaves the offset view.
+         * @param entry to release the payload of. Its offset and size stay untouched.
+         */
+        void releasePayload(const VdfsEntry* entry);
+
+        /**
+         * @brief hashPayload calculates the content hash of a payload used for deduplication.
+         * @param data of the payload.
+         * @param length of the payload.
+         * @return the hash.
+         */
+        static size_t hashPayload(const char* data, const size_t length);
+
+        /**
+         * @brief findStoredPayload looks up a stored payload, that is identical to the given data.
+         * @param hash content hash of data.
+         * @param data to look for.
+         * @param length amount of bytes.
+         * @param block location of the identical payload.
+         * @return true, if an identical payload has been found.
+         */
+        bool findStoredPayload(const size_t hash, const char* data, const size_t length, MemoryBlock& block) const;
 
         /**
          * @brief checkFileEntryIsVdfsEntry
@@ -522,12 +1030,98 @@ namespace Clipped
          */
         bool checkFileEntryIsVdfsEntry(FileEntry* check, VdfsEntry*& target) const;
 
+        /**
+         * @brief addToLookup registers an entry in the path and name lookup tables.
+         * @param entry to register. Its path has to be normalized already.
+         */
+        void addToLookup(VdfsEntry* entry);
+
+        /**
+         * @brief removeFromLookup unregisters an entry from the path and name lookup tables.
+         * @param entry to unregister.
+         */
+        void removeFromLookup(VdfsEntry* entry);
+
+        /**
+         * @brief getIndexStage walks the index tree to the stage of the given directory.
+         * @param directory path of the stage.
+         * @param createIfNotFound creates missing stages, if true.
+         * @return pointer to the stage or nullptr, if it doesn't exist.
+         */
+        Tree<String, VdfsEntry>* getIndexStage(const Path& directory, bool createIfNotFound);
+
+        /**
+         * @brief checkWriteAccess checks if the archive has been opened with write access.
+         * @return true, if modifications are allowed.
+         */
+        bool checkWriteAccess() const;
+
         /**
          * @brief getFreeMemoryOffset returns a file position offset with enaugh place to store the content.
          * @param requiredBytes amount of bytes to store.
          * @return an offset to write the content to.
          */
         size_t getFreeMemoryOffset(const size_t requiredBytes);
+
+        /**
+         * @brief placeEntry registers payload data, that has been written to the archive already, for an entry.
+         * @param entry to update.
+         * @param offset location of the payload.
+         * @param size of the stored payload.
+         * @param rawSize size of the file content (differs from size for compressed payloads).
+         * @param attribute of the entry, e.g. flagged as compressed.
+         * @return true, if the memory has been marked as used. False, if it's used already.
+         */
+        bool placeEntry(VdfsEntry* entry, const size_t offset, const size_t size,
+                        const size_t rawSize, const EntryAttribute attribute);
+
+        /**
+         * @brief compressPayload creates a compressed payload in the chunked format.
+         * @param rawSize amount of bytes to compress.
+         * @param readRaw function to get raw bytes: (offset, buffer, count) -> success.
+         * @param payload container to store the compressed payload in.
+         * @return true, if compressed successfully.
+         */
+        static bool compressPayload(const size_t rawSize, const std::function<bool(size_t, char*, size_t)>& readRaw,
+                                    std::vector<char>& payload);
+
+        /**
+         * @brief readEntryData reads the content of an entry from the archive, bypassing all caches.
+         * @param entry to read.
+         * @param dest buffer with at least the raw size of the entry.
+         * @return true, if read successfully.
+         */
+        bool readEntryData(const VdfsEntry* entry, char* dest) const;
+
+        /**
+         * @brief decompressRange decompresses a range of a compressed entry chunk by chunk to dest.
+         *   Only the chunks overlapping the range get read and decompressed.
+         * @param entry to read.
+         * @param offset of the first raw byte to decompress.
+         * @param length amount of raw bytes to decompress.
+         * @param dest buffer with at least length bytes.
+         * @return true, if decompressed successfully.
+         */
+        bool decompressRange(const VdfsEntry* entry, const size_t offset, const size_t length, char* dest) const;
+
+        /**
+         * @brief readCompressedHeader reads and validates the header of a compressed payload.
+         *   Magic, chunk math and the size of the chunk table have to fit into the payload.
+         * @param entry to query.
+         * @param payloadHeader filled with magic, raw size, chunk size and chunk count.
+         * @return true, if the payload starts with a valid header.
+         */
+        bool readCompressedHeader(const VdfsEntry* entry, uint32_t (&payloadHeader)[4]) const;
+
+        /**
+         * @brief readPayload reads stored bytes of a payload from the file or mapping.
+         * @param entry to read from.
+         * @param offset inside the payload.
+         * @param dest buffer to store the bytes in.
+         * @param count amount of bytes to read.
+         * @return true, if all bytes have been read from inside the payload.
+         */
+        bool readPayload(const VdfsEntry* entry, const size_t offset, char* dest, const size_t count) const;
     }; //class VDFSArchive
 
 }  // namespace Clipped
@@ -0,0 +1,217 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+/** \file cVdfsBuilder
+ * Builds new vdfs archives from many files at once.
+ * The layout is planned up front: The index region gets reserved directly behind the header and
+ * all payloads get streamed sequentially behind it, so nothing has to be moved on close.
+ * Source files are read by a pool of worker threads, while a single writer stores them in order.
+ */
+
+#pragma once
+
+#include <ClippedFilesystem/Archives/cVdfsArchive.h>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+namespace Clipped
+{
+    /**
+     * @brief The VDFSBuilder class collects the contents of a new vdfs archive and writes it in one go.
+     *   Payloads are stored in the order they have been added.
+     *   During build, worker threads load the source files ahead of the writer. The amount of loaded,
+     *   but not yet written sources is limited to a window of a few sources per worker.
+     */
+    class VDFSBuilder
+    {
+    public:
+        /**
+         * @brief VDFSBuilder creates a builder for a new archive.
+         * @param filepath of the archive to build. An existing file gets replaced.
+         */
+        VDFSBuilder(const Path& filepath);
+
+        /**
+         * @brief addFile adds a file of the local filesystem to the archive.
+         *   The file gets read during build.
+         * @param archivePath path of the entry inside the archive.
+         * @param sourcePath path of the file to add.
+         * @return true, if the file has been added to the plan.
+         */
+        bool addFile(const Path& archivePath, const Path& sourcePath);
+
+        /**
+         * @brief addBuffer adds a file with the given content to the archive.
+         * @param archivePath path of the entry inside the archive.
+         * @param data content of the file.
+         * @return true, if the file has been added to the plan.
+         */
+        bool addBuffer(const Path& archivePath, std::vector<char> data);
+
+        /**
+         * @brief build writes the archive with all added files and closes it.
+         * @return true, if the archive has been written successfully.
+         */
+        bool build();
+
+        /**
+         * @brief getHeader gives access to the header of the new archive, e.g. to set the comment.
+         * @return the header.
+         */
+        VDFSArchive::VDFSHeader& getHeader()
+        {
+            return archive.getHeader();
+        }
+
+        /**
+         * @brief setWorkerCount sets the amount of threads, that load source files during build.
+         * @param workers amount of threads. At least one is used.
+         */
+        void setWorkerCount(const size_t workers)
+        {
+            workerCount = (0 < workers) ? workers : 1;
+        }
+
+        /**
+         * @brief setCompression enables the compression of all payloads. Compressed by the worker threads.
+         * @param enabled true to compress the payloads (see VDFSArchive::setCompression).
+         */
+        void setCompression(const bool enabled)
+        {
+            compression = enabled;
+        }
+
+        /**
+         * @brief getWorkerCount getter for the amount of threads, that load source files during build.
+         * @return the amount of worker threads.
+         */
+        size_t getWorkerCount() const
+        {
+            return workerCount;
+        }
+
+        /**
+         * @brief getFileCount getter for the amount of added files.
+         * @return the amount of files, the archive will contain.
+         */
+        size_t getFileCount() const
+        {
+            return sources.size();
+        }
+
+        static const size_t WriteBufferSize; //!< Size of the buffer, small payloads are collected in before writing.
+        static const size_t SourcesPerWorker; //!< Sources each worker may load ahead of the writer.
+
+    private:
+        /**
+         * @brief The Source struct describes where the content of an entry comes from.
+         */
+        struct Source
+        {
+            String archivePath;         //!< Normalized path of the entry inside the archive.
+            Path sourcePath;            //!< Path of the file to read, if not empty.
+            std::vector<char> data;     //!< Content of the entry, if it isn't read from a file.
+        };
+
+        /**
+         * @brief The LoadedSource struct is the result of loading a source by a worker.
+         */
+        struct LoadedSource
+        {
+            std::vector<char> data;     //!< Content of a loaded source file or the compressed payload.
+            size_t size = 0;            //!< Size of the stored payload.
+            size_t rawSize = 0;         //!< Size of the file content.
+            bool compressed = false;    //!< Data contains a compressed payload.
+            bool direct = false;        //!< Source file too large to be loaded. Gets copied by the writer.
+            bool success = false;       //!< Source has been loaded successfully.
+            bool ready = false;         //!< Loading is done. Guarded by the mutex.
+        };
+
+        VDFSArchive archive;                                //!< The archive to build.
+        size_t workerCount;                                 //!< Amount of threads loading source files.
+        bool compression;                                   //!< Compress the payloads.
+        std::vector<Source> sources;                        //!< Planned entries in storage order.
+        std::unordered_map<String, size_t> sourceLookup;    //!< Normalized archive path -> index of the source.
+        std::vector<char> writeBuffer;                      //!< Collects payloads for large sequential writes.
+        size_t writeBufferOffset;                           //!< Archive offset of the first byte in the write buffer.
+
+        std::vector<LoadedSource> loaded;       //!< Load results, one per source.
+        std::mutex mutex;                       //!< Guards the load state below and the ready flags.
+        std::condition_variable sourceLoaded;   //!< Signals the writer, that a source is ready.
+        std::condition_variable sourceWritten;  //!< Signals the workers, that the window moved on.
+        size_t nextToLoad;                      //!< Index of the next source to be loaded by a worker.
+        size_t nextToWrite;                     //!< Index of the next source to be written by the writer.
+        bool aborted;                           //!< Set by the writer on errors to stop the workers.
+
+        /**
+         * @brief loadSources worker thread function. Loads sources, until all are loaded or the build is aborted.
+         */
+        void loadSources();
+
+        /**
+         * @brief loadSource loads the content of a source file. Sources from memory don't need to be loaded.
+         *   With compression, all sources get loaded and compressed.
+         * @param source to load.
+         * @param compress true to compress the payload.
+         * @param result loaded content.
+         */
+        static void loadSource(const Source& source, const bool compress, LoadedSource& result);
+
+        /**
+         * @brief writeSource writes a loaded source to the archive and registers it at its entry.
+         * @param source to write.
+         * @param result of loading the source.
+         * @param entry of the source in the archive.
+         * @param offset location of the payload. Gets advanced by the payload size.
+         * @return true, if written successfully.
+         */
+        bool writeSource(const Source& source, const LoadedSource& result, VdfsEntry* entry, size_t& offset);
+
+        /**
+         * @brief addSource registers a source. A source for the same archive path gets replaced.
+         * @param source to add.
+         * @return true, if the source has been added.
+         */
+        bool addSource(Source&& source);
+
+        /**
+         * @brief writePayload writes a payload at the given offset through the write buffer.
+         * @param offset location of the payload in the archive. Follows the previous payload.
+         * @param data content to write.
+         * @param length amount of bytes.
+         * @return true, if the payload has been written or buffered.
+         */
+        bool writePayload(const size_t offset, const char* data, const size_t length);
+
+        /**
+         * @brief flushWriteBuffer writes the collected payloads to the archive.
+         * @return true, if written successfully.
+         */
+        bool flushWriteBuffer();
+    }; //class VDFSBuilder
+} //namespace Clipped
@@ -0,0 +1,144 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+/** \file cVdfsChecksums
+ * Side table with CRC32C checksums of the payloads stored in a vdfs archive.
+ */
+
+#pragma once
+
+#include <ClippedUtils/cPath.h>
+#include <cstdint>
+#include <unordered_map>
+
+namespace Clipped
+{
+    /**
+     * @brief The VdfsChecksums class keeps CRC32C (CRC32ISCSI) checksums of stored payloads.
+     *   The vdfs format has no room for integrity data, so the table is stored in a file next to the archive.
+     *   Payloads are identified by offset and size. Entries sharing a payload share its checksum.
+     *   File layout (uint32 each): Magic, version, state, record count and the records (offset, size, checksum).
+     *   A stale state marks a table, that has been outdated by changes of the archive. Its records are unknown.
+     */
+    class VdfsChecksums
+    {
+    public:
+        /**
+         * @brief calculate calculates the checksum of a payload.
+         * @param data of the payload.
+         * @param length of the payload in bytes.
+         * @return the CRC32C checksum.
+         */
+        static uint32_t calculate(const char* data, const size_t length);
+
+        /**
+         * @brief getTablePath gets the path of the side table of an archive.
+         * @param archivePath path of the archive.
+         * @return the archive path with the extension ".crc" appended.
+         */
+        static Path getTablePath(const Path& archivePath);
+
+        /**
+         * @brief load reads a side table. The current records are replaced.
+         * @param filepath of the table.
+         * @return true, if the table has been read. A stale table is read without records.
+         *   False if it doesn't exist or is corrupt. The table is empty then.
+         */
+        bool load(const Path& filepath);
+
+        /**
+         * @brief save writes the table. It is written to a temporary file first, which replaces the old table.
+         *   So readers find either the old or the new table, never a partial one.
+         * @param filepath of the table.
+         * @return true, if the table has been written and synced.
+         */
+        bool save(const Path& filepath) const;
+
+        /**
+         * @brief markStale marks a stored table as outdated, before the archive changes. Only the state gets written.
+         * @param filepath of the table.
+         * @return true, if the state has been written and synced.
+         */
+        static bool markStale(const Path& filepath);
+
+        /**
+         * @brief set sets the checksum of a payload.
+         * @param offset of the payload.
+         * @param size of the payload.
+         * @param checksum of the payload.
+         */
+        void set(const size_t offset, const size_t size, const uint32_t checksum);
+
+        /**
+         * @brief get looks up the checksum of a payload.
+         * @param offset of the payload.
+         * @param size of the payload. A record with another size doesn't belong to the payload.
+         * @param checksum set to the stored checksum, if found.
+         * @return true, if a checksum is known.
+         */
+        bool get(const size_t offset, const size_t size, uint32_t& checksum) const;
+
+        /**
+         * @brief move moves the checksum of a payload to its new offset.
+         * @param oldOffset current offset of the payload.
+         * @param newOffset target offset of the payload.
+         */
+        void move(const size_t oldOffset, const size_t newOffset);
+
+        /**
+         * @brief erase drops the checksum of a payload.
+         * @param offset of the payload.
+         */
+        void erase(const size_t offset);
+
+        /**
+         * @brief clear drops all checksums.
+         */
+        void clear();
+
+        /**
+         * @brief getCount gets the amount of known checksums.
+         * @return the amount of records.
+         */
+        size_t getCount() const { return records.size(); }
+
+        static const uint32_t Magic;    //!< First bytes of a table file: "VCRC".
+        static const uint32_t Version;  //!< Version of the file layout.
+        static const uint32_t Valid;    //!< State of a table matching the archive.
+        static const uint32_t Stale;    //!< State of a table outdated by changes of the archive.
+
+    private:
+        /**
+         * @brief The Record struct holds the checksum of a single payload.
+         */
+        struct Record
+        {
+            uint32_t size;      //!< Size of the payload in bytes.
+            uint32_t checksum;  //!< CRC32C of the payload.
+        };
+        std::unordered_map<size_t, Record> records; //!< Payload offset -> record.
+    }; //class VdfsChecksums
+} //namespace Clipped
@@ -0,0 +1,159 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+/** \file cVdfsPrefetcher
+ * Reads entries of a vdfs archive ahead of time on a background thread.
+ * Requested entries are read in the order of their payload offsets, so the disk is read
+ * sequentially. Results are kept in a bounded cache and handed out via futures and callbacks.
+ */
+
+#pragma once
+
+#include <ClippedFilesystem/cIArchiver.h>
+#include <ClippedFilesystem/Archives/cPayloadCache.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Clipped
+{
+    class VDFSArchive;
+
+    using PrefetchedFile = SharedFileContent; //!< Content of a prefetched file. nullptr, if it couldn't be read.
+    using PrefetchCallback = std::function<void(const FileEntry*, const PrefetchedFile&)>; //!< Called on the prefetch thread.
+
+    /**
+     * @brief The VdfsPrefetcher class reads requested entries of a VDFSArchive on a background thread.
+     *   The thread runs like an elevator over the queued payload offsets: It always reads the next
+     *   request behind the last read position and wraps around at the end of the archive.
+     *   Read files stay in a cache limited to a byte budget. The oldest files get dropped first.
+     */
+    class VdfsPrefetcher
+    {
+    public:
+        /**
+         * @brief VdfsPrefetcher creates an idle prefetcher. The thread gets started on the first request.
+         * @param archive to read from.
+         */
+        VdfsPrefetcher(VDFSArchive& archive);
+
+        /**
+         * @brief ~VdfsPrefetcher cancels pending requests and stops the thread.
+         */
+        ~VdfsPrefetcher();
+
+        /**
+         * @brief request queues entries to be read in the background.
+         * @param entries pairs of payload offset and entry to read.
+         * @param callback optional function, called for each entry once it has been read.
+         * @return a future for each entry in the order of the given entries.
+         */
+        std::vector<std::shared_future<PrefetchedFile>> request(const std::vector<std::pair<size_t, const FileEntry*>>& entries,
+                                                                const PrefetchCallback& callback);
+
+        /**
+         * @brief take removes the content of a file from the cache.
+         * @param fileEntry to look up.
+         * @param content of the file, if cached.
+         * @return true, if the file has been cached.
+         */
+        bool take(const FileEntry* fileEntry, PrefetchedFile& content);
+
+        /**
+         * @brief cancel drops all queued requests and the cache. Waits for a running read to finish.
+         *   The futures of dropped requests return nullptr.
+         */
+        void cancel();
+
+        /**
+         * @brief setCacheSize sets the maximum amount of cached bytes. Drops the oldest files, if exceeded.
+         * @param bytes budget of the cache.
+         */
+        void setCacheSize(const size_t bytes);
+
+        /**
+         * @brief getCacheSize returns the maximum amount of cached bytes.
+         */
+        size_t getCacheSize() const;
+
+        /**
+         * @brief getCachedBytes returns the amount of bytes currently in the cache.
+         */
+        size_t getCachedBytes() const;
+
+        static const size_t DefaultCacheSize; //!< Cache budget of new prefetchers.
+
+    private:
+        /**
+         * @brief The Request struct describes a queued entry.
+         */
+        struct Request
+        {
+            const FileEntry* fileEntry;             //!< Entry to read.
+            std::promise<PrefetchedFile> promise;   //!< Gets the content, once read.
+            PrefetchCallback callback;              //!< Optional function to call, once read.
+        };
+
+        /**
+         * @brief run is the loop of the prefetch thread.
+         */
+        void run();
+
+        /**
+         * @brief insertIntoCache stores a read file. Needs the mutex to be locked.
+         * @param fileEntry the content belongs to.
+         * @param content of the file.
+         */
+        void insertIntoCache(const FileEntry* fileEntry, const PrefetchedFile& content);
+
+        /**
+         * @brief shrinkCache drops the oldest files, until the cache fits in size. Needs the mutex to be locked.
+         * @param size the cache has to fit in.
+         */
+        void shrinkCache(const size_t size);
+
+        VDFSArchive& archive;                               //!< Archive to read from.
+        std::multimap<size_t, Request> queue;               //!< Pending requests by payload offset.
+        size_t readPosition;                                //!< Offset behind the last read payload.
+        std::unordered_map<const FileEntry*, PrefetchedFile> cache; //!< Read files, not taken yet.
+        std::deque<const FileEntry*> cacheOrder;            //!< Cached files from old to new.
+        size_t cachedBytes;                                 //!< Sum of the cached file sizes.
+        size_t cacheSize;                                   //!< Budget of the cache.
+        bool reading;                                       //!< The thread reads an entry right now.
+        bool stopping;                                      //!< The thread has to exit.
+        mutable std::mutex mutex;                           //!< Guards all members above.
+        std::condition_variable requested;                  //!< Signals the thread new requests or stopping.
+        std::condition_variable idle;                       //!< Signals a finished read.
+        std::thread worker;                                 //!< The prefetch thread.
+    }; //class VdfsPrefetcher
+
+} //namespace Clipped
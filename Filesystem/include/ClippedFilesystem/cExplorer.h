@@ -1,11 +1,26 @@
 #pragma once
 
 #include <list>
+#include <vector>
 #include <ClippedUtils/cPath.h>
 #include <ClippedUtils/cMemory.h>
 
 namespace Clipped
 {
+    /**
+     * @brief The ExplorerEntry struct describes a file or directory found on the filesystem.
+     */
+    struct ExplorerEntry
+    {
+        ExplorerEntry() : directory(false), link(false), size(0), modified(0) {}
+
+        Path path;          //!< Full path of the object.
+        bool directory;     //!< True for directories.
+        bool link;          //!< True for symbolic links. The other members describe their target.
+        MemorySize size;    //!< Size in bytes. 0 for directories.
+        int64_t modified;   //!< Time of the last modification in ticks of the filesystem clock.
+    };
+
     /**
      * @brief The Explorer class handles filesystem tasks.
      */
@@ -84,6 +99,24 @@ namespace Clipped
          */
         static bool Exists(const Path& path);
 
+        /**
+         * @brief Stat queries the metadata of a file or directory. Symbolic links report the metadata of their target.
+         * @param path to the object.
+         * @param entry filled with the metadata.
+         * @return true, if the object exists and has been queried. False for dangling links.
+         */
+        static bool Stat(const Path& path, ExplorerEntry& entry);
+
+        /**
+         * @brief List enumerates the contents of a directory including their metadata.
+         *   Unlike searchFiles, it doesn't touch the current directory.
+         * @param directory to list.
+         * @param recursive wether to recurse into subdirectories, or not. Links to directories get listed, but not
+         *   recursed into, since they might form a cycle.
+         * @return the files and directories found. Empty, if the directory isn't readable.
+         */
+        static std::vector<ExplorerEntry> List(const Path& directory, bool recursive = false);
+
         /**
          * @brief Copy copies files or directories from one location to another.
          * @param from path or directory to copy.
@@ -83,6 +83,12 @@ namespace Clipped
          */
         void close();
 
+        /**
+         * @brief flush writes all buffered data to the file.
+         * @return true if flushed successfully, false otherwise.
+         */
+        bool flush();
+
         /**
          * @brief exists checks, wether the file exists on the file system or not.
          * @return
@@ -0,0 +1,123 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+#pragma once
+
+#include <ClippedFilesystem/cIArchiver.h>
+
+namespace Clipped
+{
+    /**
+     * @brief The FileEntryStream class reads a single entry of an archive piece by piece.
+     *   Small reads are served from a buffer of BufferSize bytes, that gets refilled from the archiver on demand.
+     *   So parsers can read huge entries lazily without loading them as a whole, and without
+     *   an archiver call per read value. The archiver and the entry have to outlive the stream.
+     */
+    class FileEntryStream
+    {
+    public:
+        static const size_t BufferSize; //!< Bytes fetched at once. One compression chunk of a VDFSArchive.
+
+        /**
+         * @brief FileEntryStream creates a stream positioned at the beginning of the entry.
+         * @param archiver the entry belongs to.
+         * @param fileEntry to read.
+         */
+        FileEntryStream(IArchiver& archiver, const FileEntry* fileEntry);
+
+        /**
+         * @brief read template for types. Reads any specified type from the stream.
+         * @param value to store the read data in.
+         * @return true, if read successfully.
+         */
+        template<class T>
+        bool read(T& value)
+        {
+            return readBytes(reinterpret_cast<char*>(&value), sizeof(T));
+        }
+
+        /**
+         * @brief readBytes reads count bytes to buffer and advances the position.
+         * @param buffer to store the data at.
+         * @param count amount of bytes to read.
+         * @return true, if read successfully. False, if less than count bytes are left.
+         */
+        bool readBytes(char* buffer, const size_t count);
+
+        /**
+         * @brief readBytes reads count bytes and appends them to buffer.
+         * @param buffer vector, the bytes get appended to.
+         * @param count amount of bytes to read.
+         * @return true, if read successfully. False, if less than count bytes are left.
+         */
+        bool readBytes(std::vector<char>& buffer, const size_t count);
+
+        /**
+         * @brief setPosition sets the current position inside the entry. Drops the buffer, if pos is outside of it.
+         * @param pos new position. May be the end of the entry at most.
+         * @return true, if set successfully.
+         */
+        bool setPosition(const size_t pos);
+
+        /**
+         * @brief getPosition gets the current position inside the entry.
+         * @return the position.
+         */
+        size_t getPosition() const;
+
+        /**
+         * @brief seek moves the position relative to the current position.
+         * @param delta positive or negative amount of bytes to move.
+         * @return true, if the new position is inside of the entry.
+         */
+        bool seek(const long delta);
+
+        /**
+         * @brief getSize returns the size of the entry.
+         */
+        size_t getSize() const;
+
+        /**
+         * @brief isEnd checks, if the position reached the end of the entry.
+         */
+        bool isEnd() const;
+
+    private:
+        IArchiver& archiver;        //!< Archiver the entry is read from.
+        const FileEntry* fileEntry; //!< Entry to read.
+        size_t size;                //!< Size of the entry.
+        size_t position;            //!< Current read position.
+        std::vector<char> buffer;   //!< Buffered bytes of the entry.
+        size_t bufferOffset;        //!< Position of the first buffered byte.
+
+        /**
+         * @brief fillBuffer fetches up to BufferSize bytes of the entry, starting at the current position.
+         * @return true, if filled successfully.
+         */
+        bool fillBuffer();
+    }; //class FileEntryStream
+
+} //namespace Clipped
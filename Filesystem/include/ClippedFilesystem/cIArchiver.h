@@ -30,6 +30,7 @@
 #include <ClippedUtils/cPath.h>
 #include <ClippedUtils/cMemory.h>
 #include <memory> //std::unique_ptr
+#include <iterator>
 
 namespace Clipped
 {
@@ -55,12 +56,105 @@ namespace Clipped
         bool getOverride() const; //!< Getter for the override flag.
 
         friend class VDFSArchive; //VDFS Archive needs to fill in data for an entry.
+        friend class DirectoryArchive; //Directory Archive updates the size of changed files.
 
     private:
         Path path;      //!< The path of this entry - relative to the FileManager's basePath.
         MemorySize size;//!< The memory size of this entry in bytes.
     }; //class FileEntry
 
+    /**
+     * @brief The IFileEntryCursor class is implemented by archivers to enumerate their files.
+     *   A cursor visits every file exactly once. Modifying the archive invalidates it.
+     */
+    class IFileEntryCursor
+    {
+    public:
+        virtual ~IFileEntryCursor() {}
+
+        /**
+         * @brief next moves the cursor on.
+         * @return the next file or nullptr, if all files have been visited.
+         */
+        virtual FileEntry* next() = 0;
+
+        /**
+         * @brief clone copies the cursor including its position.
+         * @return an independent cursor.
+         */
+        virtual std::unique_ptr<IFileEntryCursor> clone() const = 0;
+    }; //class IFileEntryCursor
+
+    /**
+     * @brief The FileEntryIterator class is a forward iterator over the files of an archiver.
+     *   Files not matching the glob pattern (see Path::globMatch) of the iterator get skipped.
+     */
+    class FileEntryIterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = FileEntry;
+        using difference_type = std::ptrdiff_t;
+        using pointer = FileEntry*;
+        using reference = FileEntry&;
+
+        /**
+         * @brief FileEntryIterator creates an end iterator.
+         */
+        FileEntryIterator();
+
+        /**
+         * @brief FileEntryIterator creates an iterator pointing to the first matching file of the cursor.
+         * @param cursor to take the files from.
+         * @param pattern glob pattern, the file paths have to match. Empty to visit all files.
+         */
+        FileEntryIterator(std::unique_ptr<IFileEntryCursor> cursor, const String& pattern);
+
+        FileEntryIterator(const FileEntryIterator& rhs);
+
+        FileEntryIterator& operator=(const FileEntryIterator& rhs);
+
+        FileEntry& operator*() const { return *current; }
+
+        FileEntry* operator->() const { return current; }
+
+        FileEntryIterator& operator++();
+
+        FileEntryIterator operator++(int);
+
+        bool operator==(const FileEntryIterator& rhs) const { return current == rhs.current; }
+
+        bool operator!=(const FileEntryIterator& rhs) const { return current != rhs.current; }
+
+    private:
+        /**
+         * @brief advance moves on to the next matching file.
+         */
+        void advance();
+
+        std::unique_ptr<IFileEntryCursor> cursor;   //!< Source of the files. nullptr for end iterators.
+        String pattern;                             //!< Glob pattern, the files have to match.
+        FileEntry* current;                         //!< Current file. nullptr at the end.
+    }; //class FileEntryIterator
+
+    /**
+     * @brief The FileEntryRange class makes the files of an archiver usable in range based for loops.
+     */
+    class FileEntryRange
+    {
+    public:
+        FileEntryRange(const FileEntryIterator& first)
+            : first(first)
+        {}
+
+        FileEntryIterator begin() const { return first; }
+
+        FileEntryIterator end() const { return FileEntryIterator(); }
+
+    private:
+        FileEntryIterator first; //!< Iterator to the first matching file.
+    }; //class FileEntryRange
+
     /**
      * @brief The IArchiver class implements an interface to list/read/write/update file entries in a hierachical organized file storages.
      *   This hierachical file storage could be a directory stored in the filesystem of the operating system or
@@ -95,7 +189,14 @@ namespace Clipped
          */
         virtual bool finalize();
 
-        //TODO: Interface methods iterator based multifile access.
+        //Interface methods (Multi file access):
+        /**
+         * @brief listFiles enumerates the files in the file storage. Each file is visited once in linear time.
+         *   The iterators get invalid, if files get created or removed.
+         * @param globPattern optional glob pattern (see Path::globMatch), the file paths have to match.
+         * @return range of the matching files.
+         */
+        FileEntryRange listFiles(const String& globPattern = "");
 
         //Interface methods (Single file access):
         /**
@@ -136,6 +237,18 @@ namespace Clipped
          */
         virtual bool readFile(const FileEntry* fileEntry, std::vector<char>& dest) = 0;
 
+        /**
+         * @brief readFileRange reads a part of the file data to the given dest pointer.
+         *   The default implementation reads the whole file. Archivers should override it,
+         *   if they are able to access parts of an entry directly.
+         * @param fileEntry describing the file to read.
+         * @param offset of the first byte to read, relative to the beginning of the file.
+         * @param length amount of bytes to read.
+         * @param dest pointer to the memory to store the data at.
+         * @return true, if the range has been read successfully. False, if it exceeds the file size.
+         */
+        virtual bool readFileRange(const FileEntry* fileEntry, const size_t offset, const size_t length, char* dest);
+
         /**
          * @brief writeFile writes given data to the file storage with a direct data pointer.
          * @param fileEntry describing the file to write.
@@ -168,7 +281,21 @@ namespace Clipped
          */
         const Path& getBasePath() const;
 
+        /**
+         * @brief normalizePath creates the key, archivers look up their files by.
+         *   Delimiters are unified to '/'. Leading, trailing and repeated delimiters are dropped.
+         * @param filepath to normalize.
+         * @return the normalized path.
+         */
+        static String normalizePath(const Path& filepath);
+
     protected:
+        /**
+         * @brief createFileCursor creates a cursor positioned in front of the first file of the storage.
+         * @return a new cursor.
+         */
+        virtual std::unique_ptr<IFileEntryCursor> createFileCursor() = 0;
+
         Path basePath; //!< Path to archive file or directory to work with.
     }; //class IArchiver
 
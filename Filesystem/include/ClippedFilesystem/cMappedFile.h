@@ -0,0 +1,103 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#pragma once
+
+#include <ClippedUtils/cPath.h>
+#include <ClippedUtils/cOsDetect.h>
+
+namespace Clipped
+{
+    /**
+     * @brief The MappedFile class maps a whole file read only into the address space of the process.
+     *   The contents can be accessed directly via pointer, without any copy or system call per access.
+     */
+    class MappedFile
+    {
+    public:
+        /**
+         * @brief MappedFile creates a mapped file object.
+         * @param filepath of the file to map.
+         */
+        MappedFile(const Path& filepath);
+
+        /**
+         * @brief ~MappedFile unmaps the file, if still mapped.
+         */
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /**
+         * @brief open maps the file read only.
+         * @return true, if the file has been mapped successfully.
+         */
+        bool open();
+
+        /**
+         * @brief close unmaps the file.
+         */
+        void close();
+
+        /**
+         * @brief isOpen checks wether the file is currently mapped.
+         * @return true if mapped, false otherwise.
+         */
+        bool isOpen() const;
+
+        /**
+         * @brief getData returns a pointer to the first byte of the mapped file.
+         * @return pointer to the mapped data or nullptr, if not mapped (or empty).
+         */
+        const char* getData() const;
+
+        /**
+         * @brief getSize returns the size of the mapped region.
+         * @return amount of mapped bytes.
+         */
+        size_t getSize() const;
+
+        /**
+         * @brief getFilepath returns the filepath of this file.
+         * @return the path.
+         */
+        const Path& getFilepath() const;
+
+    private:
+        Path filepath;      //!< Full filepath to the file.
+        const char* data;   //!< Start of the mapped memory region.
+        size_t size;        //!< Size of the mapped memory region.
+        bool opened;        //!< Flag indicating an active mapping.
+#if defined(WINDOWS)
+        void* fileHandle;   //!< Handle of the opened file.
+        void* mapHandle;    //!< Handle of the file mapping object.
+#elif defined(LINUX)
+        int fileDescriptor; //!< Descriptor of the opened file.
+#endif
+    }; //class MappedFile
+} //namespace Clipped
@@ -0,0 +1,145 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#pragma once
+
+#include "cFile.h"
+#include <ClippedUtils/cPath.h>
+#include <ClippedUtils/cOsDetect.h>
+
+namespace Clipped
+{
+    /**
+     * @brief The NativeFile class works directly on the file handle of the operating system.
+     *   All accesses are positional and don't use a shared file pointer or stream buffer,
+     *   so reads may be issued concurrently from several threads on the same instance.
+     */
+    class NativeFile
+    {
+    public:
+        /**
+         * @brief NativeFile creates a native file object.
+         * @param filepath of the file.
+         */
+        NativeFile(const Path& filepath);
+
+        /**
+         * @brief ~NativeFile closes the file handle, if still open.
+         */
+        ~NativeFile();
+
+        NativeFile(const NativeFile&) = delete;
+        NativeFile& operator=(const NativeFile&) = delete;
+
+        /**
+         * @brief open opens the file in the requested mode.
+         * @param accessMode requested access.
+         * @return true if successfull, false otherwise.
+         */
+        bool open(const FileAccessMode& accessMode);
+
+        /**
+         * @brief close closes this file handle.
+         */
+        void close();
+
+        /**
+         * @brief isOpen checks wether the file is currently opened.
+         * @return true if opened, false otherwise.
+         */
+        bool isOpen() const;
+
+        /**
+         * @brief getSize gets the current size of the opened file.
+         * @return the filesize.
+         */
+        size_t getSize() const;
+
+        /**
+         * @brief readAt reads count bytes located at offset to buffer.
+         *   Safe to be called concurrently.
+         * @param offset position inside the file to read from.
+         * @param buffer to store the bytes in.
+         * @param count amount of bytes to read.
+         * @return true, if all bytes have been read, false otherwise.
+         */
+        bool readAt(const size_t offset, char* buffer, size_t count) const;
+
+        /**
+         * @brief writeAt writes count bytes from buffer to the file at offset. Requires write access.
+         * @param offset position inside the file to write to.
+         * @param buffer bytes to write.
+         * @param count amount of bytes to write.
+         * @return true, if all bytes have been written, false otherwise.
+         */
+        bool writeAt(const size_t offset, const char* buffer, size_t count);
+
+        /**
+         * @brief copyRange copies count bytes from source to target without loading the whole range to memory.
+         *   Uses the zero-copy path of the kernel (copy_file_range), if available. Otherwise the bytes get copied
+         *   in chunks through a reused buffer. Source and target may be the same file with overlapping ranges.
+         * @param source file to read from.
+         * @param sourceOffset position of the first byte to copy in the source.
+         * @param target file to write to. Requires write access.
+         * @param targetOffset position to copy the first byte to in the target.
+         * @param count amount of bytes to copy.
+         * @return true, if all bytes have been copied, false otherwise.
+         */
+        static bool copyRange(const NativeFile& source, const size_t sourceOffset,
+                              NativeFile& target, const size_t targetOffset, const size_t count);
+
+        /**
+         * @brief truncate sets the size of the file. Requires write access.
+         * @param size new size of the file in bytes.
+         * @return true, if the size has been changed successfully.
+         */
+        bool truncate(const size_t size);
+
+        /**
+         * @brief sync blocks until all written bytes reached the storage device. Requires write access.
+         *   Used to order writes, that have to survive a crash in sequence.
+         * @return true, if synchronized successfully.
+         */
+        bool sync();
+
+        /**
+         * @brief getFilepath returns the filepath of this file.
+         * @return the path.
+         */
+        const Path& getFilepath() const;
+
+        static const size_t CopyBufferSize; //!< Size of the buffer used for chunked copies.
+
+    private:
+        Path filepath;      //!< Full filepath to the file.
+#if defined(WINDOWS)
+        void* fileHandle;   //!< Handle of the opened file.
+#elif defined(LINUX)
+        int fileDescriptor; //!< Descriptor of the opened file.
+#endif
+    }; //class NativeFile
+} //namespace Clipped
@@ -0,0 +1,475 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#include "Archives/cDirectoryArchive.h"
+#include <ClippedUtils/cLogger.h>
+#include <vector>
+
+using namespace Clipped;
+
+DirectoryArchive::DirectoryArchive(const Path& basePath)
+    : IArchiver(basePath)
+{}
+
+DirectoryArchive::~DirectoryArchive()
+{
+    refreshHandlers.clear(); //Owners might be gone already.
+    close();
+}
+
+bool DirectoryArchive::open()
+{
+    close();
+    ExplorerEntry info;
+    if(!Explorer::Stat(basePath, info) || !info.directory)
+    {
+        LogError() << "Directory " << basePath << " not found!";
+        return false;
+    }
+    scanDirectory("", info.modified);
+    notifyRefresh();
+    return true;
+}
+
+bool DirectoryArchive::close()
+{
+    const bool cached = !directories.empty();
+    nameLookup.clear();
+    files.clear();
+    directories.clear();
+    if(cached) notifyRefresh();
+    return true;
+}
+
+bool DirectoryArchive::refresh()
+{
+    std::vector<String> keys;
+    keys.reserve(directories.size());
+    for(const auto& directory : directories)
+    {
+        keys.push_back(directory.first);
+    }
+    bool changed = false;
+    for(const String& key : keys)
+    {
+        changed |= refreshDirectory(key); //Skips directories dropped by a refresh of their parent.
+    }
+    if(changed) notifyRefresh();
+    return changed;
+}
+
+void DirectoryArchive::attachRefreshHandler(const void* owner, const RefreshHandler& handler)
+{
+    refreshHandlers[owner] = handler;
+}
+
+void DirectoryArchive::removeRefreshHandler(const void* owner)
+{
+    refreshHandlers.erase(owner);
+}
+
+FileEntry* DirectoryArchive::getFile(const Path& filepath)
+{
+    const String key = normalizePath(filepath);
+    auto found = files.find(key);
+    if(found != files.end()) return &found->second;
+    if(key.empty() || directories.empty()) return nullptr;
+
+    //Not cached. Refresh the deepest cached directory of the path, in case the file has been added:
+    const std::vector<String> parts = key.split(String("/"));
+    String directory;
+    for(size_t i = 0; i + 1 < parts.size(); i++)
+    {
+        const String child = join(directory, parts[i]);
+        if(!directories.count(child)) break;
+        directory = child;
+    }
+    if(!refreshDirectory(directory)) return nullptr;
+    notifyRefresh();
+    return getCachedFile(filepath);
+}
+
+FileEntry* DirectoryArchive::getCachedFile(const Path& filepath)
+{
+    auto found = files.find(normalizePath(filepath));
+    return found != files.end() ? &found->second : nullptr;
+}
+
+FileEntry* DirectoryArchive::searchFile(const Path& filename)
+{
+    auto found = nameLookup.find(filename.getFilenameWithExt());
+    if (found != nameLookup.end())
+    {
+        return found->second;
+    }
+    return nullptr;
+}
+
+FileEntry* DirectoryArchive::createFile(const Path& filepath)
+{
+    if(directories.empty())
+    {
+        LogError() << "Directory archive " << basePath << " isn't opened!";
+        return nullptr;
+    }
+    const String key = normalizePath(filepath);
+    if(key.empty()) return nullptr;
+    auto found = files.find(key);
+    if(found != files.end()) return &found->second;
+
+    const std::vector<String> parts = key.split(String("/"));
+    String directory;
+    for(size_t i = 0; i + 1 < parts.size(); i++) //Create missing directories.
+    {
+        const String child = join(directory, parts[i]);
+        if(!directories.count(child))
+        {
+            ExplorerEntry info;
+            if(!Explorer::Stat(getFullPath(child), info) &&
+               (!Explorer::CreateDir(getFullPath(child)) || !Explorer::Stat(getFullPath(child), info)))
+            {
+                LogError() << "Can't create directory " << getFullPath(child) << "!";
+                return nullptr;
+            }
+            if(!info.directory)
+            {
+                LogError() << getFullPath(child) << " isn't a directory!";
+                return nullptr;
+            }
+            directories[directory].directories.insert(parts[i]);
+            scanDirectory(child, info.modified);
+        }
+        directory = child;
+    }
+    found = files.find(key); //Might have been cached by scanning a directory found on disk.
+    if(found != files.end()) return &found->second;
+
+    const Path fullPath = getFullPath(key);
+    ExplorerEntry info;
+    if(!Explorer::Stat(fullPath, info))
+    {
+        NativeFile file(fullPath);
+        if(!file.open(FileAccessMode::TRUNC) || (file.close(), !Explorer::Stat(fullPath, info)))
+        {
+            LogError() << "Can't create file " << fullPath << "!";
+            return nullptr;
+        }
+    }
+    if(info.directory)
+    {
+        LogError() << fullPath << " is a directory!";
+        return nullptr;
+    }
+    directories[directory].files.insert(parts.back());
+    return addFile(key, info);
+}
+
+bool DirectoryArchive::readFile(const FileEntry* fileEntry, char* dest)
+{
+    DirectoryEntry* entry = getCached(fileEntry);
+    if(!entry) return false;
+    const size_t expectedSize = static_cast<size_t>(entry->getSize());
+    NativeFile file(getFullPath(entry->getPath()));
+    if(!openCurrent(entry, file)) return false;
+    if(entry->getSize() != expectedSize)
+    {
+        LogError() << "File " << entry->getPath() << " changed on disk! Size is " << static_cast<size_t>(entry->getSize()) << " bytes now.";
+        return false;
+    }
+    return 0 == expectedSize || file.readAt(0, dest, expectedSize);
+}
+
+bool DirectoryArchive::readFile(const FileEntry* fileEntry, std::vector<char>& dest)
+{
+    DirectoryEntry* entry = getCached(fileEntry);
+    if(!entry) return false;
+    NativeFile file(getFullPath(entry->getPath()));
+    if(!openCurrent(entry, file)) return false;
+
+    const size_t vecPos = dest.size();
+    const size_t size = static_cast<size_t>(entry->getSize());
+    dest.resize(vecPos + size);
+    if(0 < size && !file.readAt(0, dest.data() + vecPos, size))
+    {
+        dest.resize(vecPos); //Drop the partially read data.
+        return false;
+    }
+    return true;
+}
+
+bool DirectoryArchive::readFileRange(const FileEntry* fileEntry, const size_t offset, const size_t length, char* dest)
+{
+    DirectoryEntry* entry = getCached(fileEntry);
+    if(!entry) return false;
+    NativeFile file(getFullPath(entry->getPath()));
+    if(!openCurrent(entry, file)) return false;
+
+    const size_t fileSize = static_cast<size_t>(entry->getSize());
+    if(offset > fileSize || length > fileSize - offset)
+    {
+        LogError() << "Range exceeds the size of the file!";
+        return false;
+    }
+    return 0 == length || file.readAt(offset, dest, length);
+}
+
+bool DirectoryArchive::writeFile(FileEntry* fileEntry, const char* src, const size_t length)
+{
+    DirectoryEntry* entry = getCached(fileEntry);
+    if(!entry) return false;
+    NativeFile file(getFullPath(entry->getPath()));
+    if(!file.open(FileAccessMode::TRUNC) || (0 < length && !file.writeAt(0, src, length)))
+    {
+        LogError() << "Can't write file " << file.getFilepath() << "!";
+        return false;
+    }
+    entry->size = length;
+    return true;
+}
+
+bool DirectoryArchive::writeFile(FileEntry* fileEntry, const std::vector<char>& src)
+{
+    return writeFile(fileEntry, src.data(), src.size());
+}
+
+bool DirectoryArchive::removeFile(FileEntry* fileEntry)
+{
+    DirectoryEntry* entry = getCached(fileEntry);
+    if(!entry) return false;
+    const String key = entry->getPath();
+    if(!Explorer::Remove(getFullPath(key), false))
+    {
+        LogError() << "Can't remove file " << getFullPath(key) << "!";
+        return false;
+    }
+    auto parent = directories.find(getParent(key));
+    if(parent != directories.end()) parent->second.files.erase(Path(key).getFilenameWithExt());
+    dropFile(key);
+    return true;
+}
+
+namespace
+{
+    /**
+     * @brief The DirectoryFileCursor class walks the cached files.
+     */
+    class DirectoryFileCursor : public IFileEntryCursor
+    {
+    public:
+        using Iterator = std::unordered_map<String, DirectoryEntry>::iterator;
+
+        DirectoryFileCursor(Iterator position, Iterator end)
+            : position(position)
+            , end(end)
+        {}
+
+        virtual FileEntry* next() override
+        {
+            if(position == end) return nullptr; //Done.
+            return &(position++)->second;
+        }
+
+        virtual std::unique_ptr<IFileEntryCursor> clone() const override
+        {
+            return std::unique_ptr<IFileEntryCursor>(new DirectoryFileCursor(*this));
+        }
+
+    private:
+        Iterator position;  //!< Next file to visit.
+        Iterator end;       //!< End of the cache.
+    }; //class DirectoryFileCursor
+}
+
+std::unique_ptr<IFileEntryCursor> DirectoryArchive::createFileCursor()
+{
+    return std::unique_ptr<IFileEntryCursor>(new DirectoryFileCursor(files.begin(), files.end()));
+}
+
+String DirectoryArchive::join(const String& directory, const String& name)
+{
+    return directory.empty() ? name : String(directory + "/" + name);
+}
+
+String DirectoryArchive::getParent(const String& key)
+{
+    const size_t separator = key.find_last_of('/');
+    return separator == String::npos ? String("") : String(key.substr(0, separator));
+}
+
+Path DirectoryArchive::getFullPath(const String& key) const
+{
+    return key.empty() ? basePath : Path(String(basePath) + "/" + key);
+}
+
+void DirectoryArchive::scanDirectory(const String& key, const int64_t modified)
+{
+    CachedDirectory& directory = directories[key];
+    directory.modified = modified;
+    for(const ExplorerEntry& info : Explorer::List(getFullPath(key)))
+    {
+        const String name = info.path.getFilenameWithExt();
+        if(info.directory && info.link) continue; //Might point to an ancestor and recurse endlessly.
+        if(info.directory)
+        {
+            directory.directories.insert(name);
+            scanDirectory(join(key, name), info.modified);
+        }
+        else
+        {
+            directory.files.insert(name);
+            addFile(join(key, name), info);
+        }
+    }
+}
+
+bool DirectoryArchive::refreshDirectory(const String& key)
+{
+    auto found = directories.find(key);
+    if(found == directories.end()) return false;
+    ExplorerEntry info;
+    if(!Explorer::Stat(getFullPath(key), info) || !info.directory)
+    {
+        dropDirectory(key);
+        return true;
+    }
+    CachedDirectory& directory = found->second;
+    if(info.modified == directory.modified) return false; //Unchanged. Saves the listing.
+    directory.modified = info.modified;
+
+    std::unordered_set<String> seenFiles, seenDirectories;
+    for(const ExplorerEntry& child : Explorer::List(getFullPath(key)))
+    {
+        const String name = child.path.getFilenameWithExt();
+        if(child.directory && child.link) continue; //Skipped like by scanDirectory.
+        if(child.directory)
+        {
+            seenDirectories.insert(name);
+            if(directory.directories.insert(name).second) scanDirectory(join(key, name), child.modified);
+        }
+        else
+        {
+            seenFiles.insert(name);
+            directory.files.insert(name);
+            addFile(join(key, name), child);
+        }
+    }
+    for(auto it = directory.files.begin(); it != directory.files.end();)
+    {
+        if(seenFiles.count(*it)) { it++; continue; }
+        dropFile(join(key, *it));
+        it = directory.files.erase(it);
+    }
+    for(auto it = directory.directories.begin(); it != directory.directories.end();)
+    {
+        if(seenDirectories.count(*it)) { it++; continue; }
+        dropDirectory(join(key, *it));
+        it = directory.directories.erase(it);
+    }
+    return true;
+}
+
+DirectoryEntry* DirectoryArchive::addFile(const String& key, const ExplorerEntry& info)
+{
+    auto found = files.find(key);
+    if(found == files.end())
+    {
+        found = files.emplace(key, DirectoryEntry(Path(key), info.size)).first;
+        nameLookup.emplace(Path(key).getFilenameWithExt(), &found->second);
+    }
+    else
+    {
+        found->second.size = info.size;
+    }
+    return &found->second;
+}
+
+void DirectoryArchive::dropFile(const String& key)
+{
+    auto found = files.find(key);
+    if(found == files.end()) return;
+    auto range = nameLookup.equal_range(Path(key).getFilenameWithExt());
+    for(auto it = range.first; it != range.second; it++)
+    {
+        if(it->second == &found->second)
+        {
+            nameLookup.erase(it);
+            break;
+        }
+    }
+    files.erase(found);
+}
+
+void DirectoryArchive::dropDirectory(const String& key)
+{
+    auto found = directories.find(key);
+    if(found == directories.end()) return;
+    for(const String& name : found->second.files)
+    {
+        dropFile(join(key, name));
+    }
+    for(const String& name : found->second.directories)
+    {
+        dropDirectory(join(key, name));
+    }
+    directories.erase(found);
+}
+
+DirectoryEntry* DirectoryArchive::getCached(const FileEntry* fileEntry) const
+{
+    const DirectoryEntry* entry = dynamic_cast<const DirectoryEntry*>(fileEntry);
+    if(!entry)
+    {
+        LogError() << "fileEntry given that wasn't constructed by a DirectoryArchive instance!";
+        return nullptr;
+    }
+    auto found = files.find(normalizePath(entry->getPath()));
+    if(found == files.end() || &found->second != entry) //Entry of another instance.
+    {
+        LogError() << "fileEntry given that isn't cached by this DirectoryArchive instance!";
+        return nullptr;
+    }
+    return const_cast<DirectoryEntry*>(&found->second);
+}
+
+bool DirectoryArchive::openCurrent(DirectoryEntry* entry, NativeFile& file)
+{
+    if(!file.open(FileAccessMode::READ_ONLY))
+    {
+        LogError() << "Can't open file " << file.getFilepath() << "!";
+        return false;
+    }
+    entry->size = file.getSize();
+    return true;
+}
+
+void DirectoryArchive::notifyRefresh()
+{
+    for(const auto& handler : refreshHandlers)
+    {
+        handler.second();
+    }
+}
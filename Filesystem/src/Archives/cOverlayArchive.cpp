@@ -0,0 +1,343 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#include "Archives/cOverlayArchive.h"
+#include <ClippedUtils/cLogger.h>
+
+using namespace Clipped;
+
+OverlayArchive::OverlayArchive()
+    : IArchiver(Path(""))
+{}
+
+OverlayArchive::~OverlayArchive()
+{
+    close();
+}
+
+bool OverlayArchive::mount(IArchiver& archive)
+{
+    for(const IArchiver* layer : layers)
+    {
+        if(layer == &archive)
+        {
+            LogError() << "Archive " << archive.getBasePath() << " is mounted already!";
+            return false;
+        }
+    }
+    layers.push_back(&archive);
+    mergeLayer(layers.size() - 1);
+    DirectoryArchive* directory = dynamic_cast<DirectoryArchive*>(&archive);
+    if(directory) directory->attachRefreshHandler(this, [this]() { open(); }); //Refreshes drop entries of the lookup.
+    return true;
+}
+
+DirectoryArchive* OverlayArchive::mountDirectory(const Path& directory)
+{
+    std::unique_ptr<DirectoryArchive> archive(new DirectoryArchive(directory));
+    if(!archive->open() || !mount(*archive)) return nullptr;
+    ownedLayers.emplace_back(std::move(archive));
+    return static_cast<DirectoryArchive*>(ownedLayers.back().get());
+}
+
+bool OverlayArchive::unmount(IArchiver& archive)
+{
+    for(auto it = layers.begin(); it != layers.end(); it++)
+    {
+        if(*it == &archive)
+        {
+            DirectoryArchive* directory = dynamic_cast<DirectoryArchive*>(&archive);
+            if(directory) directory->removeRefreshHandler(this);
+            layers.erase(it);
+            open(); //Layer indices shifted and shadowed files have to show up again.
+            for(auto owned = ownedLayers.begin(); owned != ownedLayers.end(); owned++)
+            {
+                if(owned->get() == &archive)
+                {
+                    ownedLayers.erase(owned);
+                    break;
+                }
+            }
+            return true;
+        }
+    }
+    LogError() << "Archive " << archive.getBasePath() << " isn't mounted!";
+    return false;
+}
+
+size_t OverlayArchive::getLayerCount() const
+{
+    return layers.size();
+}
+
+IArchiver* OverlayArchive::getLayer(const FileEntry* fileEntry) const
+{
+    const OverlayFile* visible = getVisible(fileEntry);
+    return visible ? layers[visible->layer] : nullptr;
+}
+
+bool OverlayArchive::open()
+{
+    pathLookup.clear();
+    nameLookup.clear();
+    entryLookup.clear();
+    for(size_t layer = 0; layer < layers.size(); layer++)
+    {
+        mergeLayer(layer);
+    }
+    return !layers.empty();
+}
+
+bool OverlayArchive::close()
+{
+    for(IArchiver* layer : layers)
+    {
+        DirectoryArchive* directory = dynamic_cast<DirectoryArchive*>(layer);
+        if(directory) directory->removeRefreshHandler(this);
+    }
+    layers.clear();
+    pathLookup.clear();
+    nameLookup.clear();
+    entryLookup.clear();
+    ownedLayers.clear();
+    return true;
+}
+
+bool OverlayArchive::finalize()
+{
+    return layers.empty() || layers.back()->finalize();
+}
+
+FileEntry* OverlayArchive::getFile(const Path& filepath)
+{
+    auto found = pathLookup.find(normalizePath(filepath));
+    return found != pathLookup.end() ? found->second.entry : nullptr;
+}
+
+FileEntry* OverlayArchive::searchFile(const Path& filename)
+{
+    const OverlayFile* best = nullptr;
+    auto range = nameLookup.equal_range(filename.getFilenameWithExt());
+    for(auto it = range.first; it != range.second; it++)
+    {
+        if(!best || best->layer < it->second->layer) best = it->second;
+    }
+    return best ? best->entry : nullptr;
+}
+
+FileEntry* OverlayArchive::createFile(const Path& filepath)
+{
+    if(layers.empty())
+    {
+        LogError() << "No layer mounted to create " << filepath << " in!";
+        return nullptr;
+    }
+    const String key = normalizePath(filepath);
+    if(key.empty()) return nullptr;
+
+    const size_t top = layers.size() - 1;
+    auto found = pathLookup.find(key);
+    if(found != pathLookup.end() && found->second.layer == top)
+    {
+        return found->second.entry;
+    }
+    FileEntry* entry = layers.back()->createFile(Path(key));
+    if(entry) addToLookup(key, entry, top);
+    return entry;
+}
+
+bool OverlayArchive::readFile(const FileEntry* fileEntry, char* dest)
+{
+    IArchiver* layer = getLayer(fileEntry);
+    if(!layer)
+    {
+        LogError() << "fileEntry given that isn't visible in this overlay!";
+        return false;
+    }
+    return layer->readFile(fileEntry, dest);
+}
+
+bool OverlayArchive::readFile(const FileEntry* fileEntry, std::vector<char>& dest)
+{
+    IArchiver* layer = getLayer(fileEntry);
+    if(!layer)
+    {
+        LogError() << "fileEntry given that isn't visible in this overlay!";
+        return false;
+    }
+    return layer->readFile(fileEntry, dest);
+}
+
+bool OverlayArchive::readFileRange(const FileEntry* fileEntry, const size_t offset, const size_t length, char* dest)
+{
+    IArchiver* layer = getLayer(fileEntry);
+    if(!layer)
+    {
+        LogError() << "fileEntry given that isn't visible in this overlay!";
+        return false;
+    }
+    return layer->readFileRange(fileEntry, offset, length, dest);
+}
+
+bool OverlayArchive::writeFile(FileEntry* fileEntry, const char* src, const size_t length)
+{
+    IArchiver* layer = getWritable(fileEntry);
+    return layer && layer->writeFile(fileEntry, src, length);
+}
+
+bool OverlayArchive::writeFile(FileEntry* fileEntry, const std::vector<char>& src)
+{
+    IArchiver* layer = getWritable(fileEntry);
+    return layer && layer->writeFile(fileEntry, src);
+}
+
+bool OverlayArchive::removeFile(FileEntry* fileEntry)
+{
+    IArchiver* layer = getWritable(fileEntry);
+    if(!layer) return false;
+    const String key = normalizePath(fileEntry->getPath()); //Entry is gone after the removal.
+    if(!layer->removeFile(fileEntry)) return false;
+    removeFromLookup(key);
+
+    for(size_t lower = layers.size() - 1; lower > 0; lower--) //Uncover the next shadowed file.
+    {
+        FileEntry* shadowed = getLayerFile(lower - 1, key);
+        if(shadowed)
+        {
+            addToLookup(key, shadowed, lower - 1);
+            break;
+        }
+    }
+    return true;
+}
+
+namespace
+{
+    /**
+     * @brief The OverlayFileCursor class walks the merged lookup.
+     */
+    class OverlayFileCursor : public IFileEntryCursor
+    {
+    public:
+        using Iterator = std::unordered_map<String, OverlayArchive::OverlayFile>::const_iterator;
+
+        OverlayFileCursor(Iterator position, Iterator end)
+            : position(position)
+            , end(end)
+        {}
+
+        virtual FileEntry* next() override
+        {
+            if(position == end) return nullptr; //Done.
+            return (position++)->second.entry;
+        }
+
+        virtual std::unique_ptr<IFileEntryCursor> clone() const override
+        {
+            return std::unique_ptr<IFileEntryCursor>(new OverlayFileCursor(*this));
+        }
+
+    private:
+        Iterator position;  //!< Next file to visit.
+        Iterator end;       //!< End of the lookup.
+    }; //class OverlayFileCursor
+}
+
+std::unique_ptr<IFileEntryCursor> OverlayArchive::createFileCursor()
+{
+    return std::unique_ptr<IFileEntryCursor>(new OverlayFileCursor(pathLookup.cbegin(), pathLookup.cend()));
+}
+
+void OverlayArchive::mergeLayer(const size_t layer)
+{
+    for(FileEntry& entry : layers[layer]->listFiles())
+    {
+        addToLookup(normalizePath(entry.getPath()), &entry, layer);
+    }
+}
+
+FileEntry* OverlayArchive::getLayerFile(const size_t layer, const String& key)
+{
+    DirectoryArchive* directory = dynamic_cast<DirectoryArchive*>(layers[layer]);
+    return directory ? directory->getCachedFile(Path(key)) : layers[layer]->getFile(Path(key));
+}
+
+void OverlayArchive::addToLookup(const String& key, FileEntry* entry, const size_t layer)
+{
+    auto found = pathLookup.find(key);
+    if(found == pathLookup.end())
+    {
+        found = pathLookup.emplace(key, OverlayFile{entry, layer}).first;
+        nameLookup.emplace(Path(key).getFilenameWithExt(), &found->second);
+    }
+    else //Shadow the file of the lower layer.
+    {
+        entryLookup.erase(found->second.entry);
+        found->second = OverlayFile{entry, layer};
+    }
+    entryLookup[entry] = &found->second;
+}
+
+void OverlayArchive::removeFromLookup(const String& key)
+{
+    auto found = pathLookup.find(key);
+    if(found == pathLookup.end()) return;
+
+    auto range = nameLookup.equal_range(Path(key).getFilenameWithExt());
+    for(auto it = range.first; it != range.second; it++)
+    {
+        if(it->second == &found->second)
+        {
+            nameLookup.erase(it);
+            break;
+        }
+    }
+    entryLookup.erase(found->second.entry);
+    pathLookup.erase(found);
+}
+
+const OverlayArchive::OverlayFile* OverlayArchive::getVisible(const FileEntry* fileEntry) const
+{
+    auto found = entryLookup.find(fileEntry);
+    return found != entryLookup.end() ? found->second : nullptr;
+}
+
+IArchiver* OverlayArchive::getWritable(const FileEntry* fileEntry) const
+{
+    const OverlayFile* visible = getVisible(fileEntry);
+    if(!visible)
+    {
+        LogError() << "fileEntry given that isn't visible in this overlay!";
+        return nullptr;
+    }
+    if(visible->layer + 1 != layers.size())
+    {
+        LogError() << "Entry " << fileEntry->getPath() << " belongs to a lower layer and is read only!";
+        return nullptr;
+    }
+    return layers.back();
+}
@@ -0,0 +1,140 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+#include "Archives/cPayloadCache.h"
+
+using namespace Clipped;
+
+PayloadCache::PayloadCache(const size_t size)
+    : size(size)
+    , cachedBytes(0)
+    , hits(0)
+    , misses(0)
+{
+}
+
+bool PayloadCache::get(const FileEntry* fileEntry, SharedFileContent& content)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if(0 == size) return false; //Disabled.
+    auto cached = lookup.find(fileEntry);
+    if(cached == lookup.end())
+    {
+        misses++;
+        return false;
+    }
+    hits++;
+    usage.splice(usage.begin(), usage, cached->second); //Most recently used now.
+    content = cached->second->second;
+    return true;
+}
+
+void PayloadCache::insert(const FileEntry* fileEntry, const SharedFileContent& content)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if(!content || content->size() > size) return; //Disabled or too big.
+    auto cached = lookup.find(fileEntry);
+    if(cached != lookup.end()) //Replace the old content.
+    {
+        cachedBytes -= cached->second->second->size();
+        usage.erase(cached->second);
+        lookup.erase(cached);
+    }
+    shrink(size - content->size());
+    usage.emplace_front(fileEntry, content);
+    lookup[fileEntry] = usage.begin();
+    cachedBytes += content->size();
+}
+
+void PayloadCache::invalidate(const FileEntry* fileEntry)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto cached = lookup.find(fileEntry);
+    if(cached == lookup.end()) return; //Not cached.
+    cachedBytes -= cached->second->second->size();
+    usage.erase(cached->second);
+    lookup.erase(cached);
+}
+
+void PayloadCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    shrink(0);
+}
+
+void PayloadCache::setSize(const size_t size)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    this->size = size;
+    shrink(size);
+}
+
+bool PayloadCache::isEnabled() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return 0 < size;
+}
+
+size_t PayloadCache::getSize() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return size;
+}
+
+size_t PayloadCache::getCachedBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return cachedBytes;
+}
+
+size_t PayloadCache::getHits() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return hits;
+}
+
+size_t PayloadCache::getMisses() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return misses;
+}
+
+void PayloadCache::resetCounters()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    hits = 0;
+    misses = 0;
+}
+
+void PayloadCache::shrink(const size_t size)
+{
+    while(cachedBytes > size && !usage.empty())
+    {
+        cachedBytes -= usage.back().second->size();
+        lookup.erase(usage.back().first);
+        usage.pop_back();
+    }
+}
@@ -28,6 +28,15 @@
 #include "Archives/cVdfsArchive.h"
 #include <ClippedUtils/cLogger.h>
 #include <ClippedUtils/cPath.h>
+#include <ClippedUtils/Compression/cLzCodec.h>
+#include <ClippedMaths/cCRC.h>
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+#include <iterator>
+#include <limits>
+#include <string_view>
+#include <thread>
 
 using namespace Clipped;
 
@@ -36,14 +45,21 @@ const size_t VDFSArchive::CommentLength = 256;
 const size_t VDFSArchive::SignatureLength = 16;
 const size_t VDFSArchive::EntryNameLength = 64;
 const size_t VDFSArchive::HeaderLength = 296;
+const size_t VDFSArchive::CompressionChunkSize = 64 * 1024;
+const uint32_t VDFSArchive::CompressedMagic = 0x315A4C43; //"CLZ1"
+const size_t VDFSArchive::CompressedHeaderLength = 4 * sizeof(uint32_t);
+const size_t VDFSArchive::ChecksumChunkSize = 1024 * 1024;
 
 /* ========================================================= */
 
 MemoryManager::MemoryManager(const size_t handledMemory)
     : handledBytes(handledMemory)
+    , totalFreeBytes(0)
+    , policy(AllocationPolicy::BEST_FIT)
+    , nextFitOffset(0)
 {
     //Initially one big free block:
-    freeMemoryBlocks.push_back(MemoryBlock(0, handledMemory));
+    insertFreeBlock(0, handledMemory);
 }
 
 bool MemoryManager::alloc(const size_t requestedBytes, MemoryBlock& allocatedMemoryInfo)
@@ -86,125 +102,151 @@ bool MemoryManager::alloc(const size_t offset, const size_t requestedBytes)
 
     if(offset < handledBytes) //Memory already managed
     {
-        //Search for memory block containing the storage segment.
-        bool foundBlock = false;
-
-        for(std::list<MemoryBlock>::iterator freeBlock = freeMemoryBlocks.begin(); freeBlock != freeMemoryBlocks.end(); freeBlock++)
+        //Search for memory block containing the storage segment: The last block starting at or before offset.
+        auto freeBlock = freeBlocksByOffset.upper_bound(offset);
+        if(freeBlock == freeBlocksByOffset.begin())
         {
-            if(freeBlock->offset <= offset && (offset + requestedBytes) <= freeBlock->offset + freeBlock->size)
-            {
-                const size_t freeBefore = offset - freeBlock->offset;
-                const size_t freeAfter = (freeBlock->offset + freeBlock->size) - (offset + requestedBytes);
-                if(0 == freeBefore && 0 == freeAfter) //Block used entirely
-                {
-                    freeMemoryBlocks.erase(freeBlock); //Remove free block
-                }
-                else if((0 == freeBefore) ^ (0 == freeAfter)) //Only one side has free memory left.
-                {
-                    if(0 != freeBefore) //Memory located at the beginning
-                    {
-                        freeBlock->size = freeBefore;
-                    }
-                    else //Memory located at the end
-                    {
-                        freeBlock->offset = freeBlock->offset + freeBlock->size - freeAfter; //Update offset
-                        freeBlock->size = freeAfter;
-                    }
-                }
-                else //Both sides has free memory left.
-                {
-                    MemoryBlock freeBeforeBlock = *freeBlock; //Copy current freeBlock.
-                    freeBeforeBlock.size = freeBefore;
+            return false; //No free block in front of offset.
+        }
+        freeBlock--;
 
-                    MemoryBlock freeAfterBlock;
-                    freeAfterBlock.offset = freeBlock->offset + freeBlock->size - freeAfter;
-                    freeAfterBlock.size = freeAfter;
+        const size_t blockOffset = freeBlock->first;
+        const size_t blockSize = freeBlock->second;
+        if(offset + requestedBytes > blockOffset + blockSize)
+        {
+            return false; //Memory (partially) used already.
+        }
 
-                    *freeBlock = freeAfterBlock; //Current freeBlock is the new freeAfterBlock.
-                    freeMemoryBlocks.insert(freeBlock, freeBeforeBlock); //FreeBefore block gets inserted in front.
-                }
-                foundBlock = true;
-                break; //Stop searching - We found the block.
-            }
-            else //Memory not contained in this block.
-            {
-                //Nothing to do - Go on with searching.
-            }
+        const size_t freeBefore = offset - blockOffset;
+        const size_t freeAfter = (blockOffset + blockSize) - (offset + requestedBytes);
+        eraseFreeBlock(freeBlock);
+        if(0 != freeBefore) //Free memory left at the beginning
+        {
+            insertFreeBlock(blockOffset, freeBefore);
+        }
+        if(0 != freeAfter) //Free memory left at the end
+        {
+            insertFreeBlock(offset + requestedBytes, freeAfter);
         }
-        return foundBlock;
+        return true;
     }
     else //Memory currently unmanaged - Expand handledBytes area
     {
         const size_t freeBefore = offset - handledBytes;
+        const size_t gapOffset = handledBytes;
+        handledBytes += freeBefore;
+        handledBytes += requestedBytes;
         if(0 < freeBefore) //If there is free memory in front
         {
-            freeMemoryBlocks.push_back(MemoryBlock(handledBytes, freeBefore)); //Add it to freeMemBlocks.
-        }
-        else //No free memory in front
-        {
-            //Nothing to do.
+            this->free(gapOffset, freeBefore); //Combines it with a free block at the end.
         }
-        handledBytes += freeBefore;
-        handledBytes += requestedBytes;
         return true; //Has allocated.
     }
-    return false; //Should never be reached.
+}
+
+void MemoryManager::insertFreeBlock(const size_t offset, const size_t size)
+{
+    if(0 == size) return; //Empty blocks aren't tracked.
+    freeBlocksByOffset.emplace(offset, size);
+    freeBlocksBySize.emplace(size, offset);
+    totalFreeBytes += size;
+}
+
+std::map<size_t, size_t>::iterator MemoryManager::eraseFreeBlock(std::map<size_t, size_t>::iterator block)
+{
+    freeBlocksBySize.erase(std::make_pair(block->second, block->first));
+    totalFreeBytes -= block->second;
+    return freeBlocksByOffset.erase(block);
 }
 
 bool MemoryManager::allocateInFreeBlock(const size_t requestedBytes, MemoryBlock& allocatedMemoryInfo)
 {
-    bool hasAllocated = false;
+    auto freeBlock = findFreeBlock(requestedBytes);
+    if(freeBlock == freeBlocksByOffset.end())
+    {
+        return false; //No free block is large enaugh (or policy doesn't reuse free blocks).
+    }
+
+    const size_t blockOffset = freeBlock->first;
+    const size_t blockSize = freeBlock->second;
+    eraseFreeBlock(freeBlock);
+    insertFreeBlock(blockOffset + requestedBytes, blockSize - requestedBytes); //Left over free memory.
 
-    for(auto& freeBlock : freeMemoryBlocks) //Search for a block with enaugh free memory.
+    allocatedMemoryInfo.offset = blockOffset;
+    allocatedMemoryInfo.size = requestedBytes;
+    nextFitOffset = blockOffset + requestedBytes;
+    return true;
+}
+
+std::map<size_t, size_t>::iterator MemoryManager::findFreeBlock(const size_t requestedBytes)
+{
+    switch(policy)
     {
-        if(freeBlock.size >= requestedBytes) //Enaugh size to store the element.
+        case AllocationPolicy::FIRST_FIT:
+        {
+            for(auto it = freeBlocksByOffset.begin(); it != freeBlocksByOffset.end(); it++)
+            {
+                if(it->second >= requestedBytes) return it;
+            }
+            break;
+        }
+        case AllocationPolicy::BEST_FIT:
+        {
+            //Smallest free block with enaugh free memory:
+            auto bestFit = freeBlocksBySize.lower_bound(std::make_pair(requestedBytes, static_cast<size_t>(0)));
+            if(bestFit != freeBlocksBySize.end()) return freeBlocksByOffset.find(bestFit->second);
+            break;
+        }
+        case AllocationPolicy::NEXT_FIT:
         {
-            allocatedMemoryInfo.offset = freeBlock.offset;
-            allocatedMemoryInfo.size = requestedBytes;
-            if(freeBlock.size > requestedBytes) //Left over free memory ?
+            //Search from the last allocation to the end, then wrap around to the beginning.
+            auto start = freeBlocksByOffset.lower_bound(nextFitOffset);
+            for(auto it = start; it != freeBlocksByOffset.end(); it++)
             {
-                //Adjust offset and size.
-                freeBlock.offset += requestedBytes;
-                freeBlock.size -= requestedBytes;
+                if(it->second >= requestedBytes) return it;
             }
-            else //Free block completely filled up now.
+            for(auto it = freeBlocksByOffset.begin(); it != start; it++)
             {
-                freeMemoryBlocks.remove(freeBlock); //Remove it from the list of free blocks.
+                if(it->second >= requestedBytes) return it;
             }
-            hasAllocated = true; //Memory allocated now.
-            break; //Stop searching for free memory block.
+            break;
         }
-        else //This free block is to small.
+        case AllocationPolicy::APPEND_ONLY:
         {
-            //Nothing to do - continue searching for matching free block.
+            break; //Free blocks are never reused.
         }
-    } //End for search free block
-
-    return hasAllocated;
+    }
+    return freeBlocksByOffset.end();
 }
 
 bool MemoryManager::allocateExpandLastFreeBlock(const size_t requestedBytes, MemoryBlock& allocatedMemoryInfo)
 {
-    bool hasAllocated = false;
-
-    //Extend last block of free memory to make it fit.
-    if(!freeMemoryBlocks.empty()) //If there is at least one block with free memory.
+    if(freeBlocksByOffset.empty() || AllocationPolicy::APPEND_ONLY == policy)
     {
-        MemoryBlock& lastFreeMemoryBlock = freeMemoryBlocks.back(); //The last block of free memory
-        size_t missingBytes = requestedBytes - lastFreeMemoryBlock.size;
-        lastFreeMemoryBlock.size += missingBytes; //gets now extended by the missing amount of bytes
-        handledBytes += missingBytes; //the manager gets it's counter of total handled bytes updated
-        allocatedMemoryInfo.offset = lastFreeMemoryBlock.offset; //The allocated memory gets returned.
-        allocatedMemoryInfo.size = lastFreeMemoryBlock.size;
-        freeMemoryBlocks.remove(lastFreeMemoryBlock); //And the now completely used block gets removed from the free mem list.
-        hasAllocated = true;
+        return false; //No free memory block left to expand or free blocks must not be reused.
     }
-    else //No free memory block left to expand.
+
+    auto lastFreeMemoryBlock = std::prev(freeBlocksByOffset.end()); //The last block of free memory
+    if(lastFreeMemoryBlock->first + lastFreeMemoryBlock->second != handledBytes)
     {
-        hasAllocated = false;
+        return false; //Used memory behind the last free block. It can't be expanded.
     }
 
-    return hasAllocated;
+    const size_t blockOffset = lastFreeMemoryBlock->first;
+    const size_t blockSize = lastFreeMemoryBlock->second;
+    eraseFreeBlock(lastFreeMemoryBlock); //The block gets used, so it's removed from the free mem list.
+    if(requestedBytes < blockSize) //Large enaugh already. Keep the rest free.
+    {
+        insertFreeBlock(blockOffset + requestedBytes, blockSize - requestedBytes);
+    }
+    else
+    {
+        handledBytes += requestedBytes - blockSize; //the manager gets it's counter of total handled bytes updated
+    }
+    allocatedMemoryInfo.offset = blockOffset; //The allocated memory gets returned.
+    allocatedMemoryInfo.size = requestedBytes;
+    nextFitOffset = blockOffset + requestedBytes;
+    return true;
 }
 
 bool MemoryManager::allocateWithNewMemory(const size_t requestedBytes, MemoryBlock& allocatedMemoryInfo)
@@ -214,6 +256,7 @@ bool MemoryManager::allocateWithNewMemory(const size_t requestedBytes, MemoryBlo
     allocatedMemoryInfo.offset = handledBytes;
     allocatedMemoryInfo.size = requestedBytes;
     handledBytes += requestedBytes;
+    nextFitOffset = handledBytes;
     hasAllocated = true;
 
     return hasAllocated;
@@ -221,40 +264,54 @@ bool MemoryManager::allocateWithNewMemory(const size_t requestedBytes, MemoryBlo
 
 bool MemoryManager::free(const MemoryBlock& freeMemoryInfo)
 {
-    bool hasFreed = false;
-
-    if(freeMemoryInfo.offset + freeMemoryInfo.size <= handledBytes) //In range of the manager ?
+    if(freeMemoryInfo.offset + freeMemoryInfo.size > handledBytes) //Not in range of the manager ?
     {
-        size_t freeMemoryEndPosition = freeMemoryInfo.offset + freeMemoryInfo.size;
+        //Should never happen. Memory, which shall be freed, isn't in range of this manager.
+        LogError() << "Bug. Cannot free memory I'm not responsible for!";
+        return false;
+    }
+    if(0 == freeMemoryInfo.size)
+    {
+        return true; //Nothing to free.
+    }
+    auto shared = references.find(freeMemoryInfo.offset);
+    if(shared != references.end()) //Still in use by others ? Drop one reference only.
+    {
+        if(0 == --shared->second) references.erase(shared);
+        return true;
+    }
+
+    size_t offset = freeMemoryInfo.offset;
+    size_t size = freeMemoryInfo.size;
 
-        //Search for right hand side free block.
-        for(auto it = freeMemoryBlocks.begin(); it != freeMemoryBlocks.end(); it++)
+    auto rightBlock = freeBlocksByOffset.lower_bound(offset); //First free block at or behind the memory.
+    if(rightBlock != freeBlocksByOffset.end() && rightBlock->first < offset + size)
+    {
+        LogError() << "Bug. Memory at offset " << offset << " is freed already!";
+        return false;
+    }
+    if(rightBlock != freeBlocksByOffset.begin())
+    {
+        auto leftBlock = std::prev(rightBlock);
+        if(leftBlock->first + leftBlock->second > offset)
         {
-            if(freeMemoryEndPosition <= it->offset) //Are we in front of following free block ?
-            {
-                freeMemoryBlocks.insert(it, freeMemoryInfo); //Insert in front of right hand side free block.
-                hasFreed = true;
-                break; //Stop searching.
-            }
-            else
-            {
-                //Nothing to do -- Free block isn't located on the right side. Go on with searching.
-            }
-        } //forsearch right hand side free memory block.
-        if(false == hasFreed) //No right hand side free block found ?
+            LogError() << "Bug. Memory at offset " << offset << " is freed already!";
+            return false;
+        }
+        if(leftBlock->first + leftBlock->second == offset) //Adjacent free block in front ?
         {
-            //Append new free memory block to the end of the list.
-            freeMemoryBlocks.push_back(freeMemoryInfo);
-            hasFreed = true;
+            offset = leftBlock->first;
+            size += leftBlock->second;
+            eraseFreeBlock(leftBlock);
         }
-        optimizeFreeMemoryBlocks(); //Combine adjacent free memory blocks, if possible.
     }
-    else //Should never happen. Memory, which shall be freed, isn't in range of this manager.
+    if(rightBlock != freeBlocksByOffset.end() && rightBlock->first == offset + size) //Adjacent free block behind ?
     {
-        hasFreed = false;
-        LogError() << "Bug. Cannot free memory I'm not responsible for!";
+        size += rightBlock->second;
+        eraseFreeBlock(rightBlock);
     }
-    return hasFreed;
+    insertFreeBlock(offset, size);
+    return true;
 }
 
 bool MemoryManager::free(const size_t offset, const size_t length)
@@ -262,35 +319,81 @@ bool MemoryManager::free(const size_t offset, const size_t length)
     return this->free(MemoryBlock(offset, length));
 }
 
+bool MemoryManager::addReference(const MemoryBlock& block)
+{
+    if(0 == block.size || block.offset + block.size > handledBytes)
+    {
+        return false; //Nothing or not managed memory can't be shared.
+    }
+    auto rightBlock = freeBlocksByOffset.lower_bound(block.offset);
+    if(rightBlock != freeBlocksByOffset.end() && rightBlock->first < block.offset + block.size)
+    {
+        return false; //Free memory inside of the block.
+    }
+    if(rightBlock != freeBlocksByOffset.begin() && std::prev(rightBlock)->first + std::prev(rightBlock)->second > block.offset)
+    {
+        return false; //Block starts in free memory.
+    }
+    references[block.offset]++;
+    return true;
+}
+
+void MemoryManager::moveReferences(const size_t oldOffset, const size_t newOffset)
+{
+    auto shared = references.find(oldOffset);
+    if(shared == references.end() || oldOffset == newOffset) return; //Nothing to move.
+    const size_t count = shared->second;
+    references.erase(shared);
+    references[newOffset] = count;
+}
+
 void MemoryManager::optimizeFreeMemoryBlocks()
 {
-    auto leftIt = freeMemoryBlocks.begin();
+    auto leftIt = freeBlocksByOffset.begin();
 
-    if(leftIt != freeMemoryBlocks.end())
+    while(leftIt != freeBlocksByOffset.end()) //Optimize the whole list of free memory.
     {
-        auto rightIt = freeMemoryBlocks.begin();
-        rightIt++;
-        while(rightIt != freeMemoryBlocks.end()) //Optimize the whole list of free memory.
+        auto rightIt = std::next(leftIt);
+        if(rightIt != freeBlocksByOffset.end() && leftIt->first + leftIt->second == rightIt->first) //Adjacent blocks ?
         {
-            if(leftIt->offset + leftIt->size == rightIt->offset) //Adjacent blocks ?
-            {
-                leftIt->size += rightIt->size;      //Combine free memory blocks.
-                freeMemoryBlocks.erase(rightIt);    //Remove right one.
-                continue; //Skip iterator incrementing. Recheck current left with new right one.
-            }
-            else
-            {
-                //Nothing to do -- No adjacent blocks. Blocks aren't 'touching' each other.
-            }
-            //Move check scope to the next free blocks.
-            leftIt++;
-            rightIt++;
-        } //while iterate over all free blocks.
+            const size_t offset = leftIt->first;
+            const size_t size = leftIt->second + rightIt->second;
+            eraseFreeBlock(leftIt);
+            eraseFreeBlock(rightIt);
+            insertFreeBlock(offset, size); //Combined free memory block.
+            leftIt = freeBlocksByOffset.find(offset); //Recheck combined block with the new right one.
+        }
+        else
+        {
+            leftIt++; //Move check scope to the next free blocks.
+        }
     }
-    else
+}
+
+bool MemoryManager::getNextFreeBlock(const size_t offset, MemoryBlock& block) const
+{
+    auto freeBlock = freeBlocksByOffset.lower_bound(offset);
+    if(freeBlock == freeBlocksByOffset.end())
     {
-        //Nothing to do -- No free memory blocks available.
+        return false; //No free memory behind offset.
+    }
+    block.offset = freeBlock->first;
+    block.size = freeBlock->second;
+    return true;
+}
+
+size_t MemoryManager::trimFreeEnd()
+{
+    if(!freeBlocksByOffset.empty())
+    {
+        auto lastFreeMemoryBlock = std::prev(freeBlocksByOffset.end());
+        if(lastFreeMemoryBlock->first + lastFreeMemoryBlock->second == handledBytes) //Free block at the end ?
+        {
+            handledBytes = lastFreeMemoryBlock->first;
+            eraseFreeBlock(lastFreeMemoryBlock);
+        }
     }
+    return handledBytes;
 }
 
 /* =================== Memory Manager =================== */
@@ -298,19 +401,52 @@ void MemoryManager::optimizeFreeMemoryBlocks()
 VDFSArchive::VDFSArchive(const Path& filepath)
     : IArchiver(filepath)
     , file(basePath)
+    , mappedFile(basePath)
+    , nativeFile(basePath)
+    , accessMode(VdfsAccessMode::READ_WRITE)
     , directoryOffsetCount(0)
     , modified(false)
+    , indexCommitted(false)
+    , incrementalFlush(false)
+    , checksums(false)
+    , checksumTableStale(false)
+    , layoutChanged(false)
+    , compression(false)
+    , deduplication(false)
+    , payloadCache(0)
+    , prefetcher(*this)
 {
 }
 
 VDFSArchive::~VDFSArchive()
 {
-    finalize();
+    close();
 }
 
 bool VDFSArchive::open()
 {
-    bool result = file.open(FileAccessMode::READ_WRITE);
+    return open(VdfsAccessMode::READ_WRITE);
+}
+
+bool VDFSArchive::open(const VdfsAccessMode accessMode)
+{
+    this->accessMode = accessMode;
+    bool result = false;
+    switch(accessMode)
+    {
+        case VdfsAccessMode::READ_WRITE:
+        {
+            result = file.open(FileAccessMode::READ_WRITE);
+            if (result) result = nativeFile.open(FileAccessMode::READ_WRITE);
+            break;
+        }
+        case VdfsAccessMode::READ_ONLY_MAPPED:
+        {
+            result = file.open(FileAccessMode::READ_ONLY); //Used to parse the header and index.
+            if (result) result = mappedFile.open();
+            break;
+        }
+    }
     if (!result)
     {
         LogError() << "File cannot be opened!";
@@ -328,40 +464,59 @@ bool VDFSArchive::open()
         LogError() << "VDFS Index corrupt!";
         return result;
     }
+    indexCommitted = true; //The index read is referenced by the header on disk.
+    const Path tablePath = VdfsChecksums::getTablePath(basePath);
+    checksums = File(tablePath).exists() && checksumTable.load(tablePath); //Keep maintaining an existing side table.
+    checksumTableStale = false;
     return result;
 }
 
 bool VDFSArchive::create()
 {
+    accessMode = VdfsAccessMode::READ_WRITE;
     bool result = file.open(FileAccessMode::TRUNC);
+    if(result) result = nativeFile.open(FileAccessMode::READ_WRITE);
     header.rootOffset = VDFSHeader::getByteSize(CommentLength, SignatureLength);
     header.entrySize = 80;
     memoryManager.alloc(0, header.rootOffset); //Mark header region as used.
+    indexCommitted = false; //Nothing on disk to protect yet.
+    checksums = false;
+    checksumTable.clear();
+    checksumTableStale = false;
+    layoutChanged = true;
     modified = true;
     return result;
 }
 
 bool VDFSArchive::close()
 {
-    return finalize();
+    bool success = finalize();
+    if(success && checksums && checksumTableStale) //Written once per session. See commitHeader.
+    {
+        success = checksumTable.save(VdfsChecksums::getTablePath(basePath));
+    }
+    checksumTableStale = false;
+    payloadCache.clear();
+    file.close();
+    mappedFile.close();
+    nativeFile.close();
+    return success;
 }
 
 bool VDFSArchive::finalize()
 {
     bool success = true;
+    prefetcher.cancel(); //Pending reads must not see the archive change.
     if(file.isOpen())
     {
         if(modified)
         {
-            success = writeHeader(header);
-            if(!success) LogError() << "Can't write the VDFS header!";
-            if(success) success = writeVDFSIndex();
+            success = writeVDFSIndex();
             if(!success)
                 LogError() << "Can't write the VDFS index!";
             else
                 modified = false; //Index updated. No modifications left.
         }
-        file.close();
     }
     else if(modified)
     {
@@ -374,157 +529,661 @@ bool VDFSArchive::finalize()
 
 bool VDFSArchive::readVDFSIndex()
 {
-    file.setPosition(header.rootOffset);
-    vdfsIndex.currentStoredSize = 0; //Reset length. Gets updated in recursive createIndexTree calls.
-    size_t entriesRead = readIndexTree(vdfsIndex.indexTree);
-    memoryManager.alloc(header.rootOffset, file.getPosition() - header.rootOffset); //Mark index area as used.
-    return entriesRead == header.entryCount;
+    const size_t entryByteSize = VdfsEntry::getByteSize(EntryNameLength);
+    const size_t indexByteSize = entryByteSize * header.entryCount;
+    if (static_cast<size_t>(header.entrySize) != entryByteSize)
+    {
+        LogWarn() << "Unexpected entry size " << header.entrySize << " in header. Using " << entryByteSize << ".";
+    }
+
+    std::vector<char> indexBuffer;
+    const char* indexData = nullptr;
+    if (mappedFile.isOpen()) //Parse directly from the mapping.
+    {
+        if (mappedFile.getSize() < header.rootOffset + indexByteSize)
+        {
+            LogError() << "Index exceeds the archive size!";
+            return false;
+        }
+        indexData = mappedFile.getData() + header.rootOffset;
+    }
+    else //Read the whole index with one request.
+    {
+        indexBuffer.resize(indexByteSize);
+        if (!nativeFile.readAt(header.rootOffset, indexBuffer.data(), indexByteSize))
+        {
+            LogError() << "Can't read the index!";
+            return false;
+        }
+        indexData = indexBuffer.data();
+    }
+
+    vdfsIndex.currentStoredSize = indexByteSize;
+    vdfsIndex.pathLookup.clear();
+    vdfsIndex.nameLookup.clear();
+    vdfsIndex.offsetLookup.clear();
+    dirtyStages.clear();
+    stagePositions.clear();
+    layoutChanged = false;
+    vdfsIndex.pathLookup.reserve(header.fileCount);
+    vdfsIndex.nameLookup.reserve(header.fileCount);
+    size_t entriesRead = 0;
+    bool result = true;
+    if (0 < header.entryCount) //An empty archive has no root stage.
+        result = readIndexTree(vdfsIndex.indexTree, "", indexData, 0, entriesRead);
+    memoryManager.alloc(header.rootOffset, indexByteSize); //Mark index area as used.
+
+    for (auto& lookup : vdfsIndex.pathLookup) //The content size of compressed entries is stored in the payload.
+    {
+        VdfsEntry* entry = lookup.second;
+        uint32_t payloadHeader[4];
+        if (!(entry->vdfs_attribute & EntryAttribute::COMPRESSED)) continue;
+        entry->compressed = readCompressedHeader(entry, payloadHeader);
+        if (entry->compressed)
+            entry->size = payloadHeader[1];
+        else //E.g. packed from NTFS compressed files. The flag is a plain file attribute then.
+            LogDebug() << "Entry " << entry->path << " is flagged compressed, but stored raw.";
+    }
+    return result && entriesRead == header.entryCount;
 }
 
 bool VDFSArchive::writeVDFSIndex()
 {
+    if(incrementalFlush && indexCommitted && !layoutChanged) //Patch the changed stages only, if their position is known.
+    {
+        bool patchable = true;
+        for(const auto* stage : dirtyStages)
+        {
+            patchable &= 0 < stagePositions.count(stage);
+        }
+        if(patchable) return flushDirtyStages();
+    }
+
+    const size_t entriesBefore = vdfsIndex.indexTree.countChildsAndElements();
     vdfsIndex.indexTree.removeEmptyChilds(); //Cleanup of empty directories - Unsupported by vdfs!
+    if(vdfsIndex.indexTree.countChildsAndElements() != entriesBefore) //Pruned stages shifted the entries.
+    {
+        layoutChanged = true;
+        dirtyStages.clear(); //May reference pruned stages.
+    }
+    //The header has to describe the index written below:
+    header.entryCount = static_cast<uint32_t>(vdfsIndex.indexTree.countChildsAndElements());
+    header.fileCount = static_cast<uint32_t>(vdfsIndex.indexTree.countElements());
+
+    const size_t entryByteSize = VdfsEntry::getByteSize(EntryNameLength);
+    const size_t requiredBytes = vdfsIndex.indexTree.countChildsAndElements() * entryByteSize;
+    const MemoryBlock committedIndex(header.rootOffset, vdfsIndex.currentStoredSize);
+    if(indexCommitted) //Keep the committed index intact, until the header references the new one.
+    {
+        MemoryBlock newIndex(VDFSHeader::getByteSize(CommentLength, SignatureLength), 0);
+        if(0 < requiredBytes && !memoryManager.alloc(requiredBytes, newIndex)) return false;
+        header.rootOffset = static_cast<uint32_t>(newIndex.offset);
+    }
+    else if(!allocIndexMemory()) //Nothing references the region on disk. Resize it in place.
+    {
+        return false;
+    }
 
-    if(!allocIndexMemory()) return false;
-    if(!file.setPosition(header.rootOffset)) return false;
+    //Serialize the whole index into one buffer, that gets written with a single request.
+    std::vector<char> indexBuffer(requiredBytes);
+    size_t position = 0;
     directoryOffsetCount = 0;
-    bool writeResult = writeIndexTree(vdfsIndex.indexTree);
+    stagePositions.clear();
+    writeIndexTree(vdfsIndex.indexTree, indexBuffer.data(), position);
+
+    bool success = file.setPosition(header.rootOffset);
+    if(success && !indexBuffer.empty()) success = file.writeBytes(indexBuffer);
+    if(success) success = commitHeader();
+    if(!success)
+    {
+        if(indexCommitted) //The committed index is still valid. Drop the new one.
+        {
+            memoryManager.free(header.rootOffset, requiredBytes);
+            header.rootOffset = static_cast<uint32_t>(committedIndex.offset);
+        }
+        stagePositions.clear(); //Positions of the new index. The next commit has to write all stages.
+        return false;
+    }
+
+    if(indexCommitted) //The old index isn't referenced anymore.
+    {
+        memoryManager.free(committedIndex.offset, committedIndex.size);
+    }
+    vdfsIndex.currentStoredSize = requiredBytes;
+    indexCommitted = true;
+    layoutChanged = false;
+    dirtyStages.clear();
+    freeReleasedBlocks();
+    return true;
+}
+
+bool VDFSArchive::flushDirtyStages()
+{
+    //Patched entries may reference new payloads. These have to be on the device first:
+    if(!file.flush() || !nativeFile.sync()) return false;
+
+    const size_t entryByteSize = VdfsEntry::getByteSize(EntryNameLength);
+    std::vector<char> stageBuffer;
+    for(Tree<String, VdfsEntry>* stage : dirtyStages)
+    {
+        //File entries follow the directory entries of a stage. The last one ends the stage:
+        const size_t firstEntry = stagePositions[stage] + stage->countLocalSubtrees();
+        const size_t entryCount = stage->countLocalElements();
+        stageBuffer.resize(entryCount * entryByteSize);
+        size_t i = 0;
+        for(auto& element : stage->elements)
+        {
+            uint32_t entryType = EntryType::BLANK;
+            if(i + 1 == entryCount) entryType |= EntryType::LAST;
+            writeIndexEntry(stageBuffer.data() + i * entryByteSize, element.first, element.second.vdfs_offset,
+                            element.second.vdfs_size, entryType, element.second.vdfs_attribute);
+            i++;
+        }
+        if(!file.setPosition(header.rootOffset + firstEntry * entryByteSize)) return false;
+        if(!stageBuffer.empty() && !file.writeBytes(stageBuffer)) return false;
+    }
+    if(!commitHeader()) return false;
+    dirtyStages.clear();
+    freeReleasedBlocks();
+    return true;
+}
 
-    return writeResult;
+void VDFSArchive::markStageDirty(const VdfsEntry* entry)
+{
+    auto* stage = getIndexStage(entry->getPath().getDirectory(), false);
+    if(stage) dirtyStages.insert(stage);
+}
+
+bool VDFSArchive::commitHeader()
+{
+    //The side table is saved on close. Marked stale before the first commit, it never marks a valid payload corrupt:
+    const Path tablePath = VdfsChecksums::getTablePath(basePath);
+    if(!checksums && File(tablePath).exists() && !File(tablePath).remove())
+    {
+        LogError() << "Can't remove the checksum table " << tablePath << "!";
+        return false;
+    }
+    if(checksums && !checksumTableStale && File(tablePath).exists() &&
+       !VdfsChecksums::markStale(tablePath) && !File(tablePath).remove())
+    {
+        LogError() << "Can't invalidate the checksum table " << tablePath << "!";
+        return false;
+    }
+    checksumTableStale = checksums;
+
+    //Payloads and the index have to be on the device, before the header references them:
+    if(!file.flush() || !nativeFile.sync()) return false;
+    if(!writeHeader(header))
+    {
+        LogError() << "Can't write the VDFS header!";
+        return false;
+    }
+    return file.flush() && nativeFile.sync();
+}
+
+void VDFSArchive::freeReleasedBlocks()
+{
+    for(const MemoryBlock& block : releasedBlocks)
+    {
+        memoryManager.free(block.offset, block.size);
+    }
+    releasedBlocks.clear();
+}
+
+bool VDFSArchive::allocIndexMemory()
+{
+    const size_t requiredBytes = header.entrySize * vdfsIndex.indexTree.countChildsAndElements();
+    const size_t reservedBytes = vdfsIndex.currentStoredSize;
+    if(requiredBytes <= reservedBytes) //Index fits into the current region.
+    {
+        memoryManager.free(header.rootOffset + requiredBytes, reservedBytes - requiredBytes); //Release unused tail.
+        vdfsIndex.currentStoredSize = requiredBytes;
+        return true;
+    }
+
+    const size_t areaStart = header.rootOffset + reservedBytes;
+    const size_t areaEnd = header.rootOffset + requiredBytes;
+
+    //Claim free memory of the required area first, so relocated payloads can't be placed inside of it:
+    MemoryBlock freeBlock;
+    size_t cursor = areaStart;
+    while(memoryManager.getNextFreeBlock(cursor, freeBlock) && freeBlock.offset < areaEnd)
+    {
+        const size_t blockEnd = freeBlock.offset + freeBlock.size;
+        cursor = (blockEnd < areaEnd) ? blockEnd : areaEnd;
+        memoryManager.alloc(freeBlock.offset, cursor - freeBlock.offset);
+    }
+    const size_t handledBytes = memoryManager.getHandledMemorySize();
+    if(handledBytes < areaEnd) //Area reaches behind the managed memory.
+    {
+        memoryManager.alloc(handledBytes, areaEnd - handledBytes);
+    }
+
+    //Relocate payloads stored inside the area. Their old location becomes part of the index region.
+    //Moved payloads leave the area, so the next one inside is always the first behind its start:
+    const auto& entries = vdfsIndex.offsetLookup;
+    for(auto it = entries.lower_bound(areaStart); it != entries.end() && it->first < areaEnd; it = entries.lower_bound(areaStart))
+    {
+        const size_t offset = it->first;
+        const size_t size = it->second->vdfs_size;
+        const size_t payloadEnd = offset + size;
+        MemoryBlock storage;
+        if(!memoryManager.alloc(size, storage)) return false;
+        if(!movePayload(offset, storage.offset)) return false;
+        if(payloadEnd > areaEnd) //Payload reached behind the area. The rest is free now.
+        {
+            memoryManager.free(areaEnd, payloadEnd - areaEnd);
+        }
+    }
+    vdfsIndex.currentStoredSize = requiredBytes;
+    return true;
+}
+
+void VDFSArchive::trackPayload(VdfsEntry* entry)
+{
+    if(0 < entry->vdfs_size) //Empty files don't occupy any memory.
+        vdfsIndex.offsetLookup.emplace(entry->vdfs_offset, entry);
+}
+
+void VDFSArchive::untrackPayload(const VdfsEntry* entry)
+{
+    auto sharers = vdfsIndex.offsetLookup.equal_range(entry->vdfs_offset);
+    for(auto it = sharers.first; it != sharers.second; it++)
+    {
+        if(it->second == entry)
+        {
+            vdfsIndex.offsetLookup.erase(it);
+            break;
+        }
+    }
+}
+
+bool VDFSArchive::movePayload(const size_t oldOffset, const size_t newOffset)
+{
+    auto sharers = vdfsIndex.offsetLookup.equal_range(oldOffset);
+    if(sharers.first == sharers.second || oldOffset == newOffset)
+    {
+        return true; //Nothing to move.
+    }
+    const size_t size = sharers.first->second->vdfs_size;
+
+    if(!file.flush()) return false; //Pending stream writes have to reach the file first.
+    if(!NativeFile::copyRange(nativeFile, oldOffset, nativeFile, newOffset, size))
+    {
+        LogError() << "Can't move data of entry " << sharers.first->second->vdfs_name << "!";
+        return false;
+    }
+    std::vector<VdfsEntry*> moved;
+    for(auto it = sharers.first; it != sharers.second; it++)
+    {
+        it->second->vdfs_offset = static_cast<uint32_t>(newOffset);
+        markStageDirty(it->second);
+        moved.push_back(it->second);
+    }
+    vdfsIndex.offsetLookup.erase(sharers.first, sharers.second); //Reinsert under the new key.
+    for(VdfsEntry* entry : moved)
+    {
+        vdfsIndex.offsetLookup.emplace(newOffset, entry);
+    }
+    memoryManager.moveReferences(oldOffset, newOffset);
+    checksumTable.move(oldOffset, newOffset);
+
+    auto hash = payloadHashes.find(oldOffset); //Keep deduplication infos up to date.
+    if(hash != payloadHashes.end())
+    {
+        auto candidates = payloadLookup.equal_range(hash->second);
+        for(auto it = candidates.first; it != candidates.second; it++)
+        {
+            if(it->second.offset == oldOffset) it->second.offset = newOffset;
+        }
+        payloadHashes.emplace(newOffset, hash->second);
+        payloadHashes.erase(oldOffset);
+    }
+    modified = true; //Update index on disk, if archive gets closed.
+    return true;
+}
+
+void VDFSArchive::releasePayload(const VdfsEntry* entry)
+{
+    if(0 == entry->vdfs_size) return; //Nothing stored.
+    untrackPayload(entry);
+    const size_t offset = entry->vdfs_offset;
+    const bool lastReference = !memoryManager.isShared(offset);
+    if(lastReference && indexCommitted)
+        releasedBlocks.emplace_back(offset, entry->vdfs_size); //Referenced by the index on disk until the next commit.
+    else
+        memoryManager.free(offset, entry->vdfs_size);
+    if(!lastReference) return; //Other entries keep the payload.
+
+    header.contentSize -= entry->vdfs_size;
+    checksumTable.erase(offset);
+    auto hash = payloadHashes.find(offset);
+    if(hash != payloadHashes.end())
+    {
+        auto candidates = payloadLookup.equal_range(hash->second);
+        for(auto it = candidates.first; it != candidates.second; it++)
+        {
+            if(it->second.offset == offset)
+            {
+                payloadLookup.erase(it);
+                break;
+            }
+        }
+        payloadHashes.erase(hash);
+    }
+}
+
+size_t VDFSArchive::hashPayload(const char* data, const size_t length)
+{
+    return std::hash<std::string_view>()(std::string_view(data, length));
+}
+
+bool VDFSArchive::findStoredPayload(const size_t hash, const char* data, const size_t length, MemoryBlock& block) const
+{
+    std::vector<char> stored;
+    auto candidates = payloadLookup.equal_range(hash);
+    for(auto it = candidates.first; it != candidates.second; it++)
+    {
+        if(it->second.size != length) continue;
+        stored.resize(length);
+        if(nativeFile.readAt(it->second.offset, stored.data(), length) && 0 == std::memcmp(stored.data(), data, length))
+        {
+            block = it->second;
+            return true; //Identical payload found.
+        }
+    }
+    return false;
+}
+
+bool VDFSArchive::setDeduplication(const bool enabled)
+{
+    payloadLookup.clear();
+    payloadHashes.clear();
+    deduplication = false;
+    if(!enabled) return true;
+    if(!checkWriteAccess()) return false;
+
+    //Index the payloads stored already:
+    const auto& entries = vdfsIndex.offsetLookup;
+    std::vector<char> payload;
+    for(auto it = entries.begin(); it != entries.end(); it = entries.upper_bound(it->first))
+    {
+        const size_t size = it->second->vdfs_size;
+        payload.resize(size);
+        if(!nativeFile.readAt(it->first, payload.data(), size))
+        {
+            LogError() << "Can't read payload of entry " << it->second->vdfs_name << "!";
+            payloadLookup.clear();
+            payloadHashes.clear();
+            return false;
+        }
+        const size_t hash = hashPayload(payload.data(), size);
+        payloadLookup.emplace(hash, MemoryBlock(it->first, size));
+        payloadHashes.emplace(it->first, hash);
+    }
+    deduplication = true;
+    return true;
+}
+
+bool VDFSArchive::setChecksums(const bool enabled)
+{
+    if(!checkWriteAccess()) return false;
+    if(enabled && !checksums) //Calculate the checksums of payloads stored without one.
+    {
+        std::vector<MemoryBlock> payloads;
+        const auto& entries = vdfsIndex.offsetLookup;
+        for(auto it = entries.begin(); it != entries.end(); it = entries.upper_bound(it->first))
+        {
+            uint32_t known = 0;
+            if(!checksumTable.get(it->first, it->second->vdfs_size, known))
+                payloads.emplace_back(it->first, it->second->vdfs_size);
+        }
+        std::mutex tableMutex;
+        bool readable = true;
+        checksumPayloads(payloads, [&](const size_t i, const bool read, const uint32_t checksum)
+        {
+            std::lock_guard<std::mutex> lock(tableMutex);
+            readable &= read;
+            if(read) checksumTable.set(payloads[i].offset, payloads[i].size, checksum);
+        });
+        if(!readable)
+        {
+            LogError() << "Can't read all payloads to calculate their checksums!";
+            checksumTable.clear();
+            return false;
+        }
+    }
+    else if(!enabled)
+    {
+        checksumTable.clear();
+    }
+    checksums = enabled;
+    modified = true; //Write or remove the side table on commit.
+    return true;
 }
 
-bool VDFSArchive::allocIndexMemory()
+bool VDFSArchive::verify(const VerifyCallback& callback)
 {
-    size_t entriesToBeWritten = vdfsIndex.indexTree.countChildsAndElements();
-    size_t newIndexByteSize = header.entrySize * entriesToBeWritten;
-    size_t availableIndexMemory = 0;
+    //One job per payload with a checksum. Entries sharing a payload get the same result.
+    using Sharers = std::multimap<size_t, VdfsEntry*>::const_iterator;
+    const auto& entries = vdfsIndex.offsetLookup;
+    std::vector<MemoryBlock> payloads;
+    std::vector<uint32_t> expected;
+    std::vector<Sharers> sharers;
+    std::mutex resultMutex;
+    bool valid = true;
+
+    auto report = [&](const Sharers first, const VerifyResult result)
+    {
+        if(VerifyResult::CORRUPT == result || VerifyResult::UNREADABLE == result)
+        {
+            valid = false;
+            LogWarn() << "Payload of entry " << first->second->path << " is "
+                      << (VerifyResult::CORRUPT == result ? "corrupt!" : "unreadable!");
+        }
+        if(!callback) return;
+        for(auto it = first; it != entries.end() && it->first == first->first; it++)
+        {
+            callback(it->second, result);
+        }
+    };
 
-    do
+    for(auto it = entries.begin(); it != entries.end(); it = entries.upper_bound(it->first))
     {
-        VdfsEntry* firstEntry = nullptr;
-        if(!getFirstStoredEntry(firstEntry))
+        uint32_t checksum = 0;
+        if(checksumTable.get(it->first, it->second->vdfs_size, checksum))
         {
-            return true; //No elements found, that may collide with the header (Blank archive).
+            payloads.emplace_back(it->first, it->second->vdfs_size);
+            expected.push_back(checksum);
+            sharers.push_back(it);
         }
-        availableIndexMemory = firstEntry->vdfs_offset - header.rootOffset;
-        if(availableIndexMemory < newIndexByteSize) //Not enaugh place ?
+        else
         {
-            if(!moveEntryDataToTheEnd(firstEntry)) return false; //Move first file to the end.
+            report(it, VerifyResult::UNCHECKED); //Nothing to read.
         }
-    } while(availableIndexMemory < newIndexByteSize); //A file has been moved, recheck or not, then done.
+    }
 
-    return true;
+    checksumPayloads(payloads, [&](const size_t i, const bool readable, const uint32_t checksum)
+    {
+        VerifyResult result = VerifyResult::UNREADABLE;
+        if(readable) result = (checksum == expected[i]) ? VerifyResult::VALID : VerifyResult::CORRUPT;
+        std::lock_guard<std::mutex> lock(resultMutex);
+        report(sharers[i], result);
+    });
+    return valid;
 }
 
-bool VDFSArchive::moveEntryDataToTheEnd(VdfsEntry*& entry)
+void VDFSArchive::checksumPayloads(const std::vector<MemoryBlock>& payloads,
+                                   const std::function<void(size_t, bool, uint32_t)>& onResult) const
 {
-    bool success = true;
-    char* tmpData = new char[entry->vdfs_size];
-    if(tmpData == nullptr)
+    auto work = [&](const size_t first, const size_t last)
     {
-        LogError() << "Out of memory!";
-        return false;
+        CRC32ISCSI crc;
+        std::vector<char> buffer;
+        for(size_t i = first; i < last; i++) //Front to back through the range.
+        {
+            const MemoryBlock& payload = payloads[i];
+            bool readable = true;
+            crc.begin();
+            if(mappedFile.isOpen())
+            {
+                readable = payload.offset + payload.size <= mappedFile.getSize();
+                if(readable) crc.update(reinterpret_cast<const uint8_t*>(mappedFile.getData() + payload.offset), payload.size);
+            }
+            else
+            {
+                buffer.resize(std::min(payload.size, ChecksumChunkSize));
+                for(size_t done = 0; readable && done < payload.size; done += buffer.size())
+                {
+                    const size_t chunk = std::min(payload.size - done, buffer.size());
+                    readable = nativeFile.readAt(payload.offset + done, buffer.data(), chunk);
+                    crc.update(reinterpret_cast<const uint8_t*>(buffer.data()), chunk);
+                }
+            }
+            onResult(i, readable, crc.finish());
+        }
+    };
+
+    //Split into contiguous ranges of similar size, one per worker:
+    size_t totalBytes = 0;
+    for(const MemoryBlock& payload : payloads) totalBytes += payload.size;
+    const size_t workerCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+    std::vector<std::thread> workers;
+    size_t first = 0;
+    size_t accumulated = 0;
+    for(size_t i = 0; i < payloads.size(); i++)
+    {
+        accumulated += payloads[i].size;
+        if(accumulated * workerCount >= totalBytes * (workers.size() + 1) || i + 1 == payloads.size())
+        {
+            workers.emplace_back(work, first, i + 1);
+            first = i + 1;
+        }
     }
-    success = file.setPosition(entry->vdfs_offset);
-    if(success) success = file.readBytes(tmpData, entry->vdfs_size);
-    if(success) success = file.setPosition(file.getSize());
-    size_t newOffset = file.getPosition();
-    if(success) success = file.writeBytes(tmpData, entry->vdfs_size);
-    if(success)
+    for(std::thread& worker : workers)
     {
-        entry->vdfs_offset = static_cast<uint32_t>(newOffset);
+        worker.join();
     }
-    delete[] tmpData;
-    return success;
 }
 
-bool VDFSArchive::getFirstStoredEntry(VdfsEntry*& entry)
+bool VDFSArchive::readIndexTree(Tree<String, VdfsEntry>& tree, const String& directory,
+                                const char* indexData, const size_t stageStart, size_t& entriesRead)
 {
-    entry = nullptr;
-    for(auto& treeElement : vdfsIndex.indexTree) //Search for the very first entry in the data storage.
+    const size_t entryByteSize = VdfsEntry::getByteSize(EntryNameLength);
+    std::vector<std::pair<String, size_t>> subStages; //Name and first entry of local directories.
+    bool canonical = true;  //Directories first, then files. Each sorted like the tree - As written by writeIndexTree.
+    bool filesStarted = false;
+    String previousName;
+
+    for (size_t i = stageStart; i < header.entryCount; i++)
     {
-        if(entry && treeElement.second.vdfs_offset < entry->vdfs_offset)
+        if (++entriesRead > header.entryCount) //More entries referenced than stored ?
         {
-            entry = &treeElement.second;
+            LogError() << "VDFS Index corrupt! Stages are overlapping.";
+            return false;
         }
-        else if(entry == nullptr)
-            entry = &treeElement.second;
-    }
-    return entry != nullptr;
-}
 
-size_t VDFSArchive::readIndexTree(Tree<String, VdfsEntry>& tree)
-{
-    for (size_t i = 1; i <= header.entryCount; i++) //We count the processed entries with i, so
-                                                    //it's important to start counting from 1.
-    {
+        const char* raw = indexData + i * entryByteSize;
         VdfsEntry entry;
-        bool interpretResult = true;
-
-        size_t beforeEntryRead = file.getPosition();
-        if (interpretResult) interpretResult = file.readString(entry.vdfs_name, EntryNameLength);
-        if (interpretResult) interpretResult = file.read(entry.vdfs_offset);
-        if (interpretResult) interpretResult = file.read(entry.vdfs_size);
-        if (interpretResult) interpretResult = file.read(entry.vdfs_type);
-        if (interpretResult) interpretResult = file.read(entry.vdfs_attribute);
 
-        if(interpretResult) //If all entry data has been successfully read from file
+        //Name is filled up with whitespaces (Fill char in the archive) - Take it without them.
+        size_t nameEnd = 0;
+        while (nameEnd < EntryNameLength && raw[nameEnd] != 0) nameEnd++;
+        size_t nameStart = 0;
+        while (nameStart < nameEnd && std::isspace(static_cast<unsigned char>(raw[nameStart]))) nameStart++;
+        while (nameEnd > nameStart && std::isspace(static_cast<unsigned char>(raw[nameEnd - 1]))) nameEnd--;
+        entry.vdfs_name.assign(raw + nameStart, nameEnd - nameStart);
+
+        raw += EntryNameLength;
+        std::memcpy(&entry.vdfs_offset, raw, sizeof(entry.vdfs_offset));
+        raw += sizeof(entry.vdfs_offset);
+        std::memcpy(&entry.vdfs_size, raw, sizeof(entry.vdfs_size));
+        raw += sizeof(entry.vdfs_size);
+        std::memcpy(&entry.vdfs_type, raw, sizeof(entry.vdfs_type));
+        raw += sizeof(entry.vdfs_type);
+        std::memcpy(&entry.vdfs_attribute, raw, sizeof(entry.vdfs_attribute));
+
+        const bool isDirectory = 0 != (entry.vdfs_type & EntryType::DIRECTORY);
+        if (!isDirectory && !filesStarted) //Names of files get compared among themselves.
+        {
+            filesStarted = true;
+            previousName.clear();
+        }
+        if ((isDirectory && filesStarted) || (!previousName.empty() && !(previousName < entry.vdfs_name)))
         {
-            vdfsIndex.currentStoredSize += file.getPosition() - beforeEntryRead;
-            entry.vdfs_name = entry.vdfs_name.trim(); //Remove whitespaces (Fill char in the archive)
+            canonical = false;
+        }
+        previousName = entry.vdfs_name;
 
-            if (entry.vdfs_type & EntryType::DIRECTORY) //Ordering in VDFS -> first enumerate existing directories
+        if (isDirectory) //Ordering in VDFS -> first enumerate existing directories
+        {
+            if (entry.vdfs_offset <= i) //Directory contents are always stored behind the directory entry.
             {
-                //Recursivly add next directory stage.
-                tree.addSubtree(entry.vdfs_name);
+                LogError() << "VDFS Index corrupt! Directory: " << entry.vdfs_name << " points backwards.";
+                return false;
             }
-            else //Ordering in VDFS -> secondly list files in this directory stage.
+            tree.addSubtree(entry.vdfs_name);
+            subStages.emplace_back(entry.vdfs_name, entry.vdfs_offset);
+        }
+        else //Ordering in VDFS -> secondly list files in this directory stage.
+        {
+            entry.path = String(directory + entry.vdfs_name);
+            entry.size = entry.vdfs_size;
+            VdfsEntry* added = nullptr;
+            if(tree.addElement(entry.vdfs_name, entry))
             {
-                entry.path = entry.vdfs_name;
-                entry.size = entry.vdfs_size;
-                tree.addElement(entry.path, entry);
-                if(!memoryManager.alloc(entry.vdfs_offset, entry.vdfs_size)) //Mark storage as used.
-                {
-                    LogWarn() << "VDFS Index corrupt! File: " << entry.vdfs_name << " offset: " << entry.vdfs_offset << " already used!";
-                }
+                added = &tree.getElement(entry.vdfs_name);
+                addToLookup(added);
+                trackPayload(added);
             }
-
-            if (entry.vdfs_type & EntryType::LAST) //Ordering in VDFS -> third, after local dirs and files join the directory contents.
+            if(!memoryManager.alloc(entry.vdfs_offset, entry.vdfs_size)) //Mark storage as used.
             {
-                for( auto& subtree : tree.getSubtrees())
+                bool shared = false; //Only an identical range of another entry is a shared payload.
+                auto sharers = vdfsIndex.offsetLookup.equal_range(entry.vdfs_offset);
+                for(auto it = sharers.first; it != sharers.second && !shared; it++)
                 {
-                    i += readIndexTree(subtree.second); //Add subentry processed
+                    shared = it->second != added && it->second->vdfs_size == entry.vdfs_size;
+                }
+                if(!shared || !memoryManager.addReference(MemoryBlock(entry.vdfs_offset, entry.vdfs_size)))
+                {
+                    LogWarn() << "VDFS Index corrupt! File: " << entry.vdfs_name << " offset: " << entry.vdfs_offset << " already used!";
                 }
-                return i;
             }
         }
-        else // Read failed
+
+        if (entry.vdfs_type & EntryType::LAST) //Ordering in VDFS -> third, after local dirs and files join the directory contents.
         {
-            return i - 1; //Return processed entries (-1 because the current had failed and wasn't interpreted).
+            if (canonical) stagePositions[&tree] = stageStart; //Stage can be patched by incremental flushes.
+            for (const auto& subStage : subStages)
+            {
+                if (!readIndexTree(tree.getSubtree(subStage.first), directory + subStage.first + "/",
+                                   indexData, subStage.second, entriesRead))
+                    return false;
+            }
+            return true;
         }
     }
-    return header.entryCount; //Never reached in general, cause all stages are terminated with LAST entries.
+    LogError() << "VDFS Index corrupt! Stage without last entry.";
+    return false;
 }
 
-bool VDFSArchive::writeIndexTree(Tree<String, VdfsEntry>& tree)
+void VDFSArchive::writeIndexTree(Tree<String, VdfsEntry>& tree, char* indexData, size_t& position)
 {
-    bool writeSuccess = true;
+    const size_t entryByteSize = VdfsEntry::getByteSize(EntryNameLength);
 
     size_t i = 1; //Written entries in this stage.
     const size_t entriesOfStage = tree.countLocalElements() + tree.countLocalSubtrees();
     directoryOffsetCount += entriesOfStage;  //Add entries of this stage to global counter.
 
+    stagePositions[&tree] = position / entryByteSize;
     size_t subdirectoryOffsetCount = directoryOffsetCount; //Total entries of this stage
     for(auto& child : tree.childs) //Write directories.
     {
         uint32_t entryType = EntryType::DIRECTORY;
-        if(writeSuccess) writeSuccess = file.writeString(child.first.fill(" ", EntryNameLength));
-        if(writeSuccess) writeSuccess = file.write((uint32_t) subdirectoryOffsetCount);
-        if(writeSuccess) writeSuccess = file.write((uint32_t) 0); //Size
         if(i++ == entriesOfStage) //Last element of this stage ?
             entryType |= EntryType::LAST;
-        if(writeSuccess) writeSuccess = file.write((uint32_t) entryType);
-        if(writeSuccess) writeSuccess = file.write((uint32_t) 0); //Attribute
+        writeIndexEntry(indexData + position, child.first, (uint32_t) subdirectoryOffsetCount, 0, entryType, 0);
+        position += entryByteSize;
 
         subdirectoryOffsetCount += child.second.countChildsAndElements();
     }
@@ -536,30 +1195,71 @@ bool VDFSArchive::writeIndexTree(Tree<String, VdfsEntry>& tree)
         {
             entryType |= EntryType::LAST;
         }
-        if(writeSuccess) writeSuccess = file.writeString(element.first.fill(" ", EntryNameLength)); //EntryName
-        if(writeSuccess) writeSuccess = file.write(element.second.vdfs_offset);     //Offset
-        if(writeSuccess) writeSuccess = file.write(element.second.vdfs_size);       //Size
-        if(writeSuccess) writeSuccess = file.write(entryType);                      //EntryType
-        if(writeSuccess) writeSuccess = file.write(element.second.vdfs_attribute);  //Attribute
+        writeIndexEntry(indexData + position, element.first, element.second.vdfs_offset,
+                        element.second.vdfs_size, entryType, element.second.vdfs_attribute);
+        position += entryByteSize;
     }
 
     //Join directories.
     for(auto& child : tree.childs) //Write subdirectory contents.
     {
-        writeIndexTree(child.second);
+        writeIndexTree(child.second, indexData, position);
     }
+}
 
-    return writeSuccess;
+void VDFSArchive::writeIndexEntry(char* target, const String& name, const uint32_t offset,
+                                  const uint32_t size, const uint32_t type, const uint32_t attribute)
+{
+    size_t nameLength = name.length();
+    if(nameLength > EntryNameLength)
+    {
+        LogWarn() << "Entry name too long (" << name << ")! Cutted to max length (" << EntryNameLength << ").";
+        nameLength = EntryNameLength;
+    }
+    std::memcpy(target, name.data(), nameLength);
+    std::memset(target + nameLength, ' ', EntryNameLength - nameLength); //Fill up with whitespaces.
+    target += EntryNameLength;
+    std::memcpy(target, &offset, sizeof(offset));
+    target += sizeof(offset);
+    std::memcpy(target, &size, sizeof(size));
+    target += sizeof(size);
+    std::memcpy(target, &type, sizeof(type));
+    target += sizeof(type);
+    std::memcpy(target, &attribute, sizeof(attribute));
 }
 
 FileEntry* VDFSArchive::getVdfsFile(const Path& filepath, bool createIfNotFound)
 {
-    Path dir = filepath.getDirectory();
-    Path file = filepath.getFilenameWithExt();
+    const String indexPath = normalizePath(filepath);
+    auto found = vdfsIndex.pathLookup.find(indexPath);
+    if (found != vdfsIndex.pathLookup.end())
+    {
+        return found->second;
+    }
+    if (!createIfNotFound || indexPath.empty())
+    {
+        return nullptr;
+    }
+
+    Path normalizedPath = indexPath;
+    String file = normalizedPath.getFilenameWithExt();
+    auto* stage = getIndexStage(normalizedPath.getDirectory(), true);
+
+    header.entryCount++;
+    header.fileCount++;
+    layoutChanged = true; //Entries behind the new one shift inside of the index.
+    VdfsEntry& entry = stage->getElement(file);
+    entry.path = indexPath;
+    entry.vdfs_name = file;
+    addToLookup(&entry);
+    return &entry;
+}
 
+Tree<String, VdfsEntry>* VDFSArchive::getIndexStage(const Path& directory, bool createIfNotFound)
+{
     auto* searchIndex = &vdfsIndex.indexTree;
 
-    for (String stage : dir.split(Path("/")))
+    for (const String& stage : directory.split(Path("/")))
     {
         bool subtreeExists = searchIndex->subtreeExist(stage);
         if ( createIfNotFound || subtreeExists)
@@ -567,6 +1267,7 @@ FileEntry* VDFSArchive::getVdfsFile(const Path& filepath, bool createIfNotFound)
             if(!subtreeExists)
             {
                 header.entryCount++;
+                layoutChanged = true;
             }
             searchIndex = &searchIndex->getSubtree(stage);
         }
@@ -575,34 +1276,31 @@ FileEntry* VDFSArchive::getVdfsFile(const Path& filepath, bool createIfNotFound)
             return nullptr;
         }
     }
-    bool fileExists = searchIndex->elementExist(file);
-    if (createIfNotFound || searchIndex->elementExist(file))
-    {
-        if(!fileExists)
-        {
-            header.entryCount++;
-            header.fileCount++;
-        }
-        return &searchIndex->getElement(file);
-    }
-    return nullptr;
+    return searchIndex;
+}
+
+void VDFSArchive::addToLookup(VdfsEntry* entry)
+{
+    vdfsIndex.pathLookup[entry->path] = entry;
+    vdfsIndex.nameLookup.emplace(entry->vdfs_name, entry);
 }
 
-FileEntry* VDFSArchive::searchVdfsFile(const Path& filename, Tree<String, VdfsEntry>& tree)
+void VDFSArchive::removeFromLookup(VdfsEntry* entry)
 {
-    if(tree.elementExist(filename.getFilenameWithExt()))
+    auto pathIt = vdfsIndex.pathLookup.find(entry->path);
+    if (pathIt != vdfsIndex.pathLookup.end() && pathIt->second == entry)
     {
-        return &tree.getElement(filename.getFilenameWithExt());
+        vdfsIndex.pathLookup.erase(pathIt);
     }
-    else
+    auto range = vdfsIndex.nameLookup.equal_range(entry->vdfs_name);
+    for (auto it = range.first; it != range.second; it++)
     {
-        for(auto & leaf : tree.childs)
+        if (it->second == entry)
         {
-            FileEntry *result = searchVdfsFile(filename, leaf.second);
-            if(result) return result; //Found in subtrees.
+            vdfsIndex.nameLookup.erase(it);
+            break;
         }
     }
-    return nullptr;
 }
 
 FileEntry* VDFSArchive::getFile(const Path& filepath)
@@ -612,11 +1310,17 @@ FileEntry* VDFSArchive::getFile(const Path& filepath)
 
 FileEntry* VDFSArchive::searchFile(const Path& filename)
 {
-    return searchVdfsFile(filename, vdfsIndex.indexTree);
+    auto found = vdfsIndex.nameLookup.find(filename.getFilenameWithExt());
+    if (found != vdfsIndex.nameLookup.end())
+    {
+        return found->second;
+    }
+    return nullptr;
 }
 
 FileEntry* VDFSArchive::createFile(const Path& filepath)
 {
+    if(!checkWriteAccess()) return nullptr;
     return getVdfsFile(filepath, true);
 }
 
@@ -629,14 +1333,78 @@ bool VDFSArchive::readFile(const FileEntry* fileEntry, char* dest)
         return false;
     }
 
-    file.setPosition(vdfsEntry->vdfs_offset); //Set filepointer to fileEntry inside the vdfs.
+    if(!payloadCache.isEnabled() && !prefetcher.getCachedBytes()) //Straight to the destination.
+    {
+        return readEntryData(vdfsEntry, dest);
+    }
+    SharedFileContent content;
+    if(!readFileShared(fileEntry, content)) return false;
+    if(!content->empty()) std::memcpy(dest, content->data(), content->size());
+    return true; //Successfully read the file data.
+}
+
+bool VDFSArchive::readFileShared(const FileEntry* fileEntry, SharedFileContent& content)
+{
+    const VdfsEntry* vdfsEntry = dynamic_cast<const VdfsEntry*>(fileEntry);
+    if(!vdfsEntry)
+    {
+        LogError() << "fileEntry given that wasn't constructed by a vdfsArchive instance!";
+        return false;
+    }
+
+    if(prefetcher.take(fileEntry, content)) //Read ahead already.
+    {
+        payloadCache.insert(fileEntry, content);
+        return true;
+    }
+    if(payloadCache.get(fileEntry, content)) return true;
+
+    auto data = std::make_shared<std::vector<char>>(static_cast<size_t>(vdfsEntry->size));
+    if(!readEntryData(vdfsEntry, data->data())) return false;
+    content = data;
+    payloadCache.insert(fileEntry, content);
+    return true;
+}
+
+bool VDFSArchive::readEntryData(const VdfsEntry* entry, char* dest) const
+{
+    if(entry->compressed)
+    {
+        return decompressRange(entry, 0, entry->size, dest);
+    }
+    if (!readPayload(entry, 0, dest, entry->vdfs_size))
+    {
+        LogError() << "Error while reading from file.";
+        return false;
+    }
+    return true;
+}
+
+bool VDFSArchive::readFileRange(const FileEntry* fileEntry, const size_t offset, const size_t length, char* dest)
+{
+    const VdfsEntry* vdfsEntry = dynamic_cast<const VdfsEntry*>(fileEntry);
+    if(!vdfsEntry)
+    {
+        LogError() << "fileEntry given that wasn't constructed by a vdfsArchive instance!";
+        return false;
+    }
+    const size_t fileSize = vdfsEntry->size;
+    if(offset > fileSize || length > fileSize - offset)
+    {
+        LogError() << "Range exceeds the size of entry " << vdfsEntry->vdfs_name << "!";
+        return false;
+    }
 
-    if (!file.readBytes(dest, vdfsEntry->vdfs_size))
+    if(vdfsEntry->compressed)
+    {
+        return decompressRange(vdfsEntry, offset, length, dest); //Only chunks inside the range get decompressed.
+    }
+    if (!readPayload(vdfsEntry, offset, dest, length))
     {
         LogError() << "Error while reading from file.";
         return false;
     }
-    return true; //Successfully read the file data.
+    return true;
 }
 
 bool VDFSArchive::readFile(const FileEntry* fileEntry, std::vector<char>& dest)
@@ -648,11 +1416,11 @@ bool VDFSArchive::readFile(const FileEntry* fileEntry, std::vector<char>& dest)
         return false;
     }
 
-    file.setPosition(vdfsEntry->vdfs_offset); //Set filepointer to fileEntry inside the vdfs.
-
-    if (!file.readBytes(dest, vdfsEntry->vdfs_size))
+    const size_t vecPos = dest.size();
+    dest.resize(vecPos + static_cast<size_t>(vdfsEntry->size));
+    if (!readFile(fileEntry, dest.data() + vecPos))
     {
-        LogError() << "Error while reading from file.";
+        dest.resize(vecPos); //Drop the partially read data.
         return false;
     }
     return true; //Successfully read the file data.
@@ -661,20 +1429,63 @@ bool VDFSArchive::readFile(const FileEntry* fileEntry, std::vector<char>& dest)
 bool VDFSArchive::writeFile(FileEntry* fileEntry, const char* src, const size_t length)
 {
     VdfsEntry* vdfsEntry;
+    if(!checkWriteAccess()) return false;
+    prefetcher.cancel(); //Pending reads must not see the archive change.
+    payloadCache.invalidate(fileEntry);
     if(!checkFileEntryIsVdfsEntry(fileEntry, vdfsEntry))
     {
         LogError() << "Handle given, that wasn't created by an VDFSArchive instance!";
         return false;
     }
-    vdfsEntry->vdfs_size = static_cast<uint32_t>(length); //Enter size.
-    size_t writeOffset = getFreeMemoryOffset(length);
-    if(!file.setPosition(writeOffset)) return false;
-    if(!file.writeBytes(src, length)) return false;
-    vdfsEntry->vdfs_offset = static_cast<uint32_t>(writeOffset);
-    vdfsEntry->vdfs_attribute = EntryAttribute::ARCHIVE;
-    header.contentSize += static_cast<uint32_t>(length);
+    const char* payload = src;
+    size_t payloadLength = length;
+    EntryAttribute attribute = EntryAttribute::ARCHIVE;
+    std::vector<char> compressed;
+    if(compression && 0 < length)
+    {
+        auto readRaw = [src](size_t offset, char* buffer, size_t count) { std::memcpy(buffer, src + offset, count); return true; };
+        if(!compressPayload(length, readRaw, compressed)) return false;
+        payload = compressed.data();
+        payloadLength = compressed.size();
+        attribute = static_cast<EntryAttribute>(EntryAttribute::ARCHIVE | EntryAttribute::COMPRESSED);
+    }
 
+    releasePayload(vdfsEntry); //Overwritten entry - Release the old payload.
+    vdfsEntry->vdfs_size = 0;
+    vdfsEntry->vdfs_attribute = attribute;
+    vdfsEntry->compressed = 0 != (attribute & EntryAttribute::COMPRESSED);
+    vdfsEntry->size = length;
     modified = true; //Update index on disk, if archive gets closed.
+    markStageDirty(vdfsEntry);
+
+    const size_t hash = deduplication ? hashPayload(payload, payloadLength) : 0;
+    MemoryBlock stored;
+    if(deduplication && 0 < payloadLength && findStoredPayload(hash, payload, payloadLength, stored))
+    {
+        memoryManager.addReference(stored); //Share the identical payload.
+        vdfsEntry->vdfs_offset = static_cast<uint32_t>(stored.offset);
+        vdfsEntry->vdfs_size = static_cast<uint32_t>(payloadLength);
+        trackPayload(vdfsEntry);
+        return true;
+    }
+
+    size_t writeOffset = getFreeMemoryOffset(payloadLength);
+    if(!file.setPosition(writeOffset)) return false;
+    if(!file.writeBytes(payload, payloadLength)) return false;
+    if(!file.flush()) return false; //Make the data visible for positional reads.
+    vdfsEntry->vdfs_offset = static_cast<uint32_t>(writeOffset);
+    vdfsEntry->vdfs_size = static_cast<uint32_t>(payloadLength);
+    trackPayload(vdfsEntry);
+    header.contentSize += static_cast<uint32_t>(payloadLength);
+    if(checksums && 0 < payloadLength)
+    {
+        checksumTable.set(writeOffset, payloadLength, VdfsChecksums::calculate(payload, payloadLength));
+    }
+    if(deduplication && 0 < payloadLength)
+    {
+        payloadLookup.emplace(hash, MemoryBlock(writeOffset, payloadLength));
+        payloadHashes.emplace(writeOffset, hash);
+    }
     return true;
 }
 
@@ -688,20 +1499,27 @@ bool VDFSArchive::removeFile(FileEntry* fileEntry)
     bool removed = false;           //Variable stating if the entry has been removed.
     VdfsEntry* vdfsEntry = nullptr; //The Vdfs object instance, if casted successfully.
 
+    if(!checkWriteAccess()) return false;
+    prefetcher.cancel(); //Pending reads must not see the archive change.
+    payloadCache.invalidate(fileEntry);
     if(false != checkFileEntryIsVdfsEntry(fileEntry, vdfsEntry))
     {
-        const size_t offset = vdfsEntry->vdfs_offset;
-        const size_t sizeOfFile = vdfsEntry->vdfs_size;
-
-        removed = vdfsIndex.indexTree.removeElement(fileEntry->getPath(), vdfsEntry);
+        auto* stage = getIndexStage(vdfsEntry->getPath().getDirectory(), false);
+        const String name = vdfsEntry->vdfs_name;
+        if(stage && stage->elementExist(name) && &stage->getElement(name) == vdfsEntry)
+        {
+            removeFromLookup(vdfsEntry);
+            releasePayload(vdfsEntry);
+            stage->removeElement(name); //Invalidates vdfsEntry.
+            removed = true;
+        }
         if(removed) //File removed -- update index
         {
             //Update header:
             modified = true; //Update index on disk, if archive gets closed.
+            layoutChanged = true;
             header.fileCount--;
-            header.contentSize -= sizeOfFile;
             header.entryCount--;
-            memoryManager.free(offset, sizeOfFile);
         }
         else //Entry wasn't removed.
         {
@@ -716,6 +1534,135 @@ bool VDFSArchive::removeFile(FileEntry* fileEntry)
     return removed;
 }
 
+bool VDFSArchive::compact()
+{
+    bool completed = false;
+    return compact(std::numeric_limits<size_t>::max(), completed) && completed;
+}
+
+bool VDFSArchive::compact(const size_t byteBudget, bool& completed)
+{
+    completed = false;
+    if(!checkWriteAccess()) return false;
+    prefetcher.cancel(); //Pending reads must not see the archive change.
+    if(indexCommitted) //Compact rewrites in place. The index moves behind the header again.
+    {
+        freeReleasedBlocks();
+        memoryManager.free(header.rootOffset, vdfsIndex.currentStoredSize);
+        header.rootOffset = static_cast<uint32_t>(VDFSHeader::getByteSize(CommentLength, SignatureLength));
+        vdfsIndex.currentStoredSize = 0;
+        indexCommitted = false;
+        modified = true; //Update index on disk, if archive gets closed.
+    }
+    if(!allocIndexMemory()) return false; //Size the index region now, so finalize won't relocate packed payloads.
+
+    const auto& entries = vdfsIndex.offsetLookup;
+    size_t movedBytes = 0;
+    size_t cursor = 0;
+    MemoryBlock gap;
+    while(memoryManager.getNextFreeBlock(cursor, gap)) //Close gaps from the front to the back.
+    {
+        const size_t gapEnd = gap.offset + gap.size;
+        auto next = entries.find(gapEnd);
+        if(next == entries.end()) //No payload behind the gap. The trailing free block or foreign memory.
+        {
+            cursor = gapEnd;
+            continue;
+        }
+        if(movedBytes >= byteBudget && 0 < movedBytes)
+        {
+            return true; //Budget exhausted. Continue with the next call.
+        }
+
+        const size_t size = next->second->vdfs_size;
+        if(!movePayload(gapEnd, gap.offset)) return false; //Moves all entries sharing the payload.
+        memoryManager.free(gapEnd, size); //Combines the old location with the gap..
+        memoryManager.alloc(gap.offset, size); //..and the gap moves behind the payload.
+        movedBytes += size;
+        cursor = gap.offset + size;
+    }
+
+    const size_t compactedSize = memoryManager.trimFreeEnd();
+    if(!file.flush() || !nativeFile.truncate(compactedSize)) return false;
+    LogDebug() << "Compacted " << basePath << " to " << MemorySize(compactedSize).toString() << ".";
+    completed = true;
+    return true;
+}
+
+namespace
+{
+    /**
+     * @brief The VdfsFileCursor class walks the index tree depth first.
+     */
+    class VdfsFileCursor : public IFileEntryCursor
+    {
+    public:
+        VdfsFileCursor(Tree<String, VdfsEntry>& root)
+            : position(root.begin())
+        {}
+
+        virtual FileEntry* next() override
+        {
+            if(position == Tree<String, VdfsEntry>::iterator()) return nullptr; //Done.
+            return &(position++)->second;
+        }
+
+        virtual std::unique_ptr<IFileEntryCursor> clone() const override
+        {
+            return std::unique_ptr<IFileEntryCursor>(new VdfsFileCursor(*this));
+        }
+
+    private:
+        Tree<String, VdfsEntry>::iterator position; //!< Next file to visit.
+    }; //class VdfsFileCursor
+}
+
+std::unique_ptr<IFileEntryCursor> VDFSArchive::createFileCursor()
+{
+    return std::unique_ptr<IFileEntryCursor>(new VdfsFileCursor(vdfsIndex.indexTree));
+}
+
+std::vector<std::shared_future<PrefetchedFile>> VDFSArchive::prefetch(const std::vector<const FileEntry*>& fileEntries,
+                                                                     const PrefetchCallback& callback)
+{
+    std::vector<std::pair<size_t, const FileEntry*>> requests;
+    requests.reserve(fileEntries.size());
+    for(const FileEntry* fileEntry : fileEntries)
+    {
+        const VdfsEntry* vdfsEntry = dynamic_cast<const VdfsEntry*>(fileEntry);
+        requests.emplace_back(vdfsEntry ? vdfsEntry->vdfs_offset : 0, fileEntry); //Foreign entries fail on read.
+    }
+    return prefetcher.request(requests, callback);
+}
+
+bool VDFSArchive::getFileView(const FileEntry* fileEntry, const char*& data, size_t& length) const
+{
+    const VdfsEntry* vdfsEntry = dynamic_cast<const VdfsEntry*>(fileEntry);
+    if(!vdfsEntry)
+    {
+        LogError() << "fileEntry given that wasn't constructed by a vdfsArchive instance!";
+        return false;
+    }
+    if(!mappedFile.isOpen())
+    {
+        LogError() << "File views are only available in read only mapped mode!";
+        return false;
+    }
+    if(vdfsEntry->compressed)
+    {
+        LogError() << "Entry " << vdfsEntry->vdfs_name << " is compressed and can't be viewed!";
+        return false;
+    }
+    if(mappedFile.getSize() < static_cast<size_t>(vdfsEntry->vdfs_offset) + vdfsEntry->vdfs_size)
+    {
+        LogError() << "Entry " << vdfsEntry->vdfs_name << " exceeds the archive size!";
+        return false;
+    }
+    data = mappedFile.getData() + vdfsEntry->vdfs_offset;
+    length = vdfsEntry->vdfs_size;
+    return true;
+}
+
 bool VDFSArchive::readHeader(VDFSArchive::VDFSHeader& header)
 {
     bool result = true;
@@ -734,7 +1681,7 @@ bool VDFSArchive::readHeader(VDFSArchive::VDFSHeader& header)
 
     header.comment = header.comment.trim(CommentFillChar);
 
-    memoryManager.alloc(0, header.rootOffset); //Mark memory as used for the header region.
+    memoryManager.alloc(0, VDFSHeader::getByteSize(CommentLength, SignatureLength)); //Mark memory as used for the header region.
 
     return result;
 }
@@ -785,6 +1732,16 @@ bool VDFSArchive::checkFileEntryIsVdfsEntry(FileEntry* check, VdfsEntry*& target
     return success;
 }
 
+bool VDFSArchive::checkWriteAccess() const
+{
+    if(VdfsAccessMode::READ_WRITE != accessMode)
+    {
+        LogError() << "Archive has been opened read only!";
+        return false;
+    }
+    return true;
+}
+
 size_t VDFSArchive::getFreeMemoryOffset(const size_t requiredBytes)
 {
     MemoryBlock storage;
@@ -799,3 +1756,148 @@ size_t VDFSArchive::getFreeMemoryOffset(const size_t requiredBytes)
         return file.getSize(); //Fallback: append to file.
     }
 }
+
+bool VDFSArchive::placeEntry(VdfsEntry* entry, const size_t offset, const size_t size,
+                             const size_t rawSize, const EntryAttribute attribute)
+{
+    if(!memoryManager.alloc(offset, size))
+    {
+        LogError() << "Bug! Memory for entry " << entry->vdfs_name << " at offset " << offset << " is used already!";
+        return false;
+    }
+    entry->vdfs_offset = static_cast<uint32_t>(offset);
+    entry->vdfs_size = static_cast<uint32_t>(size);
+    trackPayload(entry);
+    entry->vdfs_attribute = attribute;
+    entry->compressed = 0 != (attribute & EntryAttribute::COMPRESSED);
+    entry->size = rawSize;
+    header.contentSize += static_cast<uint32_t>(size);
+    modified = true; //Update index on disk, if archive gets closed.
+    return true;
+}
+
+bool VDFSArchive::compressPayload(const size_t rawSize, const std::function<bool(size_t, char*, size_t)>& readRaw,
+                                  std::vector<char>& payload)
+{
+    const size_t chunkCount = (rawSize + CompressionChunkSize - 1) / CompressionChunkSize;
+    const uint32_t payloadHeader[] = { CompressedMagic, static_cast<uint32_t>(rawSize),
+                                       static_cast<uint32_t>(CompressionChunkSize), static_cast<uint32_t>(chunkCount) };
+    std::vector<uint32_t> chunkSizes(chunkCount);
+    std::vector<char> chunk(CompressionChunkSize);
+
+    payload.clear();
+    payload.resize(CompressedHeaderLength + chunkCount * sizeof(uint32_t)); //Header and chunk table get filled in at last.
+    for(size_t i = 0; i < chunkCount; i++)
+    {
+        const size_t chunkOffset = i * CompressionChunkSize;
+        const size_t chunkLength = (rawSize - chunkOffset < CompressionChunkSize) ? rawSize - chunkOffset : CompressionChunkSize;
+        if(!readRaw(chunkOffset, chunk.data(), chunkLength)) return false;
+
+        const size_t chunkStart = payload.size();
+        if(LzCodec::compress(chunk.data(), chunkLength, payload) && payload.size() - chunkStart < chunkLength)
+        {
+            chunkSizes[i] = static_cast<uint32_t>(payload.size() - chunkStart);
+        }
+        else //Incompressible - Store it as it is.
+        {
+            payload.resize(chunkStart);
+            payload.insert(payload.end(), chunk.data(), chunk.data() + chunkLength);
+            chunkSizes[i] = static_cast<uint32_t>(chunkLength) | 0x80000000u;
+        }
+    }
+    std::memcpy(payload.data(), payloadHeader, CompressedHeaderLength);
+    if(0 < chunkCount)
+        std::memcpy(payload.data() + CompressedHeaderLength, chunkSizes.data(), chunkCount * sizeof(uint32_t));
+    return true;
+}
+
+bool VDFSArchive::decompressRange(const VdfsEntry* entry, const size_t offset, const size_t length, char* dest) const
+{
+    uint32_t payloadHeader[4];
+    if(!readCompressedHeader(entry, payloadHeader) || payloadHeader[1] != entry->size)
+    {
+        LogError() << "Compressed entry " << entry->vdfs_name << " has a corrupt payload header!";
+        return false;
+    }
+    const size_t rawSize = payloadHeader[1];
+    const size_t chunkSize = payloadHeader[2];
+    if(offset > rawSize || length > rawSize - offset) return false; //Outside of the entry.
+    if(0 == length) return true; //Nothing to read.
+
+    std::vector<uint32_t> chunkSizes(payloadHeader[3]);
+    size_t position = CompressedHeaderLength + chunkSizes.size() * sizeof(uint32_t);
+    if(!readPayload(entry, CompressedHeaderLength, reinterpret_cast<char*>(chunkSizes.data()), position - CompressedHeaderLength))
+        return false;
+
+    const size_t firstChunk = offset / chunkSize;
+    const size_t lastChunk = (offset + length - 1) / chunkSize;
+    for(size_t i = 0; i < firstChunk; i++) //Skip the chunks in front of the range.
+        position += chunkSizes[i] & 0x7FFFFFFFu;
+
+    std::vector<char> chunk; //Compressed chunks are smaller than the raw chunk size.
+    std::vector<char> raw;   //Decompressed chunks, that are only partially requested.
+    for(size_t i = firstChunk; i <= lastChunk; i++)
+    {
+        const size_t storedSize = chunkSizes[i] & 0x7FFFFFFFu;
+        const size_t chunkStart = i * chunkSize;
+        const size_t rawLength = (rawSize - chunkStart < chunkSize) ? rawSize - chunkStart : chunkSize;
+        const size_t rangeStart = (offset > chunkStart) ? offset : chunkStart;
+        const size_t rangeEnd = (offset + length < chunkStart + rawLength) ? offset + length : chunkStart + rawLength;
+        char* target = dest + (rangeStart - offset);
+        bool success = false;
+        if(chunkSizes[i] & 0x80000000u) //Stored uncompressed - Read the requested part only.
+        {
+            success = storedSize == rawLength && readPayload(entry, position + rangeStart - chunkStart, target, rangeEnd - rangeStart);
+        }
+        else if(storedSize < rawLength)
+        {
+            const bool wholeChunk = rangeStart == chunkStart && rangeEnd == chunkStart + rawLength;
+            raw.resize(wholeChunk ? 0 : rawLength);
+            chunk.resize(storedSize);
+            success = readPayload(entry, position, chunk.data(), storedSize) &&
+                      LzCodec::decompress(chunk.data(), storedSize, wholeChunk ? target : raw.data(), rawLength);
+            if(success && !wholeChunk)
+                std::memcpy(target, raw.data() + rangeStart - chunkStart, rangeEnd - rangeStart);
+        }
+        if(!success)
+        {
+            LogError() << "Compressed entry " << entry->vdfs_name << " is corrupt!";
+            return false;
+        }
+        position += storedSize;
+    }
+    return true;
+}
+
+bool VDFSArchive::readCompressedHeader(const VdfsEntry* entry, uint32_t (&payloadHeader)[4]) const
+{
+    if(!readPayload(entry, 0, reinterpret_cast<char*>(payloadHeader), CompressedHeaderLength) ||
+       payloadHeader[0] != CompressedMagic || 0 == payloadHeader[2])
+    {
+        return false;
+    }
+    const size_t chunkCount = payloadHeader[3];
+    if(chunkCount != (static_cast<size_t>(payloadHeader[1]) + payloadHeader[2] - 1) / payloadHeader[2])
+    {
+        return false;
+    }
+    //The chunk table has to fit into the payload, before anything gets allocated for it:
+    return chunkCount <= (entry->vdfs_size - CompressedHeaderLength) / sizeof(uint32_t);
+}
+
+bool VDFSArchive::readPayload(const VdfsEntry* entry, const size_t offset, char* dest, const size_t count) const
+{
+    if(offset + count > entry->vdfs_size) return false; //Outside of the payload.
+    const size_t position = static_cast<size_t>(entry->vdfs_offset) + offset;
+    if(mappedFile.isOpen())
+    {
+        if(mappedFile.getSize() < position + count)
+        {
+            LogError() << "Entry " << entry->vdfs_name << " exceeds the archive size!";
+            return false;
+        }
+        if(0 < count) std::memcpy(dest, mappedFile.getData() + position, count);
+        return true;
+    }
+    return nativeFile.readAt(position, dest, count);
+}
@@ -0,0 +1,265 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#include "Archives/cVdfsBuilder.h"
+#include <ClippedUtils/cLogger.h>
+#include <ClippedFilesystem/cNativeFile.h>
+#include <cstring>
+#include <thread>
+
+using namespace Clipped;
+
+const size_t VDFSBuilder::WriteBufferSize = 8 * 1024 * 1024;
+const size_t VDFSBuilder::SourcesPerWorker = 4;
+
+VDFSBuilder::VDFSBuilder(const Path& filepath)
+    : archive(filepath)
+    , workerCount(1)
+    , compression(false)
+    , writeBufferOffset(0)
+    , nextToLoad(0)
+    , nextToWrite(0)
+    , aborted(false)
+{
+    setWorkerCount(std::thread::hardware_concurrency());
+}
+
+bool VDFSBuilder::addFile(const Path& archivePath, const Path& sourcePath)
+{
+    Source source;
+    source.archivePath = IArchiver::normalizePath(archivePath);
+    source.sourcePath = sourcePath;
+    return addSource(std::move(source));
+}
+
+bool VDFSBuilder::addBuffer(const Path& archivePath, std::vector<char> data)
+{
+    Source source;
+    source.archivePath = IArchiver::normalizePath(archivePath);
+    source.data = std::move(data);
+    return addSource(std::move(source));
+}
+
+bool VDFSBuilder::addSource(Source&& source)
+{
+    if(source.archivePath.empty())
+    {
+        LogError() << "Can't add a file without a name to the archive!";
+        return false;
+    }
+    auto found = sourceLookup.find(source.archivePath);
+    if(found != sourceLookup.end()) //Added already ? The latest source wins.
+    {
+        LogWarn() << "File " << source.archivePath << " added twice. Using the latest one.";
+        sources[found->second] = std::move(source);
+        return true;
+    }
+    sourceLookup.emplace(source.archivePath, sources.size());
+    sources.push_back(std::move(source));
+    return true;
+}
+
+bool VDFSBuilder::build()
+{
+    if(!archive.create())
+    {
+        LogError() << "Can't create archive: " << archive.getBasePath();
+        return false;
+    }
+
+    //Plan: Create all entries first, so the final index size is known and can be reserved behind the header.
+    std::vector<VdfsEntry*> entries;
+    entries.reserve(sources.size());
+    for(const Source& source : sources)
+    {
+        entries.push_back(dynamic_cast<VdfsEntry*>(archive.getVdfsFile(source.archivePath, true)));
+    }
+    if(!archive.allocIndexMemory()) return false;
+
+    //Stream: Workers load the sources, the writer stores them one after another behind the index.
+    size_t offset = archive.memoryManager.getHandledMemorySize();
+    writeBufferOffset = offset;
+    writeBuffer.clear();
+    writeBuffer.reserve(WriteBufferSize);
+    loaded = std::vector<LoadedSource>(sources.size());
+    nextToLoad = 0;
+    nextToWrite = 0;
+    aborted = false;
+
+    std::vector<std::thread> workers;
+    for(size_t i = 0; i < workerCount; i++)
+    {
+        workers.emplace_back(&VDFSBuilder::loadSources, this);
+    }
+
+    bool success = true;
+    for(size_t i = 0; success && i < sources.size(); i++)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            sourceLoaded.wait(lock, [&]() { return loaded[i].ready; });
+        }
+        success = writeSource(sources[i], loaded[i], entries[i], offset);
+        loaded[i] = LoadedSource(); //Release the loaded content.
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            nextToWrite = i + 1;
+            aborted = !success;
+        }
+        sourceWritten.notify_all();
+    }
+    for(auto& worker : workers)
+    {
+        worker.join();
+    }
+    loaded.clear();
+
+    if(success) success = flushWriteBuffer();
+    writeBuffer = std::vector<char>(); //Release the buffer memory.
+
+    success &= archive.close(); //Writes header and index into the reserved region.
+    return success;
+}
+
+void VDFSBuilder::loadSources()
+{
+    const size_t window = workerCount * SourcesPerWorker;
+    while(true)
+    {
+        size_t i = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            sourceWritten.wait(lock, [&]() { return aborted || nextToLoad >= sources.size() || nextToLoad < nextToWrite + window; });
+            if(aborted || nextToLoad >= sources.size()) return; //Done.
+            i = nextToLoad++;
+        }
+        LoadedSource result;
+        loadSource(sources[i], compression, result); //Loaded without holding the lock.
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            loaded[i] = std::move(result);
+            loaded[i].ready = true;
+        }
+        sourceLoaded.notify_all();
+    }
+}
+
+void VDFSBuilder::loadSource(const Source& source, const bool compress, LoadedSource& result)
+{
+    if(source.sourcePath.empty()) //Content is in memory already.
+    {
+        result.size = source.data.size();
+        result.rawSize = result.size;
+        if(compress && 0 < result.rawSize)
+        {
+            const char* src = source.data.data();
+            auto readRaw = [src](size_t offset, char* buffer, size_t count) { std::memcpy(buffer, src + offset, count); return true; };
+            result.compressed = VDFSArchive::compressPayload(result.rawSize, readRaw, result.data);
+            result.size = result.data.size();
+            result.success = result.compressed;
+            return;
+        }
+        result.success = true;
+        return;
+    }
+
+    NativeFile input(source.sourcePath);
+    if(!input.open(FileAccessMode::READ_ONLY)) return;
+    result.rawSize = input.getSize();
+    result.size = result.rawSize;
+    if(compress && 0 < result.rawSize) //Read and compressed chunk by chunk.
+    {
+        auto readRaw = [&input](size_t offset, char* buffer, size_t count) { return input.readAt(offset, buffer, count); };
+        result.compressed = VDFSArchive::compressPayload(result.rawSize, readRaw, result.data);
+        result.size = result.data.size();
+        result.success = result.compressed;
+        return;
+    }
+    if(result.size > WriteBufferSize) //Too large to be loaded. The writer copies it directly.
+    {
+        result.direct = true;
+        result.success = true;
+        return;
+    }
+    result.data.resize(result.size);
+    result.success = input.readAt(0, result.data.data(), result.size);
+}
+
+bool VDFSBuilder::writeSource(const Source& source, const LoadedSource& result, VdfsEntry* entry, size_t& offset)
+{
+    bool success = result.success;
+    if(success)
+    {
+        if(result.direct)
+        {
+            NativeFile input(source.sourcePath);
+            success = flushWriteBuffer();
+            writeBufferOffset = offset + result.size;
+            if(success) success = input.open(FileAccessMode::READ_ONLY);
+            if(success) success = NativeFile::copyRange(input, 0, archive.nativeFile, offset, result.size);
+        }
+        else if(source.sourcePath.empty() && !result.compressed)
+        {
+            success = writePayload(offset, source.data.data(), result.size);
+        }
+        else
+        {
+            success = writePayload(offset, result.data.data(), result.size);
+        }
+    }
+    if(!success)
+    {
+        LogError() << "Can't add file " << source.archivePath << " to the archive!";
+        return false;
+    }
+    EntryAttribute attribute = EntryAttribute::ARCHIVE;
+    if(result.compressed)
+        attribute = static_cast<EntryAttribute>(EntryAttribute::ARCHIVE | EntryAttribute::COMPRESSED);
+    if(!archive.placeEntry(entry, offset, result.size, result.rawSize, attribute)) return false;
+    offset += result.size;
+    return true;
+}
+
+bool VDFSBuilder::writePayload(const size_t offset, const char* data, const size_t length)
+{
+    if(length + writeBuffer.size() > WriteBufferSize) //Doesn't fit into the buffer ?
+    {
+        if(!flushWriteBuffer()) return false;
+        writeBufferOffset = offset + length;
+        return archive.nativeFile.writeAt(offset, data, length); //Large payloads get written directly.
+    }
+    writeBuffer.insert(writeBuffer.end(), data, data + length);
+    return true;
+}
+
+bool VDFSBuilder::flushWriteBuffer()
+{
+    bool success = archive.nativeFile.writeAt(writeBufferOffset, writeBuffer.data(), writeBuffer.size());
+    writeBufferOffset += writeBuffer.size();
+    writeBuffer.clear();
+    return success;
+}
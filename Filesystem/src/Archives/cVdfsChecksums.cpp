@@ -0,0 +1,173 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#include "Archives/cVdfsChecksums.h"
+#include "cNativeFile.h"
+#include <ClippedMaths/cCRC.h>
+#include <ClippedUtils/cOsDetect.h>
+#include <ClippedUtils/cLogger.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace Clipped;
+
+const uint32_t VdfsChecksums::Magic = 0x43524356u; //"VCRC" little endian.
+const uint32_t VdfsChecksums::Version = 2;
+const uint32_t VdfsChecksums::Valid = 0;
+const uint32_t VdfsChecksums::Stale = 1;
+
+uint32_t VdfsChecksums::calculate(const char* data, const size_t length)
+{
+    thread_local CRC32ISCSI crc; //Reused - Building the lookup tables isn't for free.
+    crc.begin();
+    crc.update(reinterpret_cast<const uint8_t*>(data), length);
+    return crc.finish();
+}
+
+Path VdfsChecksums::getTablePath(const Path& archivePath)
+{
+    return Path(String(archivePath) + ".crc");
+}
+
+bool VdfsChecksums::load(const Path& filepath)
+{
+    records.clear();
+    NativeFile file(filepath);
+    if(!file.open(FileAccessMode::READ_ONLY)) return false;
+
+    const size_t headerLength = 4 * sizeof(uint32_t);
+    const size_t recordLength = 3 * sizeof(uint32_t);
+    std::vector<uint32_t> table(file.getSize() / sizeof(uint32_t));
+    if(file.getSize() < headerLength || !file.readAt(0, reinterpret_cast<char*>(table.data()), table.size() * sizeof(uint32_t)))
+    {
+        LogWarn() << "Checksum table " << filepath << " can't be read!";
+        return false;
+    }
+    const size_t count = table[3];
+    if(Magic != table[0] || Version != table[1] || (Valid != table[2] && Stale != table[2]) ||
+       file.getSize() != headerLength + count * recordLength)
+    {
+        LogWarn() << "Checksum table " << filepath << " is corrupt!";
+        return false;
+    }
+    if(Stale == table[2])
+    {
+        LogWarn() << "Checksum table " << filepath << " is stale. Checksums of stored payloads are unknown.";
+        return true;
+    }
+    records.reserve(count);
+    for(size_t i = 0; i < count; i++)
+    {
+        const uint32_t* record = table.data() + 4 + i * 3;
+        records[record[0]] = Record{ record[1], record[2] };
+    }
+    return true;
+}
+
+bool VdfsChecksums::save(const Path& filepath) const
+{
+    std::vector<std::pair<size_t, Record>> sorted(records.begin(), records.end()); //Deterministic files.
+    std::sort(sorted.begin(), sorted.end(), [](const std::pair<size_t, Record>& a, const std::pair<size_t, Record>& b)
+    {
+        return a.first < b.first;
+    });
+    std::vector<uint32_t> table = { Magic, Version, Valid, static_cast<uint32_t>(sorted.size()) };
+    table.reserve(4 + sorted.size() * 3);
+    for(const auto& record : sorted)
+    {
+        table.push_back(static_cast<uint32_t>(record.first));
+        table.push_back(record.second.size);
+        table.push_back(record.second.checksum);
+    }
+
+    const String temporary = String(filepath) + ".tmp";
+    {
+        NativeFile file(temporary);
+        if(!file.open(FileAccessMode::TRUNC) ||
+           !file.writeAt(0, reinterpret_cast<const char*>(table.data()), table.size() * sizeof(uint32_t)) || !file.sync())
+        {
+            LogError() << "Can't write checksum table " << temporary << "!";
+            return false;
+        }
+    }
+#if defined(WINDOWS)
+    std::remove(filepath.c_str()); //rename doesn't replace existing files on windows.
+#endif
+    if(0 != std::rename(temporary.c_str(), filepath.c_str()))
+    {
+        LogError() << "Can't replace checksum table " << filepath << "!";
+        return false;
+    }
+    return true;
+}
+
+bool VdfsChecksums::markStale(const Path& filepath)
+{
+    NativeFile file(filepath);
+    uint32_t header[2] = {0};
+    if(!file.open(FileAccessMode::READ_WRITE) || file.getSize() < sizeof(header) ||
+       !file.readAt(0, reinterpret_cast<char*>(header), sizeof(header)) || Magic != header[0] || Version != header[1])
+    {
+        LogWarn() << "Can't mark checksum table " << filepath << " as stale!";
+        return false;
+    }
+    return file.writeAt(sizeof(header), reinterpret_cast<const char*>(&Stale), sizeof(Stale)) && file.sync();
+}
+
+void VdfsChecksums::set(const size_t offset, const size_t size, const uint32_t checksum)
+{
+    records[offset] = Record{ static_cast<uint32_t>(size), checksum };
+}
+
+bool VdfsChecksums::get(const size_t offset, const size_t size, uint32_t& checksum) const
+{
+    auto record = records.find(offset);
+    if(record == records.end() || record->second.size != size) return false;
+    checksum = record->second.checksum;
+    return true;
+}
+
+void VdfsChecksums::move(const size_t oldOffset, const size_t newOffset)
+{
+    auto record = records.find(oldOffset);
+    if(record == records.end() || oldOffset == newOffset) return;
+    const Record moved = record->second;
+    records.erase(record);
+    records[newOffset] = moved;
+}
+
+void VdfsChecksums::erase(const size_t offset)
+{
+    records.erase(offset);
+}
+
+void VdfsChecksums::clear()
+{
+    records.clear();
+}
@@ -0,0 +1,178 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+#include "Archives/cVdfsPrefetcher.h"
+#include "Archives/cVdfsArchive.h"
+#include <algorithm>
+
+using namespace Clipped;
+
+const size_t VdfsPrefetcher::DefaultCacheSize = 64 * 1024 * 1024;
+
+VdfsPrefetcher::VdfsPrefetcher(VDFSArchive& archive)
+    : archive(archive)
+    , readPosition(0)
+    , cachedBytes(0)
+    , cacheSize(DefaultCacheSize)
+    , reading(false)
+    , stopping(false)
+{
+}
+
+VdfsPrefetcher::~VdfsPrefetcher()
+{
+    cancel();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    requested.notify_all();
+    if(worker.joinable()) worker.join();
+}
+
+std::vector<std::shared_future<PrefetchedFile>> VdfsPrefetcher::request(const std::vector<std::pair<size_t, const FileEntry*>>& entries,
+                                                                        const PrefetchCallback& callback)
+{
+    std::vector<std::shared_future<PrefetchedFile>> futures;
+    futures.reserve(entries.size());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for(const auto& entry : entries)
+        {
+            auto request = queue.emplace(entry.first, Request());
+            request->second.fileEntry = entry.second;
+            request->second.callback = callback;
+            futures.push_back(request->second.promise.get_future().share());
+        }
+        if(!worker.joinable()) worker = std::thread(&VdfsPrefetcher::run, this);
+    }
+    requested.notify_one();
+    return futures;
+}
+
+bool VdfsPrefetcher::take(const FileEntry* fileEntry, PrefetchedFile& content)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto cached = cache.find(fileEntry);
+    if(cached == cache.end()) return false;
+    content = cached->second;
+    cachedBytes -= content->size();
+    cache.erase(cached);
+    cacheOrder.erase(std::find(cacheOrder.begin(), cacheOrder.end(), fileEntry));
+    return true;
+}
+
+void VdfsPrefetcher::cancel()
+{
+    std::multimap<size_t, Request> dropped;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        dropped.swap(queue);
+        idle.wait(lock, [this]() { return !reading; }); //The running read still uses the archive.
+        shrinkCache(0);
+    }
+    for(auto& request : dropped)
+        request.second.promise.set_value(nullptr);
+}
+
+void VdfsPrefetcher::setCacheSize(const size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    cacheSize = bytes;
+    shrinkCache(cacheSize);
+}
+
+size_t VdfsPrefetcher::getCacheSize() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return cacheSize;
+}
+
+size_t VdfsPrefetcher::getCachedBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return cachedBytes;
+}
+
+void VdfsPrefetcher::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while(true)
+    {
+        requested.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if(stopping) return;
+
+        auto next = queue.lower_bound(readPosition); //Continue behind the last read payload..
+        if(next == queue.end()) next = queue.begin(); //..or start over at the front.
+        const size_t offset = next->first;
+        Request request = std::move(next->second);
+        queue.erase(next);
+
+        PrefetchedFile content;
+        auto cached = cache.find(request.fileEntry);
+        if(cached != cache.end()) //Requested again, before it has been taken.
+        {
+            content = cached->second;
+        }
+        else
+        {
+            reading = true;
+            lock.unlock();
+            auto data = std::make_shared<std::vector<char>>();
+            if(archive.readFile(request.fileEntry, *data)) content = data;
+            lock.lock();
+            reading = false;
+            if(content) insertIntoCache(request.fileEntry, content);
+            readPosition = offset;
+        }
+        idle.notify_all();
+
+        lock.unlock();
+        if(request.callback) request.callback(request.fileEntry, content); //Before the future, so it is done if the future is ready.
+        request.promise.set_value(content);
+        lock.lock();
+    }
+}
+
+void VdfsPrefetcher::insertIntoCache(const FileEntry* fileEntry, const PrefetchedFile& content)
+{
+    if(content->size() > cacheSize) return; //Too big. Only the futures get it.
+    shrinkCache(cacheSize - content->size());
+    cache.emplace(fileEntry, content);
+    cacheOrder.push_back(fileEntry);
+    cachedBytes += content->size();
+}
+
+void VdfsPrefetcher::shrinkCache(const size_t size)
+{
+    while(cachedBytes > size && !cacheOrder.empty())
+    {
+        auto oldest = cache.find(cacheOrder.front());
+        cachedBytes -= oldest->second->size();
+        cache.erase(oldest);
+        cacheOrder.pop_front();
+    }
+}
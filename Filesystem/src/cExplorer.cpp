@@ -126,6 +126,52 @@ bool Explorer::Exists(const Path &path)
     return fs::exists(path.c_str());
 }
 
+bool Explorer::Stat(const Path& path, ExplorerEntry& entry)
+{
+    std::error_code error;
+    const fs::path fsPath(path.c_str());
+    fs::file_status status = fs::symlink_status(fsPath, error);
+    if(error || !fs::exists(status)) return false;
+    entry.link = fs::is_symlink(status);
+    if(entry.link)
+    {
+        status = fs::status(fsPath, error);
+        if(error || !fs::exists(status)) return false; //Dangling link.
+    }
+
+    entry.path = path;
+    entry.directory = fs::is_directory(status);
+    entry.size = 0;
+    if(!entry.directory)
+    {
+        entry.size = fs::file_size(fsPath, error);
+        if(error) return false;
+    }
+    const fs::file_time_type modified = fs::last_write_time(fsPath, error);
+    if(error) return false;
+    entry.modified = modified.time_since_epoch().count();
+    return true;
+}
+
+vector<ExplorerEntry> Explorer::List(const Path& directory, bool recursive)
+{
+    vector<ExplorerEntry> entries;
+    std::error_code error;
+    fs::directory_iterator it(directory.c_str(), error), end;
+    for(; !error && it != end; it.increment(error))
+    {
+        ExplorerEntry entry;
+        if(!Stat(it->path().u8string().c_str(), entry)) continue; //Vanished meanwhile.
+        entries.push_back(entry);
+        if(recursive && entry.directory && !entry.link) //Links might point to an ancestor.
+        {
+            vector<ExplorerEntry> children = List(entry.path, true);
+            entries.insert(entries.end(), children.begin(), children.end());
+        }
+    }
+    return entries;
+}
+
 void Explorer::Copy(const Path &from, const Path &to, bool recursive)
 {
     if(recursive)
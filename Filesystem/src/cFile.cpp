@@ -27,6 +27,7 @@
 
 #include "cFile.h"
 #include "cBinFile.h"
+#include "cNativeFile.h"
 #include <stdio.h>
 #include <ClippedUtils/cLogger.h>
 #include <ClippedUtils/cOsDetect.h>
@@ -85,6 +86,12 @@ void File::close()
     if (file.is_open()) file.close();
 }
 
+bool File::flush()
+{
+    file.flush();
+    return file.good();
+}
+
 bool File::exists() const
 {
     fstream test;
@@ -138,41 +145,19 @@ bool File::touch(const bool override)
 
 bool File::copy(const Path& destination)
 {
-    bool closeAfterwards = false;
-    bool success = true;
-    if(!isOpen())
-    {
-        closeAfterwards = true;
-        if(!open(FileAccessMode::READ_ONLY, FileDataMode::BINARY))
-            return false;
-    }
-    BinFile copy(destination);
+    if(isOpen() && !flush()) //Pending writes have to reach the file first.
+        return false;
+
+    NativeFile source(filepath);
+    if(!source.open(FileAccessMode::READ_ONLY))
+        return false;
+    NativeFile copy(destination);
     if(!copy.open(FileAccessMode::TRUNC))
     {
         LogError() << "Can't create file: " << destination;
-        success = false;
+        return false;
     }
-    if(success)
-    {
-        char* buffer = new char[1024];
-        MemorySize i = 0;
-        MemorySize size = this->getSize();
-        for(i = 0; i + 1024 < size; i += 1024)
-        {
-            file.read(buffer, 1024);
-            copy.writeBytes(buffer, 1024);
-        }
-        size = size - (i); //Calculate left over size.
-        file.read(buffer, size); //Read rest of content.
-        copy.writeBytes(buffer, size); //Write remaining bytes.
-
-        delete[] buffer;
-        copy.close();
-    }
-
-    if(closeAfterwards)
-        file.close();
-    return success;
+    return NativeFile::copyRange(source, 0, copy, 0, source.getSize());
 }
 
 bool File::isOpen() const { return file.is_open(); }
@@ -0,0 +1,119 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+#include "cFileEntryStream.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace Clipped;
+
+const size_t FileEntryStream::BufferSize = 64 * 1024;
+
+FileEntryStream::FileEntryStream(IArchiver& archiver, const FileEntry* fileEntry)
+    : archiver(archiver)
+    , fileEntry(fileEntry)
+    , size(fileEntry ? static_cast<size_t>(fileEntry->getSize()) : 0)
+    , position(0)
+    , bufferOffset(0)
+{
+}
+
+bool FileEntryStream::readBytes(char* buffer, const size_t count)
+{
+    if(!fileEntry || count > size - position) return false; //Not enough bytes left.
+    if(0 == count) return true;
+    const bool buffered = position >= bufferOffset && position + count <= bufferOffset + this->buffer.size();
+    if(!buffered && count >= BufferSize) //Large reads don't profit from the buffer.
+    {
+        if(!archiver.readFileRange(fileEntry, position, count, buffer)) return false;
+    }
+    else
+    {
+        if(!buffered && !fillBuffer()) return false;
+        std::memcpy(buffer, this->buffer.data() + (position - bufferOffset), count);
+    }
+    position += count;
+    return true;
+}
+
+bool FileEntryStream::readBytes(std::vector<char>& buffer, const size_t count)
+{
+    if(!fileEntry || count > size - position) return false; //Not enough bytes left.
+    const size_t vecPos = buffer.size();
+    buffer.resize(vecPos + count);
+    if(!readBytes(buffer.data() + vecPos, count))
+    {
+        buffer.resize(vecPos);
+        return false;
+    }
+    return true;
+}
+
+bool FileEntryStream::setPosition(const size_t pos)
+{
+    if(pos > size) return false; //Outside of the entry.
+    position = pos;
+    if(position < bufferOffset || position > bufferOffset + buffer.size())
+    {
+        buffer.clear(); //Far away. Refilled by the next read.
+        bufferOffset = 0;
+    }
+    return true;
+}
+
+size_t FileEntryStream::getPosition() const
+{
+    return position;
+}
+
+bool FileEntryStream::seek(const long delta)
+{
+    if(delta < 0 && static_cast<size_t>(-delta) > position) return false; //Before the beginning.
+    return setPosition(position + delta);
+}
+
+size_t FileEntryStream::getSize() const
+{
+    return size;
+}
+
+bool FileEntryStream::isEnd() const
+{
+    return position >= size;
+}
+
+bool FileEntryStream::fillBuffer()
+{
+    buffer.resize(std::min(BufferSize, size - position));
+    bufferOffset = position;
+    if(!archiver.readFileRange(fileEntry, position, buffer.size(), buffer.data()))
+    {
+        buffer.clear();
+        bufferOffset = 0;
+        return false;
+    }
+    return true;
+}
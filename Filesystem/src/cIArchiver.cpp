@@ -26,6 +26,8 @@
 */
 
 #include "cIArchiver.h"
+#include <ClippedUtils/cLogger.h>
+#include <cstring>
 
 using namespace Clipped;
 
@@ -49,6 +51,59 @@ const MemorySize FileEntry::getSize() const
     return size;
 }
 
+FileEntryIterator::FileEntryIterator()
+    : current(nullptr)
+{}
+
+FileEntryIterator::FileEntryIterator(std::unique_ptr<IFileEntryCursor> cursor, const String& pattern)
+    : cursor(std::move(cursor))
+    , pattern(pattern)
+    , current(nullptr)
+{
+    advance();
+}
+
+FileEntryIterator::FileEntryIterator(const FileEntryIterator& rhs)
+    : cursor(rhs.cursor ? rhs.cursor->clone() : nullptr)
+    , pattern(rhs.pattern)
+    , current(rhs.current)
+{}
+
+FileEntryIterator& FileEntryIterator::operator=(const FileEntryIterator& rhs)
+{
+    if(this != &rhs)
+    {
+        cursor = rhs.cursor ? rhs.cursor->clone() : nullptr;
+        pattern = rhs.pattern;
+        current = rhs.current;
+    }
+    return *this;
+}
+
+FileEntryIterator& FileEntryIterator::operator++()
+{
+    advance();
+    return *this;
+}
+
+FileEntryIterator FileEntryIterator::operator++(int)
+{
+    FileEntryIterator previous = *this;
+    advance();
+    return previous;
+}
+
+void FileEntryIterator::advance()
+{
+    current = nullptr;
+    if(!cursor) return; //End iterator.
+    while((current = cursor->next()) != nullptr)
+    {
+        if(pattern.empty() || current->getPath().globMatch(pattern)) return;
+    }
+    cursor.reset(); //Done. Equals end() now.
+}
+
 IArchiver::IArchiver(const Path& basePath)
     : basePath(basePath)
 {}
@@ -62,7 +117,39 @@ bool IArchiver::finalize()
                     //To be overriden, if required by archiver type.
 }
 
+bool IArchiver::readFileRange(const FileEntry* fileEntry, const size_t offset, const size_t length, char* dest)
+{
+    const size_t fileSize = fileEntry ? static_cast<size_t>(fileEntry->getSize()) : 0;
+    if(!fileEntry || offset > fileSize || length > fileSize - offset)
+    {
+        LogError() << "Range exceeds the size of the file!";
+        return false;
+    }
+    std::vector<char> data;
+    if(!readFile(fileEntry, data) || data.size() < offset + length) return false;
+    if(0 < length) std::memcpy(dest, data.data() + offset, length);
+    return true;
+}
+
+FileEntryRange IArchiver::listFiles(const String& globPattern)
+{
+    return FileEntryRange(FileEntryIterator(createFileCursor(), globPattern));
+}
+
 const Path& IArchiver::getBasePath() const
 {
     return basePath;
 }
+
+String IArchiver::normalizePath(const Path& filepath)
+{
+    String normalized;
+    String unified = filepath;
+    unified.replace("\\", "/");
+    for (const String& part : unified.split(String("/")))
+    {
+        if (!normalized.empty()) normalized += "/";
+        normalized += part;
+    }
+    return normalized;
+}
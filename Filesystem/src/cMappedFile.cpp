@@ -0,0 +1,164 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#include "cMappedFile.h"
+#include <ClippedUtils/cLogger.h>
+
+#if defined(WINDOWS)
+    #include <windows.h>
+#elif defined(LINUX)
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+using namespace Clipped;
+
+MappedFile::MappedFile(const Path& filepath)
+    : filepath(filepath)
+    , data(nullptr)
+    , size(0)
+    , opened(false)
+#if defined(WINDOWS)
+    , fileHandle(INVALID_HANDLE_VALUE)
+    , mapHandle(nullptr)
+#elif defined(LINUX)
+    , fileDescriptor(-1)
+#endif
+{}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open()
+{
+    if(opened) return true; //Already mapped.
+
+#if defined(WINDOWS)
+    fileHandle = ::CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(INVALID_HANDLE_VALUE == fileHandle)
+    {
+        LogError() << "Cannot open file: " << filepath;
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if(0 == ::GetFileSizeEx(fileHandle, &fileSize))
+    {
+        LogError() << "Cannot query size of file: " << filepath;
+        close();
+        return false;
+    }
+    size = static_cast<size_t>(fileSize.QuadPart);
+    if(0 < size) //Empty files can't be mapped.
+    {
+        mapHandle = ::CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(nullptr == mapHandle)
+        {
+            LogError() << "Cannot create file mapping for: " << filepath;
+            close();
+            return false;
+        }
+        data = static_cast<const char*>(::MapViewOfFile(mapHandle, FILE_MAP_READ, 0, 0, 0));
+        if(nullptr == data)
+        {
+            LogError() << "Cannot map file: " << filepath;
+            close();
+            return false;
+        }
+    }
+#elif defined(LINUX)
+    fileDescriptor = ::open(filepath.c_str(), O_RDONLY);
+    if(0 > fileDescriptor)
+    {
+        LogError() << "Cannot open file: " << filepath;
+        return false;
+    }
+    struct stat fileStat;
+    if(0 != ::fstat(fileDescriptor, &fileStat))
+    {
+        LogError() << "Cannot query size of file: " << filepath;
+        close();
+        return false;
+    }
+    size = static_cast<size_t>(fileStat.st_size);
+    if(0 < size) //Empty files can't be mapped.
+    {
+        void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+        if(MAP_FAILED == mapping)
+        {
+            LogError() << "Cannot map file: " << filepath;
+            close();
+            return false;
+        }
+        data = static_cast<const char*>(mapping);
+    }
+#endif
+    opened = true;
+    return true;
+}
+
+void MappedFile::close()
+{
+#if defined(WINDOWS)
+    if(data) ::UnmapViewOfFile(data);
+    if(mapHandle) ::CloseHandle(mapHandle);
+    if(INVALID_HANDLE_VALUE != fileHandle) ::CloseHandle(fileHandle);
+    mapHandle = nullptr;
+    fileHandle = INVALID_HANDLE_VALUE;
+#elif defined(LINUX)
+    if(data) ::munmap(const_cast<char*>(data), size);
+    if(0 <= fileDescriptor) ::close(fileDescriptor);
+    fileDescriptor = -1;
+#endif
+    data = nullptr;
+    size = 0;
+    opened = false;
+}
+
+bool MappedFile::isOpen() const
+{
+    return opened;
+}
+
+const char* MappedFile::getData() const
+{
+    return data;
+}
+
+size_t MappedFile::getSize() const
+{
+    return size;
+}
+
+const Path& MappedFile::getFilepath() const
+{
+    return filepath;
+}
@@ -0,0 +1,268 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#include "cNativeFile.h"
+#include <ClippedUtils/cLogger.h>
+#include <vector>
+
+#if defined(WINDOWS)
+    #include <windows.h>
+#elif defined(LINUX)
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <cerrno>
+    #if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+        #define CLIPPED_HAS_COPY_FILE_RANGE
+    #endif
+#endif
+
+using namespace Clipped;
+
+const size_t NativeFile::CopyBufferSize = 1024 * 1024;
+
+NativeFile::NativeFile(const Path& filepath)
+    : filepath(filepath)
+#if defined(WINDOWS)
+    , fileHandle(INVALID_HANDLE_VALUE)
+#elif defined(LINUX)
+    , fileDescriptor(-1)
+#endif
+{}
+
+NativeFile::~NativeFile()
+{
+    close();
+}
+
+bool NativeFile::open(const FileAccessMode& accessMode)
+{
+    close(); //Drop a previously opened handle.
+
+#if defined(WINDOWS)
+    DWORD access = GENERIC_READ;
+    DWORD disposition = OPEN_EXISTING;
+    switch (accessMode)
+    {
+        case FileAccessMode::READ_ONLY:
+            break;
+        case FileAccessMode::READ_WRITE:
+            access |= GENERIC_WRITE;
+            break;
+        case FileAccessMode::TRUNC:
+            access |= GENERIC_WRITE;
+            disposition = CREATE_ALWAYS;
+            break;
+    }
+    fileHandle = ::CreateFileA(filepath.c_str(), access, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                               disposition, FILE_ATTRIBUTE_NORMAL, nullptr);
+#elif defined(LINUX)
+    int flags = O_RDONLY;
+    switch (accessMode)
+    {
+        case FileAccessMode::READ_ONLY:
+            break;
+        case FileAccessMode::READ_WRITE:
+            flags = O_RDWR;
+            break;
+        case FileAccessMode::TRUNC:
+            flags = O_RDWR | O_CREAT | O_TRUNC;
+            break;
+    }
+    fileDescriptor = ::open(filepath.c_str(), flags, 0644);
+#endif
+    if(!isOpen())
+    {
+        LogError() << "Cannot open file: " << filepath;
+        return false;
+    }
+    return true;
+}
+
+void NativeFile::close()
+{
+#if defined(WINDOWS)
+    if(INVALID_HANDLE_VALUE != fileHandle) ::CloseHandle(fileHandle);
+    fileHandle = INVALID_HANDLE_VALUE;
+#elif defined(LINUX)
+    if(0 <= fileDescriptor) ::close(fileDescriptor);
+    fileDescriptor = -1;
+#endif
+}
+
+bool NativeFile::isOpen() const
+{
+#if defined(WINDOWS)
+    return INVALID_HANDLE_VALUE != fileHandle;
+#elif defined(LINUX)
+    return 0 <= fileDescriptor;
+#endif
+}
+
+size_t NativeFile::getSize() const
+{
+#if defined(WINDOWS)
+    LARGE_INTEGER fileSize;
+    if(0 != ::GetFileSizeEx(fileHandle, &fileSize))
+        return static_cast<size_t>(fileSize.QuadPart);
+#elif defined(LINUX)
+    struct stat fileStat;
+    if(0 == ::fstat(fileDescriptor, &fileStat))
+        return static_cast<size_t>(fileStat.st_size);
+#endif
+    LogError() << "Cannot query size of file: " << filepath;
+    return 0;
+}
+
+bool NativeFile::readAt(const size_t offset, char* buffer, size_t count) const
+{
+    if (0 == count) return true; //Nothing to read.
+    if (buffer == nullptr) return false;
+    size_t done = 0;
+
+    while(done < count) //The os may deliver less bytes than requested. Continue until finished.
+    {
+#if defined(WINDOWS)
+        const size_t position = offset + done;
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = static_cast<DWORD>(position & 0xFFFFFFFFu);
+        overlapped.OffsetHigh = static_cast<DWORD>(static_cast<unsigned long long>(position) >> 32);
+        const size_t left = count - done;
+        const DWORD chunk = static_cast<DWORD>(left < 0x40000000u ? left : 0x40000000u); //Limited by DWORD.
+        DWORD bytesRead = 0;
+        if(0 == ::ReadFile(fileHandle, buffer + done, chunk, &bytesRead, &overlapped) || 0 == bytesRead)
+            return false;
+        done += bytesRead;
+#elif defined(LINUX)
+        const ssize_t bytesRead = ::pread(fileDescriptor, buffer + done, count - done, static_cast<off_t>(offset + done));
+        if(0 > bytesRead && EINTR == errno) continue; //Interrupted by a signal - retry.
+        if(0 >= bytesRead) return false; //Read error or unexpected end of file.
+        done += static_cast<size_t>(bytesRead);
+#endif
+    }
+    return true;
+}
+
+bool NativeFile::writeAt(const size_t offset, const char* buffer, size_t count)
+{
+    if (0 == count) return true; //Nothing to write.
+    if (buffer == nullptr) return false;
+    size_t done = 0;
+
+    while(done < count) //The os may write less bytes than requested. Continue until finished.
+    {
+#if defined(WINDOWS)
+        const size_t position = offset + done;
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = static_cast<DWORD>(position & 0xFFFFFFFFu);
+        overlapped.OffsetHigh = static_cast<DWORD>(static_cast<unsigned long long>(position) >> 32);
+        const size_t left = count - done;
+        const DWORD chunk = static_cast<DWORD>(left < 0x40000000u ? left : 0x40000000u); //Limited by DWORD.
+        DWORD bytesWritten = 0;
+        if(0 == ::WriteFile(fileHandle, buffer + done, chunk, &bytesWritten, &overlapped) || 0 == bytesWritten)
+            return false;
+        done += bytesWritten;
+#elif defined(LINUX)
+        const ssize_t bytesWritten = ::pwrite(fileDescriptor, buffer + done, count - done, static_cast<off_t>(offset + done));
+        if(0 > bytesWritten && EINTR == errno) continue; //Interrupted by a signal - retry.
+        if(0 >= bytesWritten) return false; //Write error.
+        done += static_cast<size_t>(bytesWritten);
+#endif
+    }
+    return true;
+}
+
+bool NativeFile::copyRange(const NativeFile& source, const size_t sourceOffset,
+                           NativeFile& target, const size_t targetOffset, const size_t count)
+{
+    const bool sameFile = (&source == &target);
+    if(0 == count || (sameFile && sourceOffset == targetOffset)) return true; //Nothing to copy.
+    const bool overlapping = sameFile && sourceOffset < targetOffset + count && targetOffset < sourceOffset + count;
+    size_t done = 0;
+
+#if defined(CLIPPED_HAS_COPY_FILE_RANGE)
+    while(!overlapping && done < count) //Let the kernel copy without a round trip through user space.
+    {
+        loff_t sourcePosition = static_cast<loff_t>(sourceOffset + done);
+        loff_t targetPosition = static_cast<loff_t>(targetOffset + done);
+        const ssize_t bytesCopied = ::copy_file_range(source.fileDescriptor, &sourcePosition,
+                                                      target.fileDescriptor, &targetPosition, count - done, 0);
+        if(0 > bytesCopied && EINTR == errno) continue; //Interrupted by a signal - retry.
+        if(0 >= bytesCopied) break; //Not supported for these files - Continue with the buffered copy.
+        done += static_cast<size_t>(bytesCopied);
+    }
+#endif
+
+    //Buffered copy. If the target overlaps the end of the source, the range is copied from the back.
+    thread_local std::vector<char> buffer;
+    if(buffer.size() < CopyBufferSize) buffer.resize(CopyBufferSize);
+    const bool backwards = overlapping && targetOffset > sourceOffset;
+    while(done < count)
+    {
+        const size_t chunk = (count - done < CopyBufferSize) ? count - done : CopyBufferSize;
+        const size_t position = backwards ? count - done - chunk : done;
+        if(!source.readAt(sourceOffset + position, buffer.data(), chunk)) return false;
+        if(!target.writeAt(targetOffset + position, buffer.data(), chunk)) return false;
+        done += chunk;
+    }
+    return true;
+}
+
+bool NativeFile::truncate(const size_t size)
+{
+#if defined(WINDOWS)
+    LARGE_INTEGER position;
+    position.QuadPart = static_cast<LONGLONG>(size);
+    if(0 == ::SetFilePointerEx(fileHandle, position, nullptr, FILE_BEGIN) || 0 == ::SetEndOfFile(fileHandle))
+#elif defined(LINUX)
+    if(0 != ::ftruncate(fileDescriptor, static_cast<off_t>(size)))
+#endif
+    {
+        LogError() << "Cannot truncate file: " << filepath;
+        return false;
+    }
+    return true;
+}
+
+bool NativeFile::sync()
+{
+#if defined(WINDOWS)
+    if(0 == ::FlushFileBuffers(fileHandle))
+#elif defined(LINUX)
+    if(0 != ::fsync(fileDescriptor))
+#endif
+    {
+        LogError() << "Cannot sync file: " << filepath;
+        return false;
+    }
+    return true;
+}
+
+const Path& NativeFile::getFilepath() const
+{
+    return filepath;
+}
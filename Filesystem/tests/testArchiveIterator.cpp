@@ -0,0 +1,136 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+#include <ClippedUtils/cLogger.h>
+#include <ClippedFilesystem/Archives/cVdfsArchive.h>
+#include <set>
+
+using namespace Clipped;
+
+bool checkGlobMatch();
+bool checkListFiles();
+bool checkIteratorCopies();
+
+int main(void)
+{
+    bool status = true;
+    Logger() << Logger::MessageType::Debug;
+
+    status &= checkGlobMatch();
+    status &= checkListFiles();
+    status &= checkIteratorCopies();
+
+    if(status)
+        LogInfo() << "All tests passed!";
+    else
+        LogError() << "At least one test failed!";
+    return !status; //success => true => Return code 0
+}
+
+const Path filepath = "testArchiveIterator.vdfs";
+const std::vector<String> files = { "README.TXT", "TEXTURES/WALL.TGA", "TEXTURES/FLOOR.TGA", "TEXTURES/FLOOR.TEX",
+                                    "TEXTURES/WORLD/SKY.TGA", "TEXTURES/WORLD/DEEP/SEA.TGA", "SOUND/SFX/HIT.WAV", "A/B.TGA" };
+
+bool checkGlobMatch()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const std::vector<std::pair<String, bool>> cases = {
+        { "TEXTURES/*.TGA", true }, { "*.TGA", false }, { "**/*.TGA", true }, { "TEXTURES/**/*.TGA", true },
+        { "TEXTURES/**", true }, { "TEXTURES/FLOOR.TG?", true }, { "TEXTURES?FLOOR.TGA", false },
+        { "TEXTURES/FLOOR", false }, { "EXTURES/FLOOR.TGA", false }, { "TEXTURES/FLOOR.TGA", true }, { "**", true } };
+    const Path path = String("TEXTURES/FLOOR.TGA");
+    for(const auto& test : cases)
+    {
+        if(path.globMatch(test.first) != test.second)
+        {
+            LogError() << "Pattern " << test.first << " expected to " << (test.second ? "match" : "fail") << "!";
+            return false;
+        }
+    }
+    return Path(String("A/B/C/D.TGA")).globMatch("A/**/D.TGA") && Path(String("A/D.TGA")).globMatch("A/**/D.TGA") &&
+           !Path(String("A/B/C/D.TGA")).globMatch("A/*/D.TGA");
+}
+
+bool countFiles(VDFSArchive& archive, const String& pattern, const std::set<String>& expected)
+{
+    std::set<String> visited;
+    for(FileEntry& entry : archive.listFiles(pattern))
+    {
+        if(!visited.insert(entry.getPath()).second)
+        {
+            LogError() << "File " << entry.getPath() << " visited twice!";
+            return false;
+        }
+    }
+    if(visited != expected)
+    {
+        LogError() << "Pattern \"" << pattern << "\" visited " << visited.size() << " instead of " << expected.size() << " files!";
+        return false;
+    }
+    return true;
+}
+
+bool checkListFiles()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    {
+        VDFSArchive archive(filepath);
+        if(!archive.create()) return false;
+        for(const String& file : files)
+        {
+            if(!archive.writeFile(archive.createFile(file), std::vector<char>(file.begin(), file.end()))) return false;
+        }
+        if(!archive.close()) return false;
+    }
+    VDFSArchive archive(filepath);
+    if(!archive.open(VdfsAccessMode::READ_ONLY_MAPPED)) return false;
+    return countFiles(archive, "", std::set<String>(files.begin(), files.end())) &&
+           countFiles(archive, "TEXTURES/*.TGA", { "TEXTURES/WALL.TGA", "TEXTURES/FLOOR.TGA" }) &&
+           countFiles(archive, "**/*.TGA", { "TEXTURES/WALL.TGA", "TEXTURES/FLOOR.TGA", "TEXTURES/WORLD/SKY.TGA",
+                                             "TEXTURES/WORLD/DEEP/SEA.TGA", "A/B.TGA" }) &&
+           countFiles(archive, "SOUND/**", { "SOUND/SFX/HIT.WAV" }) &&
+           countFiles(archive, "*.WAV", {});
+}
+
+bool checkIteratorCopies()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    VDFSArchive archive(filepath);
+    if(!archive.open(VdfsAccessMode::READ_ONLY_MAPPED)) return false;
+    auto files = archive.listFiles();
+    auto first = files.begin();
+    auto copy = first;
+    const FileEntry* firstEntry = &*first;
+    ++first;
+    if(copy == first || &*copy != firstEntry || &*(copy++) != firstEntry || copy != first)
+    {
+        LogError() << "Copies of an iterator have to move independently!";
+        return false;
+    }
+    if(std::distance(files.begin(), files.end()) != static_cast<std::ptrdiff_t>(::files.size()))
+        return false;
+    return archive.listFiles("NOTHING/**").begin() == archive.listFiles().end();
+}
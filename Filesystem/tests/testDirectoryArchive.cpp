@@ -0,0 +1,242 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#include <ClippedUtils/cLogger.h>
+#include <ClippedFilesystem/cExplorer.h>
+#include <ClippedFilesystem/cNativeFile.h>
+#include <ClippedFilesystem/Archives/cDirectoryArchive.h>
+#include <unistd.h>
+
+using namespace Clipped;
+
+bool checkCachedTree();
+bool checkLazyRefresh();
+bool checkWrites();
+bool checkLinks();
+
+int main(void)
+{
+    bool status = true;
+    Logger() << Logger::MessageType::Debug;
+
+    status &= checkCachedTree();
+    status &= checkLazyRefresh();
+    status &= checkWrites();
+    status &= checkLinks();
+
+    if(status)
+        LogInfo() << "All tests passed!";
+    else
+        LogError() << "At least one test failed!";
+    return !status; //success => true => Return code 0
+}
+
+const Path root = "testDirectoryArchiveTree";
+
+bool writeLooseFile(const String& relativePath, const String& content)
+{
+    NativeFile file(String(root + "/" + relativePath));
+    return file.open(FileAccessMode::TRUNC) && file.writeAt(0, content.c_str(), content.size());
+}
+
+/**
+ * @brief createTree creates a fresh directory tree with three files.
+ */
+bool createTree()
+{
+    Explorer::Remove(root, true);
+    return Explorer::CreateDir(root) && Explorer::CreateDir(String(root + "/sub")) &&
+           Explorer::CreateDir(String(root + "/sub/deep")) && writeLooseFile("a.txt", "first") &&
+           writeLooseFile("sub/b.txt", "second file") && writeLooseFile("sub/deep/c.txt", "third");
+}
+
+bool readsContent(DirectoryArchive& archive, const Path& filepath, const String& expected)
+{
+    std::vector<char> data;
+    FileEntry* entry = archive.getFile(filepath);
+    if(!entry || !archive.readFile(entry, data) || std::string(data.begin(), data.end()) != expected ||
+       entry->getSize() != expected.size())
+    {
+        LogError() << "Content of " << filepath << " broken!";
+        return false;
+    }
+    return true;
+}
+
+bool checkCachedTree()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    if(!createTree()) return false;
+
+    DirectoryArchive archive(root);
+    if(!archive.open()) return false;
+    if(!readsContent(archive, Path("a.txt"), "first") || !readsContent(archive, Path("sub\\b.txt"), "second file") ||
+       !readsContent(archive, Path("sub/deep/c.txt"), "third") || archive.getFile(Path("sub/missing.txt")))
+    {
+        return false;
+    }
+    if(archive.searchFile(Path("c.txt")) != archive.getFile(Path("sub/deep/c.txt")))
+    {
+        LogError() << "Search by name failed!";
+        return false;
+    }
+
+    char range[4] = {0};
+    if(!archive.readFileRange(archive.getFile(Path("sub/b.txt")), 7, 4, range) || std::string(range, 4) != "file" ||
+       archive.readFileRange(archive.getFile(Path("sub/b.txt")), 8, 4, range))
+    {
+        LogError() << "Range read failed!";
+        return false;
+    }
+
+    size_t listed = 0;
+    for(FileEntry& entry : archive.listFiles("**.txt"))
+    {
+        (void)entry;
+        listed++;
+    }
+    if(3 != listed)
+    {
+        LogError() << "Listed " << listed << " files instead of 3!";
+        return false;
+    }
+    return archive.close();
+}
+
+bool checkLazyRefresh()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    if(!createTree()) return false;
+
+    DirectoryArchive archive(root);
+    if(!archive.open()) return false;
+
+    //Added files and directories show up on lookup:
+    if(!writeLooseFile("sub/added.txt", "new") || !Explorer::CreateDir(String(root + "/sub/fresh")) ||
+       !writeLooseFile("sub/fresh/d.txt", "fresh") || !readsContent(archive, Path("sub/added.txt"), "new") ||
+       !readsContent(archive, Path("sub/fresh/d.txt"), "fresh"))
+    {
+        LogError() << "Added files not found!";
+        return false;
+    }
+
+    //Changed sizes get picked up on read:
+    FileEntry* changed = archive.getFile(Path("a.txt"));
+    std::vector<char> outdated(changed->getSize());
+    if(!writeLooseFile("a.txt", "first, but longer") || archive.readFile(changed, outdated.data()) ||
+       !readsContent(archive, Path("a.txt"), "first, but longer"))
+    {
+        LogError() << "Changed file not refreshed!";
+        return false;
+    }
+
+    //Removed files and directories vanish on refresh:
+    if(!Explorer::Remove(String(root + "/sub/b.txt"), false) || !Explorer::Remove(String(root + "/sub/deep"), true) ||
+       !archive.refresh() || archive.refresh() || archive.getFile(Path("sub/b.txt")) ||
+       archive.getFile(Path("sub/deep/c.txt")) || archive.searchFile(Path("c.txt")))
+    {
+        LogError() << "Removed files still cached!";
+        return false;
+    }
+    return readsContent(archive, Path("sub/added.txt"), "new");
+}
+
+bool checkWrites()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    if(!createTree()) return false;
+
+    DirectoryArchive archive(root);
+    if(!archive.open()) return false;
+    const std::vector<char> content = {'w', 'r', 'i', 't', 't', 'e', 'n'};
+    FileEntry* created = archive.createFile(Path("x/y/z.txt"));
+    if(!created || !archive.writeFile(created, content) || created->getSize() != content.size() ||
+       archive.createFile(Path("x/y/z.txt")) != created || !readsContent(archive, Path("x/y/z.txt"), "written"))
+    {
+        LogError() << "Creating a file failed!";
+        return false;
+    }
+
+    DirectoryArchive reopened(root);
+    if(!reopened.open() || !readsContent(reopened, Path("x/y/z.txt"), "written")) return false;
+    std::vector<char> data;
+    if(archive.readFile(reopened.getFile(Path("a.txt")), data)) //Handles are bound to their instance.
+    {
+        LogError() << "Handle of another instance accepted!";
+        return false;
+    }
+
+    if(!archive.removeFile(archive.getFile(Path("sub/b.txt"))) || archive.getFile(Path("sub/b.txt")) ||
+       Explorer::Exists(String(root + "/sub/b.txt")))
+    {
+        LogError() << "Removing a file failed!";
+        return false;
+    }
+    archive.close();
+    reopened.close();
+    return Explorer::Remove(root, true);
+}
+
+bool checkLinks()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    if(!createTree()) return false;
+    //A link back to the root forms a cycle. A link to a file is just another file:
+    if(0 != symlink("..", String(root + "/sub/up").c_str()) || 0 != symlink("b.txt", String(root + "/sub/linked.txt").c_str()))
+    {
+        LogError() << "Can't create links!";
+        return false;
+    }
+
+    ExplorerEntry info;
+    if(!Explorer::Stat(String(root + "/sub/up"), info) || !info.directory || !info.link ||
+       !Explorer::Stat(String(root + "/sub/linked.txt"), info) || info.directory || !info.link || info.size != 11)
+    {
+        LogError() << "Links not reported!";
+        return false;
+    }
+    const std::vector<ExplorerEntry> listed = Explorer::List(root, true);
+    if(7 != listed.size()) //sub, deep, up, linked.txt and three files.
+    {
+        LogError() << "Listed " << listed.size() << " instead of 7 objects!";
+        return false;
+    }
+
+    DirectoryArchive archive(root);
+    if(!archive.open() || !readsContent(archive, Path("sub/linked.txt"), "second file") || archive.getFile(Path("sub/up/a.txt")))
+    {
+        LogError() << "Links not handled by the archive!";
+        return false;
+    }
+    if(!writeLooseFile("sub/later.txt", "later") || !archive.refresh() || !readsContent(archive, Path("sub/later.txt"), "later") ||
+       archive.getFile(Path("sub/up/sub/later.txt")))
+    {
+        return false;
+    }
+    archive.close();
+    return Explorer::Remove(root, true);
+}
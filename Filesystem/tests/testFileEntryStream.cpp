@@ -0,0 +1,201 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+#include "testFixture.h"
+#include <ClippedFilesystem/cFileEntryStream.h>
+#include <cstring>
+
+using namespace Clipped;
+
+bool checkReadFileRange();
+bool checkFileEntryStream();
+bool checkBufferedReads();
+
+int main(void)
+{
+    bool status = true;
+    Logger() << Logger::MessageType::Debug;
+
+    status &= checkReadFileRange();
+    status &= checkFileEntryStream();
+    status &= checkBufferedReads();
+
+    if(status)
+        LogInfo() << "All tests passed!";
+    else
+        LogError() << "At least one test failed!";
+    return !status; //success => true => Return code 0
+}
+
+const Path filepath = "testFileEntryStream.vdfs";
+const TestFiles files("Range", 1, 2, 3 * VDFSArchive::CompressionChunkSize + 1234, 1); //Spanning several chunks.
+const Path rawPath = files.pathOf(0);
+const Path compressedPath = files.pathOf(1);
+
+bool createRangeArchive()
+{
+    VDFSArchive archive(filepath);
+    if(!archive.create()) return false;
+    if(!archive.writeFile(archive.createFile(rawPath), files.contentOf(0))) return false;
+    archive.setCompression(true);
+    if(!archive.writeFile(archive.createFile(compressedPath), files.contentOf(1))) return false;
+    return archive.close();
+}
+
+bool checkRanges(IArchiver& archive, const Path& path, const std::vector<char>& expected)
+{
+    const size_t chunk = VDFSArchive::CompressionChunkSize;
+    const std::pair<size_t, size_t> ranges[] = { {0, 0}, {0, 4096}, {100, 1}, {chunk - 10, 20}, {chunk, chunk},
+                                                 {chunk / 2, 2 * chunk}, {0, expected.size()}, {expected.size() - 5, 5} };
+    auto* entry = archive.getFile(path);
+    if(!entry) return false;
+    for(const auto& range : ranges)
+    {
+        std::vector<char> data(range.second + 1, '#');
+        if(!archive.readFileRange(entry, range.first, range.second, data.data()) || data.back() != '#' ||
+           !std::equal(data.begin(), data.end() - 1, expected.begin() + range.first))
+        {
+            LogError() << "Range " << range.first << " + " << range.second << " of " << path << " broken!";
+            return false;
+        }
+    }
+    std::vector<char> data(16);
+    if(archive.readFileRange(entry, expected.size() - 4, 5, data.data()) ||
+       archive.readFileRange(entry, expected.size() + 1, 0, data.data()))
+    {
+        LogError() << "Ranges outside of the entry have to fail!";
+        return false;
+    }
+    return true;
+}
+
+bool checkReadFileRange()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    if(!createRangeArchive()) return false;
+    for(const auto mode : {VdfsAccessMode::READ_WRITE, VdfsAccessMode::READ_ONLY_MAPPED})
+    {
+        VDFSArchive archive(filepath);
+        if(!archive.open(mode)) return false;
+        if(!checkRanges(archive, rawPath, files.contentOf(0)) || !checkRanges(archive, compressedPath, files.contentOf(1)))
+            return false;
+    }
+    return true;
+}
+
+bool checkFileEntryStream()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    VDFSArchive archive(filepath);
+    if(!archive.open(VdfsAccessMode::READ_ONLY_MAPPED)) return false;
+    const std::vector<char> expected = files.contentOf(1);
+    FileEntryStream stream(archive, archive.getFile(compressedPath));
+
+    uint32_t value = 0;
+    std::vector<char> data;
+    if(stream.getSize() != expected.size() || !stream.read(value) || stream.getPosition() != sizeof(value) ||
+       std::memcmp(&value, expected.data(), sizeof(value)) != 0)
+    {
+        LogError() << "Typed read failed!";
+        return false;
+    }
+    if(!stream.setPosition(VDFSArchive::CompressionChunkSize - 2) || !stream.readBytes(data, 4) || !stream.seek(-4) ||
+       !stream.readBytes(data, 4) || stream.getPosition() != VDFSArchive::CompressionChunkSize + 2 ||
+       !std::equal(data.begin(), data.begin() + 4, expected.begin() + VDFSArchive::CompressionChunkSize - 2) ||
+       !std::equal(data.begin() + 4, data.end(), data.begin()))
+    {
+        LogError() << "Seek and read across chunks failed!";
+        return false;
+    }
+    if(stream.seek(-static_cast<long>(expected.size())) || !stream.setPosition(expected.size() - 2) ||
+       stream.readBytes(data, 3) || data.size() != 8 || !stream.readBytes(data, 2) || !stream.isEnd() ||
+       stream.setPosition(expected.size() + 1))
+    {
+        LogError() << "Stream bounds not respected!";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief The CountingArchive class counts the range reads of a VDFSArchive.
+ */
+class CountingArchive : public VDFSArchive
+{
+public:
+    CountingArchive(const Path& filepath) : VDFSArchive(filepath), rangeReads(0) {}
+
+    virtual bool readFileRange(const FileEntry* fileEntry, const size_t offset, const size_t length, char* dest) override
+    {
+        rangeReads++;
+        return VDFSArchive::readFileRange(fileEntry, offset, length, dest);
+    }
+
+    size_t rangeReads;
+};
+
+bool checkBufferedReads()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    CountingArchive archive(filepath);
+    if(!archive.open()) return false;
+    const std::vector<char> expected = files.contentOf(1);
+    FileEntryStream stream(archive, archive.getFile(compressedPath));
+
+    std::vector<char> data;
+    uint32_t value = 0;
+    while(stream.read(value)) //Value by value, like a parser.
+    {
+        data.insert(data.end(), reinterpret_cast<char*>(&value), reinterpret_cast<char*>(&value) + sizeof(value));
+    }
+    if(!stream.readBytes(data, expected.size() - data.size()) || data != expected)
+    {
+        LogError() << "Buffered reads returned wrong content!";
+        return false;
+    }
+    const size_t fills = (expected.size() + FileEntryStream::BufferSize - 1) / FileEntryStream::BufferSize;
+    if(archive.rangeReads > fills + 1) //The unaligned tail may need another fill.
+    {
+        LogError() << "Read " << archive.rangeReads << " ranges instead of " << fills << "!";
+        return false;
+    }
+
+    //Seeking inside of the buffer keeps it, seeking outside drops it:
+    const size_t readsBefore = archive.rangeReads;
+    if(!stream.setPosition(10) || !stream.read(value) || !stream.setPosition(20) || !stream.read(value) ||
+       archive.rangeReads != readsBefore + 1 || std::memcmp(&value, expected.data() + 20, sizeof(value)) != 0)
+    {
+        LogError() << "Buffer not reused after seeking inside of it!";
+        return false;
+    }
+    if(!stream.setPosition(2 * FileEntryStream::BufferSize + 5) || !stream.read(value) || archive.rangeReads != readsBefore + 2 ||
+       std::memcmp(&value, expected.data() + 2 * FileEntryStream::BufferSize + 5, sizeof(value)) != 0)
+    {
+        LogError() << "Buffer not refilled after seeking outside of it!";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,175 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#pragma once
+
+#include <ClippedUtils/cLogger.h>
+#include <ClippedFilesystem/cNativeFile.h>
+#include <ClippedFilesystem/Archives/cVdfsArchive.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace Clipped;
+
+/**
+ * @brief textOf creates deterministic, compressible content. Lines name the file number and version,
+ *   so the content of each file and version is unique.
+ * @param i file number.
+ * @param size of the content in bytes.
+ * @param version of the content.
+ * @return the content.
+ */
+inline std::vector<char> textOf(const size_t i, const size_t size, const size_t version = 0)
+{
+    std::vector<char> content;
+    content.reserve(size + 64);
+    for(size_t line = 0; content.size() < size; line++)
+    {
+        const std::string text = "File " + std::to_string(i) + " version " + std::to_string(version) +
+                                 " line " + std::to_string(line % 50) + ".\n";
+        content.insert(content.end(), text.begin(), text.end());
+    }
+    content.resize(size);
+    return content;
+}
+
+/**
+ * @brief The TestFiles struct describes a set of numbered test files.
+ *   File i is stored at "<directory><i % directoryCount>/file<i><extension>" and has
+ *   baseSize + (i * sizeStep) % sizeModulo bytes of content (see textOf).
+ */
+struct TestFiles
+{
+    /**
+     * @brief TestFiles describes count files.
+     * @param directory of the files. Numbered, if the files are spread over several directories.
+     * @param directoryCount amount of directories, the files are spread over.
+     * @param count amount of files.
+     * @param baseSize size of file 0.
+     * @param sizeStep size added per file number.
+     * @param sizeModulo limits the added size. 0 for no limit.
+     * @param extension of the file names.
+     */
+    TestFiles(const String& directory, const size_t directoryCount, const size_t count, const size_t baseSize,
+              const size_t sizeStep, const size_t sizeModulo = 0, const String& extension = ".dat")
+        : directory(directory), directoryCount(directoryCount), count(count), baseSize(baseSize)
+        , sizeStep(sizeStep), sizeModulo(sizeModulo), extension(extension)
+    {}
+
+    Path pathOf(const size_t i) const
+    {
+        const String numbered = 1 < directoryCount ? String(directory + String((int)(i % directoryCount))) : directory;
+        return String(numbered + "/file" + String((int)i) + extension);
+    }
+
+    size_t sizeOf(const size_t i) const
+    {
+        return baseSize + (0 < sizeModulo ? (i * sizeStep) % sizeModulo : i * sizeStep);
+    }
+
+    std::vector<char> contentOf(const size_t i, const size_t version = 0) const
+    {
+        return textOf(i, sizeOf(i), version);
+    }
+
+    String directory;       //!< Directory of the files.
+    size_t directoryCount;  //!< Amount of directories, the files are spread over.
+    size_t count;           //!< Amount of files.
+    size_t baseSize;        //!< Size of file 0.
+    size_t sizeStep;        //!< Size added per file number.
+    size_t sizeModulo;      //!< Limit of the added size. 0 for no limit.
+    String extension;       //!< Extension of the file names.
+};
+
+/**
+ * @brief writeFiles creates or overwrites the files first to last (excluded) in an archive.
+ */
+inline bool writeFiles(IArchiver& archive, const TestFiles& files, const size_t first, const size_t last, const size_t version = 0)
+{
+    for(size_t i = first; i < last; i++)
+    {
+        FileEntry* entry = archive.createFile(files.pathOf(i));
+        if(!entry || !archive.writeFile(entry, files.contentOf(i, version)))
+        {
+            LogError() << "Can't write file " << files.pathOf(i) << "!";
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief createArchive creates a vdfs archive containing all files.
+ */
+inline bool createArchive(const Path& filepath, const TestFiles& files)
+{
+    VDFSArchive archive(filepath);
+    return archive.create() && writeFiles(archive, files, 0, files.count) && archive.close();
+}
+
+/**
+ * @brief readsContent checks the size and content of a file. Logs an error otherwise.
+ */
+inline bool readsContent(IArchiver& archive, const Path& filepath, const std::vector<char>& expected)
+{
+    std::vector<char> data;
+    FileEntry* entry = archive.getFile(filepath);
+    if(!entry || entry->getSize() != expected.size() || !archive.readFile(entry, data) || data != expected)
+    {
+        LogError() << "Content of " << filepath << " broken!";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief checkFiles checks the content of every step-th file from first to last (excluded).
+ */
+inline bool checkFiles(IArchiver& archive, const TestFiles& files, const size_t first, const size_t last,
+                       const size_t step = 1, const size_t version = 0)
+{
+    for(size_t i = first; i < last; i += step)
+    {
+        if(!readsContent(archive, files.pathOf(i), files.contentOf(i, version))) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief patchArchive overwrites bytes of an archive file relative to the first occurrence of a pattern.
+ */
+inline bool patchArchive(const Path& filepath, const std::string& pattern, const size_t offset, const void* bytes, const size_t count)
+{
+    NativeFile file(filepath);
+    std::vector<char> data;
+    if(!file.open(FileAccessMode::READ_WRITE)) return false;
+    data.resize(file.getSize());
+    if(!file.readAt(0, data.data(), data.size())) return false;
+    auto found = std::search(data.begin(), data.end(), pattern.begin(), pattern.end());
+    return found != data.end() && file.writeAt(static_cast<size_t>(found - data.begin()) + offset, static_cast<const char*>(bytes), count);
+}
@@ -0,0 +1,144 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#include <ClippedUtils/cLogger.h>
+#include <ClippedFilesystem/cNativeFile.h>
+#include <ClippedFilesystem/cBinFile.h>
+
+using namespace Clipped;
+
+bool checkCopyToOtherFile();
+bool checkOverlappingCopy();
+bool checkFileCopy();
+
+int main(void)
+{
+    bool status = true;
+    Logger() << Logger::MessageType::Debug;
+
+    status &= checkCopyToOtherFile();
+    status &= checkOverlappingCopy();
+    status &= checkFileCopy();
+
+    if(status)
+        LogInfo() << "All tests passed!";
+    else
+        LogError() << "At least one test failed!";
+    return !status; //success => true => Return code 0
+}
+
+/**
+ * @brief pattern creates size bytes of deterministic test data.
+ */
+std::vector<char> pattern(const size_t size)
+{
+    std::vector<char> data(size);
+    for(size_t i = 0; i < size; i++)
+        data[i] = static_cast<char>((i * 7 + i / 251) & 0xFF);
+    return data;
+}
+
+bool checkCopyToOtherFile()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const size_t size = 3 * NativeFile::CopyBufferSize + 123; //Several chunks with a partial one.
+    const std::vector<char> data = pattern(size);
+    NativeFile source("testNativeFileSource.bin");
+    NativeFile target("testNativeFileTarget.bin");
+    if(!source.open(FileAccessMode::TRUNC) || !source.writeAt(0, data.data(), size))
+    {
+        LogError() << "Can't create the source file!";
+        return false;
+    }
+    if(!target.open(FileAccessMode::TRUNC) || !NativeFile::copyRange(source, 0, target, 10, size))
+    {
+        LogError() << "copyRange failed!";
+        return false;
+    }
+    std::vector<char> copied(size);
+    if(target.getSize() != size + 10 || !target.readAt(10, copied.data(), size) || copied != data)
+    {
+        LogError() << "Copied data differs!";
+        return false;
+    }
+    return true;
+}
+
+bool checkOverlappingCopy()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const size_t size = 2 * NativeFile::CopyBufferSize + 77;
+    const size_t shift = 1000;
+    const std::vector<char> data = pattern(size);
+    NativeFile file("testNativeFileOverlap.bin");
+    if(!file.open(FileAccessMode::TRUNC) || !file.writeAt(shift, data.data(), size))
+    {
+        LogError() << "Can't create the test file!";
+        return false;
+    }
+
+    std::vector<char> copied(size);
+    if(!NativeFile::copyRange(file, shift, file, 0, size) || !file.readAt(0, copied.data(), size) || copied != data)
+    {
+        LogError() << "Overlapping copy to the front failed!";
+        return false;
+    }
+    if(!NativeFile::copyRange(file, 0, file, shift, size) || !file.readAt(shift, copied.data(), size) || copied != data)
+    {
+        LogError() << "Overlapping copy to the back failed!";
+        return false;
+    }
+    return true;
+}
+
+bool checkFileCopy()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const std::vector<char> data = pattern(NativeFile::CopyBufferSize + 5);
+    BinFile original("testFileCopySource.bin");
+    if(!original.open(FileAccessMode::TRUNC) || !original.writeBytes(data))
+    {
+        LogError() << "Can't create the source file!";
+        return false;
+    }
+    if(!original.copy("testFileCopyTarget.bin")) //Copied while opened with pending writes.
+    {
+        LogError() << "File::copy failed!";
+        return false;
+    }
+    original.close();
+
+    NativeFile copy("testFileCopyTarget.bin");
+    std::vector<char> copied(data.size());
+    if(!copy.open(FileAccessMode::READ_ONLY) || copy.getSize() != data.size() ||
+       !copy.readAt(0, copied.data(), copied.size()) || copied != data)
+    {
+        LogError() << "Copied file differs!";
+        return false;
+    }
+    return true;
+}
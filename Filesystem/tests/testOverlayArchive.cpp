@@ -0,0 +1,242 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#include "testFixture.h"
+#include <ClippedFilesystem/cExplorer.h>
+#include <ClippedFilesystem/Archives/cOverlayArchive.h>
+
+using namespace Clipped;
+
+bool checkShadowing();
+bool checkTopLayerWrites();
+bool checkUnmount();
+bool checkDirectoryLayer();
+bool checkDirectoryRefresh();
+
+int main(void)
+{
+    bool status = true;
+    Logger() << Logger::MessageType::Debug;
+
+    status &= checkShadowing();
+    status &= checkTopLayerWrites();
+    status &= checkUnmount();
+    status &= checkDirectoryLayer();
+    status &= checkDirectoryRefresh();
+
+    if(status)
+        LogInfo() << "All tests passed!";
+    else
+        LogError() << "At least one test failed!";
+    return !status; //success => true => Return code 0
+}
+
+const TestFiles files("Dir", 3, 40, 32, 1);
+const Path basePath = "testOverlayBase.vdfs";
+const Path patchPath = "testOverlayPatch.vdfs";
+
+/**
+ * @brief createArchives creates a base archive with all files and a patch archive,
+ *   which replaces every 4th file and adds one file.
+ */
+bool createArchives()
+{
+    if(!createArchive(basePath, files)) return false;
+    VDFSArchive patch(patchPath);
+    if(!patch.create()) return false;
+    for(size_t i = 0; i < files.count; i += 4)
+    {
+        if(!writeFiles(patch, files, i, i + 1, 1)) return false;
+    }
+    return patch.writeFile(patch.createFile(Path("Dir1/added.dat")), files.contentOf(7, 2)) && patch.close();
+}
+
+/**
+ * @brief readsVersion checks, if the overlay serves file i in the given version.
+ */
+bool readsVersion(OverlayArchive& overlay, const size_t i, const size_t version)
+{
+    return readsContent(overlay, files.pathOf(i), files.contentOf(i, version));
+}
+
+bool checkShadowing()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    if(!createArchives()) return false;
+
+    VDFSArchive base(basePath), patch(patchPath);
+    OverlayArchive overlay;
+    if(!base.open() || !patch.open() || !overlay.mount(base) || !overlay.mount(patch) || overlay.mount(base)) return false;
+
+    for(size_t i = 0; i < files.count; i++)
+    {
+        if(!readsVersion(overlay, i, i % 4 == 0 ? 1 : 0)) return false;
+        if(overlay.getLayer(overlay.getFile(files.pathOf(i))) != (i % 4 == 0 ? &patch : &base)) return false;
+    }
+    FileEntry* added = overlay.getFile(Path("Dir1\\added.dat"));
+    if(!added || overlay.searchFile(Path("added.dat")) != added || overlay.searchFile(Path("file8.dat")) != overlay.getFile(files.pathOf(8)))
+    {
+        LogError() << "Lookup of the added file failed!";
+        return false;
+    }
+
+    //Range reads are served by the owning layer:
+    std::vector<char> range(10);
+    const std::vector<char> expected = files.contentOf(8, 1);
+    if(!overlay.readFileRange(overlay.getFile(files.pathOf(8)), 5, range.size(), range.data()) ||
+       !std::equal(range.begin(), range.end(), expected.begin() + 5))
+    {
+        LogError() << "Range read failed!";
+        return false;
+    }
+
+    size_t listed = 0;
+    for(FileEntry& entry : overlay.listFiles())
+    {
+        (void)entry;
+        listed++;
+    }
+    if(listed != files.count + 1 || overlay.readFile(base.getFile(files.pathOf(0)), range))
+    {
+        LogError() << "Shadowed files are visible! Listed: " << listed;
+        return false;
+    }
+    return true;
+}
+
+bool checkTopLayerWrites()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    if(!createArchives()) return false;
+
+    VDFSArchive base(basePath), patch(patchPath);
+    OverlayArchive overlay;
+    if(!base.open(VdfsAccessMode::READ_ONLY_MAPPED) || !patch.open() || !overlay.mount(base) || !overlay.mount(patch)) return false;
+
+    //Files of the base layer are read only. Creating them shadows them:
+    if(overlay.writeFile(overlay.getFile(files.pathOf(1)), files.contentOf(1, 3)) || overlay.removeFile(overlay.getFile(files.pathOf(1)))) return false;
+    FileEntry* shadow = overlay.createFile(files.pathOf(1));
+    if(!shadow || overlay.getLayer(shadow) != &patch || !overlay.writeFile(shadow, files.contentOf(1, 3)) ||
+       !readsVersion(overlay, 1, 3) || !overlay.finalize())
+    {
+        LogError() << "Shadowing a base file failed!";
+        return false;
+    }
+
+    //Removing a patched file uncovers the base version:
+    if(!overlay.removeFile(overlay.getFile(files.pathOf(4))) || !readsVersion(overlay, 4, 0) ||
+       overlay.getLayer(overlay.getFile(files.pathOf(4))) != &base)
+    {
+        LogError() << "Removed file didn't uncover the base file!";
+        return false;
+    }
+    if(!overlay.removeFile(overlay.getFile(Path("Dir1/added.dat"))) || overlay.getFile(Path("Dir1/added.dat")) ||
+       overlay.searchFile(Path("added.dat")))
+    {
+        LogError() << "Removed file still visible!";
+        return false;
+    }
+    return overlay.close() && patch.close() && base.close();
+}
+
+bool checkUnmount()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    if(!createArchives()) return false;
+
+    VDFSArchive base(basePath), patch(patchPath);
+    OverlayArchive overlay;
+    if(!base.open() || !patch.open() || !overlay.mount(base) || !overlay.mount(patch)) return false;
+    if(!overlay.unmount(patch) || overlay.unmount(patch) || overlay.getLayerCount() != 1) return false;
+    for(size_t i = 0; i < files.count; i++)
+    {
+        if(!readsVersion(overlay, i, 0)) return false;
+    }
+    return nullptr == overlay.getFile(Path("Dir1/added.dat"));
+}
+
+bool checkDirectoryLayer()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    if(!createArchives()) return false;
+    const Path directory = "testOverlayLoose";
+    Explorer::Remove(directory, true);
+    const std::vector<char> loose = files.contentOf(2, 4);
+    NativeFile file(String(directory + "/" + files.pathOf(2)));
+    if(!Explorer::CreateDir(directory) || !Explorer::CreateDir(String(directory + "/Dir2")) ||
+       !file.open(FileAccessMode::TRUNC) || !file.writeAt(0, loose.data(), loose.size()))
+    {
+        return false;
+    }
+    file.close();
+
+    VDFSArchive base(basePath);
+    OverlayArchive overlay;
+    if(!base.open() || !overlay.mount(base)) return false;
+    DirectoryArchive* layer = overlay.mountDirectory(directory);
+    if(!layer || overlay.getLayer(overlay.getFile(files.pathOf(2))) != layer || !readsVersion(overlay, 2, 4) || !readsVersion(overlay, 3, 0))
+    {
+        LogError() << "Loose file doesn't shadow the archive!";
+        return false;
+    }
+    if(!overlay.unmount(*layer) || !readsVersion(overlay, 2, 0)) return false;
+    return overlay.close() && Explorer::Remove(directory, true);
+}
+
+bool checkDirectoryRefresh()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    if(!createArchives()) return false;
+    const Path directory = "testOverlayRefresh";
+    Explorer::Remove(directory, true);
+    if(!Explorer::CreateDir(directory) || !Explorer::CreateDir(String(directory + "/Dir2"))) return false;
+    for(const size_t i : {2, 5})
+    {
+        const std::vector<char> loose = files.contentOf(i, 4);
+        NativeFile file(String(directory + "/" + files.pathOf(i)));
+        if(!file.open(FileAccessMode::TRUNC) || !file.writeAt(0, loose.data(), loose.size())) return false;
+    }
+
+    VDFSArchive patch(patchPath);
+    OverlayArchive overlay;
+    DirectoryArchive* layer = overlay.mountDirectory(directory);
+    if(!layer || !patch.open() || !overlay.mount(patch) || !readsVersion(overlay, 5, 4)) return false;
+
+    //Uncovering a file must not refresh the directory, which would drop the entry of file 5 behind the lookup:
+    if(!Explorer::Remove(String(directory + "/" + files.pathOf(5)), false) ||
+       !overlay.removeFile(overlay.getFile(files.pathOf(8))) || overlay.getFile(files.pathOf(8)))
+    {
+        LogError() << "Removing a file above a directory layer failed!";
+        return false;
+    }
+    if(!layer->refresh() || overlay.getFile(files.pathOf(5)) || !readsVersion(overlay, 2, 4) || !readsVersion(overlay, 4, 1))
+    {
+        LogError() << "Refresh of the directory layer not merged!";
+        return false;
+    }
+    return overlay.close() && patch.close() && Explorer::Remove(directory, true);
+}
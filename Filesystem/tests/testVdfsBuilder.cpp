@@ -0,0 +1,169 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#include "testFixture.h"
+#include <ClippedFilesystem/Archives/cVdfsBuilder.h>
+#include <ClippedFilesystem/cBinFile.h>
+
+using namespace Clipped;
+
+bool checkBuild();
+bool checkEmptyBuild();
+bool checkParallelBuild();
+
+int main(void)
+{
+    bool status = true;
+    Logger() << Logger::MessageType::Debug;
+
+    status &= checkBuild();
+    status &= checkEmptyBuild();
+    status &= checkParallelBuild();
+
+    if(status)
+        LogInfo() << "All tests passed!";
+    else
+        LogError() << "At least one test failed!";
+    return !status; //success => true => Return code 0
+}
+
+const TestFiles buffers("Data/Dir", 7, 200, 0, 53, 900, ".bin"); //Including empty ones.
+
+bool checkBuild()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const Path filepath = "testBuilder.vdfs";
+    VDFSBuilder builder(filepath);
+    builder.getHeader().comment = "VDFS Archive built by Clipped.";
+    builder.getHeader().signature = "PSVDSC_V2.00\n\r\n\r";
+
+    size_t payloadBytes = 0;
+    for(size_t i = 0; i < buffers.count; i++)
+    {
+        builder.addBuffer(buffers.pathOf(i), buffers.contentOf(i));
+        payloadBytes += buffers.sizeOf(i);
+    }
+    //A large source file, that exceeds the write buffer:
+    std::vector<char> large(VDFSBuilder::WriteBufferSize + 1000);
+    for(size_t j = 0; j < large.size(); j++)
+        large[j] = static_cast<char>((j * 3) & 0xFF);
+    BinFile source("testBuilderSource.bin");
+    if(!source.open(FileAccessMode::TRUNC) || !source.writeBytes(large)) return false;
+    source.close();
+    builder.addFile("Data/large.bin", "testBuilderSource.bin");
+    builder.addBuffer("Data/replaced.bin", buffers.contentOf(1));
+    builder.addBuffer("Data/replaced.bin", buffers.contentOf(2)); //Replaces the first one.
+    payloadBytes += large.size() + buffers.sizeOf(2);
+
+    if(!builder.build())
+    {
+        LogError() << "Build failed!";
+        return false;
+    }
+
+    //Header + index (Data, 7 directories, all files) + payloads. Nothing else:
+    const size_t expectedSize = 296 + (1 + 7 + buffers.count + 2) * 80 + payloadBytes;
+    if(File(filepath).getSize() != expectedSize)
+    {
+        LogError() << "Unexpected archive size: " << File(filepath).getSize() << " expected: " << expectedSize;
+        return false;
+    }
+
+    VDFSArchive archive(filepath);
+    if(!archive.open() || archive.getDispersionRatio() != 0.0)
+    {
+        LogError() << "Built archive can't be opened or contains gaps!";
+        return false;
+    }
+    if(!checkFiles(archive, buffers, 0, buffers.count)) return false;
+    std::vector<char> data;
+    auto* entry = archive.getFile("Data/large.bin");
+    if(!entry || !archive.readFile(entry, data) || data != large)
+    {
+        LogError() << "Content of the large file broken!";
+        return false;
+    }
+    data.clear();
+    entry = archive.getFile("Data/replaced.bin");
+    if(!entry || !archive.readFile(entry, data) || data != buffers.contentOf(2))
+    {
+        LogError() << "Replaced file not stored with the latest content!";
+        return false;
+    }
+    return archive.getHeader().comment == "VDFS Archive built by Clipped.";
+}
+
+bool checkEmptyBuild()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    VDFSBuilder builder("testBuilderEmpty.vdfs");
+    if(!builder.build()) return false;
+    VDFSArchive archive("testBuilderEmpty.vdfs");
+    return archive.open();
+}
+
+bool checkParallelBuild()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const size_t fileCount = 100;
+    const Path filepath = "testBuilderParallel.vdfs";
+    VDFSBuilder builder(filepath);
+    builder.setWorkerCount(3);
+    for(size_t i = 0; i < fileCount; i++)
+    {
+        const Path sourcePath = String("testBuilderParallel" + String((int)i) + ".bin");
+        const std::vector<char> payload = buffers.contentOf(i);
+        BinFile source(sourcePath);
+        if(!source.open(FileAccessMode::TRUNC) || (!payload.empty() && !source.writeBytes(payload))) return false;
+        source.close();
+        builder.addFile(Path("Parallel/" + sourcePath), sourcePath);
+    }
+    builder.addFile("Parallel/missing.bin", "testBuilderMissing.bin");
+    if(builder.build())
+    {
+        LogError() << "Missing source file not detected!";
+        return false;
+    }
+
+    VDFSBuilder retry(filepath);
+    retry.setWorkerCount(3);
+    for(size_t i = 0; i < fileCount; i++)
+    {
+        const Path sourcePath = String("testBuilderParallel" + String((int)i) + ".bin");
+        retry.addFile(Path("Parallel/" + sourcePath), sourcePath);
+    }
+    if(!retry.build()) return false;
+
+    VDFSArchive archive(filepath);
+    if(!archive.open()) return false;
+    for(size_t i = 0; i < fileCount; i++)
+    {
+        if(!readsContent(archive, Path("Parallel/testBuilderParallel" + String((int)i) + ".bin"), buffers.contentOf(i)))
+            return false;
+    }
+    return true;
+}
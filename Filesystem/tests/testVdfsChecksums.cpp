@@ -0,0 +1,228 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#include "testFixture.h"
+#include <ClippedFilesystem/cFile.h>
+#include <ClippedFilesystem/cExplorer.h>
+#include <map>
+
+using namespace Clipped;
+
+bool checkChecksumTable();
+bool checkCorruption();
+bool checkMaintainedTable();
+bool checkStaleTable();
+
+int main(void)
+{
+    bool status = true;
+    Logger() << Logger::MessageType::Debug;
+
+    status &= checkChecksumTable();
+    status &= checkCorruption();
+    status &= checkMaintainedTable();
+    status &= checkStaleTable();
+
+    if(status)
+        LogInfo() << "All tests passed!";
+    else
+        LogError() << "At least one test failed!";
+    return !status; //success => true => Return code 0
+}
+
+const TestFiles files("Checked", 3, 40, 200, 97);
+const size_t fileCount = files.count;
+
+/**
+ * @brief verifyArchive verifies an archive and counts the results.
+ */
+bool verifyArchive(VDFSArchive& archive, std::map<VerifyResult, size_t>& results, std::vector<String>& corrupt)
+{
+    return archive.verify([&](const FileEntry* entry, VerifyResult result)
+    {
+        results[result]++;
+        if(VerifyResult::CORRUPT == result) corrupt.push_back(String(entry->getPath()));
+    });
+}
+
+bool createCheckedArchive(const Path& filepath, const bool checksums)
+{
+    VDFSArchive archive(filepath);
+    return archive.create() && archive.setChecksums(checksums) && writeFiles(archive, files, 0, fileCount) && archive.close();
+}
+
+bool checkChecksumTable()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const Path filepath = "testChecksums.vdfs";
+    if(!createCheckedArchive(filepath, true) || !File(VdfsChecksums::getTablePath(filepath)).exists())
+    {
+        LogError() << "No side table written!";
+        return false;
+    }
+    for(const VdfsAccessMode mode : {VdfsAccessMode::READ_WRITE, VdfsAccessMode::READ_ONLY_MAPPED})
+    {
+        VDFSArchive archive(filepath);
+        std::map<VerifyResult, size_t> results;
+        std::vector<String> corrupt;
+        if(!archive.open(mode) || !archive.getChecksums() || !verifyArchive(archive, results, corrupt) ||
+           results[VerifyResult::VALID] != fileCount || results.size() != 1)
+        {
+            LogError() << "Intact archive not verified!";
+            return false;
+        }
+    }
+
+    const Path plainpath = "testChecksumsPlain.vdfs"; //Archives without table aren't checked.
+    if(!createCheckedArchive(plainpath, false) || File(VdfsChecksums::getTablePath(plainpath)).exists()) return false;
+    VDFSArchive archive(plainpath);
+    std::map<VerifyResult, size_t> results;
+    std::vector<String> corrupt;
+    return archive.open() && !archive.getChecksums() && verifyArchive(archive, results, corrupt) &&
+           results[VerifyResult::UNCHECKED] == fileCount && results.size() == 1;
+}
+
+bool checkCorruption()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const Path filepath = "testChecksumsCorrupt.vdfs";
+    if(!createCheckedArchive(filepath, true)) return false;
+    const std::vector<char> payload = files.contentOf(17);
+    if(!patchArchive(filepath, std::string(payload.begin(), payload.end()), 100, "#", 1)) return false; //Corrupt file 17.
+
+    for(const VdfsAccessMode mode : {VdfsAccessMode::READ_WRITE, VdfsAccessMode::READ_ONLY_MAPPED})
+    {
+        VDFSArchive archive(filepath);
+        std::map<VerifyResult, size_t> results;
+        std::vector<String> corrupt;
+        if(!archive.open(mode) || verifyArchive(archive, results, corrupt) ||
+           results[VerifyResult::VALID] != fileCount - 1 || corrupt.size() != 1 || corrupt[0] != String(files.pathOf(17)))
+        {
+            LogError() << "Corrupt payload not detected!";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkMaintainedTable()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const Path filepath = "testChecksumsMaintained.vdfs";
+    if(!createCheckedArchive(filepath, false)) return false;
+    {
+        VDFSArchive archive(filepath);
+        if(!archive.open() || !archive.setChecksums(true) || !archive.close()) //Calculated for stored payloads.
+        {
+            LogError() << "Can't enable checksums!";
+            return false;
+        }
+    }
+    {
+        VDFSArchive archive(filepath);
+        if(!archive.open() || !archive.getChecksums()) return false;
+        for(size_t i = 0; i < fileCount; i += 4) //Checksums follow overwritten, removed and moved payloads.
+        {
+            if(!archive.writeFile(archive.getFile(files.pathOf(i)), files.contentOf(i, 1)) ||
+               !archive.removeFile(archive.getFile(files.pathOf(i + 1))))
+            {
+                return false;
+            }
+        }
+        if(!archive.compact() || !archive.close()) return false;
+    }
+    {
+        VDFSArchive archive(filepath);
+        std::map<VerifyResult, size_t> results;
+        std::vector<String> corrupt;
+        if(!archive.open() || !verifyArchive(archive, results, corrupt) ||
+           results[VerifyResult::VALID] != fileCount - fileCount / 4 || results.size() != 1)
+        {
+            LogError() << "Checksums not maintained!";
+            return false;
+        }
+        if(!archive.setChecksums(false) || !archive.close()) return false;
+    }
+    if(File(VdfsChecksums::getTablePath(filepath)).exists())
+    {
+        LogError() << "Side table not removed!";
+        return false;
+    }
+    return true;
+}
+
+bool checkStaleTable()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const Path filepath = "testChecksumsStale.vdfs";
+    const Path tablePath = VdfsChecksums::getTablePath(filepath);
+    const Path crashedPath = "testChecksumsCrashed.vdfs";
+    if(!createCheckedArchive(filepath, true)) return false;
+    {
+        VDFSArchive archive(filepath);
+        if(!archive.open()) return false;
+        std::vector<char> committedTable;
+        for(size_t i = 0; i < fileCount; i += 5) //Several commits. The table is only marked stale once.
+        {
+            if(!archive.writeFile(archive.getFile(files.pathOf(i)), files.contentOf(i, 2)) || !archive.finalize()) return false;
+            std::vector<char> table;
+            NativeFile file(tablePath);
+            if(!file.open(FileAccessMode::READ_ONLY)) return false;
+            table.resize(file.getSize());
+            if(!file.readAt(0, table.data(), table.size())) return false;
+            if(0 == i) committedTable = table;
+            if(table != committedTable)
+            {
+                LogError() << "Side table rewritten by a commit!";
+                return false;
+            }
+        }
+
+        //Like a crash: Only the committed state is on disk.
+        Explorer::Copy(filepath, crashedPath, false);
+        Explorer::Copy(tablePath, VdfsChecksums::getTablePath(crashedPath), false);
+        VDFSArchive crashed(crashedPath);
+        std::map<VerifyResult, size_t> results;
+        std::vector<String> corrupt;
+        if(!crashed.open(VdfsAccessMode::READ_ONLY_MAPPED) || !crashed.getChecksums() || !verifyArchive(crashed, results, corrupt) ||
+           results[VerifyResult::UNCHECKED] != fileCount || results.size() != 1)
+        {
+            LogError() << "Stale side table not treated as unknown!";
+            return false;
+        }
+        if(!archive.close()) return false;
+    }
+    VDFSArchive archive(filepath);
+    std::map<VerifyResult, size_t> results;
+    std::vector<String> corrupt;
+    if(!archive.open() || !verifyArchive(archive, results, corrupt) || results[VerifyResult::VALID] != fileCount || results.size() != 1)
+    {
+        LogError() << "Side table not written on close!";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,146 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#include "testFixture.h"
+
+using namespace Clipped;
+
+bool createFragmentedArchive(const Path& filepath);
+bool checkCompact();
+bool checkIncrementalCompact();
+
+int main(void)
+{
+    bool status = true;
+    Logger() << Logger::MessageType::Debug;
+
+    status &= checkCompact();
+    status &= checkIncrementalCompact();
+
+    if(status)
+        LogInfo() << "All tests passed!";
+    else
+        LogError() << "At least one test failed!";
+    return !status; //success => true => Return code 0
+}
+
+const TestFiles files("Dir", 3, 64, 100, 37, 700, ".bin");
+
+/**
+ * @brief createFragmentedArchive creates an archive with all files and removes every odd one afterwards.
+ */
+bool createFragmentedArchive(const Path& filepath)
+{
+    if(!createArchive(filepath, files)) return false;
+    VDFSArchive reopened(filepath);
+    if(!reopened.open()) return false;
+    for(size_t i = 1; i < files.count; i += 2)
+    {
+        auto* entry = reopened.getFile(files.pathOf(i));
+        if(!entry || !reopened.removeFile(entry)) return false;
+    }
+    return reopened.close();
+}
+
+bool checkCompact()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const Path filepath = "testCompact.vdfs";
+    if(!createFragmentedArchive(filepath))
+    {
+        LogError() << "Can't create the test archive!";
+        return false;
+    }
+
+    VDFSArchive archive(filepath);
+    if(!archive.open()) return false;
+    if(archive.getDispersionRatio() <= 0.0)
+    {
+        LogError() << "Test archive isn't fragmented!";
+        return false;
+    }
+    if(!archive.compact())
+    {
+        LogError() << "Compact failed!";
+        return false;
+    }
+    if(archive.getDispersionRatio() != 0.0)
+    {
+        LogError() << "Archive still fragmented: " << archive.getDispersionRatio();
+        return false;
+    }
+    if(!checkFiles(archive, files, 0, files.count, 2) || !archive.close()) return false;
+
+    //Header + index (3 directories, 32 files) + payloads. Nothing else:
+    size_t expectedSize = 296 + (3 + files.count / 2) * 80;
+    for(size_t i = 0; i < files.count; i += 2)
+        expectedSize += files.sizeOf(i);
+    if(File(filepath).getSize() != expectedSize)
+    {
+        LogError() << "Archive not truncated! Size: " << File(filepath).getSize() << " expected: " << expectedSize;
+        return false;
+    }
+
+    VDFSArchive reopened(filepath);
+    return reopened.open() && reopened.getDispersionRatio() == 0.0 && checkFiles(reopened, files, 0, files.count, 2);
+}
+
+bool checkIncrementalCompact()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const Path filepath = "testIncrementalCompact.vdfs";
+    if(!createFragmentedArchive(filepath))
+    {
+        LogError() << "Can't create the test archive!";
+        return false;
+    }
+
+    VDFSArchive archive(filepath);
+    if(!archive.open()) return false;
+    const size_t sizeBefore = File(filepath).getSize();
+    bool completed = false;
+    size_t steps = 0;
+    while(!completed)
+    {
+        if(!archive.compact(1024, completed) || ++steps > files.count)
+        {
+            LogError() << "Incremental compact failed in step " << steps << "!";
+            return false;
+        }
+        if(!checkFiles(archive, files, 0, files.count, 2)) return false; //Archive usable between the steps.
+    }
+    if(steps < 2)
+    {
+        LogError() << "Budget not respected!";
+        return false;
+    }
+    if(!archive.close()) return false;
+
+    VDFSArchive reopened(filepath);
+    return reopened.open() && reopened.getDispersionRatio() == 0.0 &&
+           File(filepath).getSize() < sizeBefore && checkFiles(reopened, files, 0, files.count, 2);
+}
@@ -0,0 +1,197 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#include "testFixture.h"
+#include <ClippedFilesystem/Archives/cVdfsBuilder.h>
+
+using namespace Clipped;
+
+bool checkArchive(const Path& filepath, const VdfsAccessMode mode);
+bool checkWriteCompressed();
+bool checkBuildCompressed();
+bool checkLegacyCompressedFlag();
+bool checkCorruptPayloadHeader();
+
+int main(void)
+{
+    bool status = true;
+    Logger() << Logger::MessageType::Debug;
+
+    status &= checkWriteCompressed();
+    status &= checkBuildCompressed();
+    status &= checkLegacyCompressedFlag();
+    status &= checkCorruptPayloadHeader();
+
+    if(status)
+        LogInfo() << "All tests passed!";
+    else
+        LogError() << "At least one test failed!";
+    return !status; //success => true => Return code 0
+}
+
+const TestFiles files("Compressed", 1, 12, 100, 37, 0, ".txt");
+
+/**
+ * @brief contentOf creates compressible content of file number i. Every fourth file spans several chunks.
+ */
+std::vector<char> contentOf(const size_t i)
+{
+    return i % 4 == 0 ? textOf(i, 3 * VDFSArchive::CompressionChunkSize + 17 * i) : files.contentOf(i);
+}
+
+bool checkArchive(const Path& filepath, const VdfsAccessMode mode)
+{
+    VDFSArchive archive(filepath);
+    if(!archive.open(mode)) return false;
+    for(size_t i = 0; i < files.count; i++)
+    {
+        const std::vector<char> expected = contentOf(i);
+        auto* entry = archive.getFile(files.pathOf(i));
+        if(!entry || entry->getSize() != expected.size())
+        {
+            LogError() << "Entry " << i << " missing or with wrong size!";
+            return false;
+        }
+        std::vector<char> data(1, '#'); //Read appends.
+        std::vector<char> buffer(expected.size());
+        if(!archive.readFile(entry, data) || data.size() != expected.size() + 1 ||
+           !std::equal(expected.begin(), expected.end(), data.begin() + 1) ||
+           !archive.readFile(entry, buffer.data()) || buffer != expected)
+        {
+            LogError() << "Content of entry " << i << " broken!";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkWriteCompressed()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const Path filepath = "testCompressionWrite.vdfs";
+    size_t rawBytes = 0;
+    {
+        VDFSArchive archive(filepath);
+        if(!archive.create()) return false;
+        for(size_t i = 0; i < files.count; i++)
+        {
+            archive.setCompression(i % 3 != 1); //Mixed raw and compressed entries.
+            const std::vector<char> content = contentOf(i);
+            if(!archive.writeFile(archive.createFile(files.pathOf(i)), content)) return false;
+            rawBytes += content.size();
+        }
+        if(!archive.close()) return false;
+    }
+    if(File(filepath).getSize() * 2 > rawBytes)
+    {
+        LogError() << "Archive not compressed: " << File(filepath).getSize() << " of " << rawBytes << " bytes.";
+        return false;
+    }
+    if(!checkArchive(filepath, VdfsAccessMode::READ_WRITE) || !checkArchive(filepath, VdfsAccessMode::READ_ONLY_MAPPED))
+        return false;
+
+    VDFSArchive mapped(filepath);
+    const char* data = nullptr;
+    size_t length = 0;
+    if(!mapped.open(VdfsAccessMode::READ_ONLY_MAPPED) || mapped.getFileView(mapped.getFile(files.pathOf(0)), data, length) ||
+       !mapped.getFileView(mapped.getFile(files.pathOf(1)), data, length))
+    {
+        LogError() << "File views only have to be available for raw entries!";
+        return false;
+    }
+    return true;
+}
+
+bool checkBuildCompressed()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const Path filepath = "testCompressionBuild.vdfs";
+    VDFSBuilder builder(filepath);
+    builder.setCompression(true);
+    for(size_t i = 0; i < files.count; i++)
+        builder.addBuffer(files.pathOf(i), contentOf(i));
+    if(!builder.build()) return false;
+
+    VDFSArchive archive(filepath);
+    if(!archive.open() || archive.getDispersionRatio() != 0.0) return false;
+    return checkArchive(filepath, VdfsAccessMode::READ_WRITE) && checkArchive(filepath, VdfsAccessMode::READ_ONLY_MAPPED);
+}
+
+bool checkLegacyCompressedFlag()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const Path filepath = "testCompressionLegacyFlag.vdfs";
+    const std::vector<char> content = contentOf(3);
+    {
+        VDFSArchive archive(filepath);
+        if(!archive.create() || !archive.writeFile(archive.createFile(Path("legacy.bin")), content) || !archive.close()) return false;
+    }
+    //Flag the raw payload like a file packed from a NTFS compressed directory (64 byte name, offset, size, type, attribute):
+    const uint32_t attribute = EntryAttribute::ARCHIVE | EntryAttribute::COMPRESSED;
+    if(!patchArchive(filepath, "legacy.bin", 64 + 3 * sizeof(uint32_t), &attribute, sizeof(attribute)))
+        return false;
+
+    for(const VdfsAccessMode mode : {VdfsAccessMode::READ_WRITE, VdfsAccessMode::READ_ONLY_MAPPED})
+    {
+        VDFSArchive archive(filepath);
+        std::vector<char> data, range(10);
+        FileEntry* entry = nullptr;
+        if(!archive.open(mode) || !(entry = archive.getFile(Path("legacy.bin"))) || !archive.readFile(entry, data) ||
+           data != content || !archive.readFileRange(entry, 50, range.size(), range.data()) ||
+           !std::equal(range.begin(), range.end(), content.begin() + 50))
+        {
+            LogError() << "Raw payload with compressed flag not readable!";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkCorruptPayloadHeader()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const Path filepath = "testCompressionCorruptHeader.vdfs";
+    {
+        VDFSArchive archive(filepath);
+        archive.setCompression(true);
+        if(!archive.create() || !archive.writeFile(archive.createFile(files.pathOf(0)), contentOf(0)) || !archive.close()) return false;
+    }
+    //A chunk table of billions of entries doesn't fit into the payload and must not get allocated:
+    const uint32_t corruptHeader[] = { 0xFFFFFFF0u, 1u, 0xFFFFFFF0u }; //Raw size, chunk size, chunk count.
+    if(!patchArchive(filepath, "CLZ1", sizeof(uint32_t), corruptHeader, sizeof(corruptHeader))) return false;
+
+    VDFSArchive archive(filepath);
+    std::vector<char> data;
+    FileEntry* entry = nullptr;
+    if(!archive.open() || !(entry = archive.getFile(files.pathOf(0))) || !archive.readFile(entry, data) ||
+       data.size() != entry->getSize() || data.size() >= contentOf(0).size())
+    {
+        LogError() << "Corrupt payload header not rejected!";
+        return false;
+    }
+    return true;
+}
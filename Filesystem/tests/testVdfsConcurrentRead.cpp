@@ -0,0 +1,115 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#include "testFixture.h"
+#include <atomic>
+#include <thread>
+
+using namespace Clipped;
+
+const Path archivePath = "testConcurrentRead.vdfs";
+const TestFiles files("Dir", 4, 64, 997, 997, 0, ".bin"); //Individual sizes, so mixed up reads are detected.
+const size_t threadCount = 8;
+const size_t roundsPerThread = 25;
+
+bool createTestArchive();
+bool readConcurrently(VdfsAccessMode accessMode);
+
+int main(void)
+{
+    bool status = true;
+    Logger() << Logger::MessageType::Info;
+
+    status &= createTestArchive();
+    if(status) status &= readConcurrently(VdfsAccessMode::READ_WRITE);
+    if(status) status &= readConcurrently(VdfsAccessMode::READ_ONLY_MAPPED);
+
+    if(status)
+        LogInfo() << "All tests passed!";
+    else
+        LogError() << "At least one test failed!";
+    return !status; //success => true => Return code 0
+}
+
+bool createTestArchive()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    return createArchive(archivePath, files);
+}
+
+bool readConcurrently(VdfsAccessMode accessMode)
+{
+    LogInfo() << "Testcase: " << __FUNCTION__ << " mapped: " << (VdfsAccessMode::READ_ONLY_MAPPED == accessMode);
+    VDFSArchive archive(archivePath);
+    if(!archive.open(accessMode))
+    {
+        LogError() << "Can't open archive: " << archivePath;
+        return false;
+    }
+
+    std::vector<FileEntry*> entries;
+    std::vector<std::vector<char>> expected;
+    for(size_t i = 0; i < files.count; i++)
+    {
+        entries.push_back(archive.getFile(files.pathOf(i)));
+        expected.push_back(files.contentOf(i));
+        if(!entries.back())
+        {
+            LogError() << "File not found: " << files.pathOf(i);
+            return false;
+        }
+    }
+
+    std::atomic<size_t> failures(0);
+    std::vector<std::thread> readers;
+    for(size_t t = 0; t < threadCount; t++)
+    {
+        readers.emplace_back([&, t]()
+        {
+            std::vector<char> data;
+            for(size_t round = 0; round < roundsPerThread; round++)
+            {
+                for(size_t n = 0; n < files.count; n++)
+                {
+                    const size_t i = (n * (2 * t + 1) + round) % files.count; //Thread individual order.
+                    data.clear();
+                    if(!archive.readFile(entries[i], data) || data != expected[i])
+                        failures++;
+                }
+            }
+        });
+    }
+    for(auto& reader : readers)
+        reader.join();
+
+    if(0 != failures)
+    {
+        LogError() << failures.load() << " concurrent reads returned wrong data!";
+        return false;
+    }
+    return archive.close();
+}
@@ -0,0 +1,214 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+#include "testFixture.h"
+
+using namespace Clipped;
+
+bool checkMemoryManagerReferences();
+bool checkSharedPayloads();
+bool checkCompactShared();
+bool checkOverlapNotShared();
+
+int main(void)
+{
+    bool status = true;
+    Logger() << Logger::MessageType::Debug;
+
+    status &= checkMemoryManagerReferences();
+    status &= checkSharedPayloads();
+    status &= checkCompactShared();
+    status &= checkOverlapNotShared();
+
+    if(status)
+        LogInfo() << "All tests passed!";
+    else
+        LogError() << "At least one test failed!";
+    return !status; //success => true => Return code 0
+}
+
+const TestFiles files("Shared", 1, 9, 1000, 13);
+
+/**
+ * @brief contentOf creates the content of file number i. Every third file has the same content.
+ */
+std::vector<char> contentOf(const size_t i)
+{
+    return files.contentOf(i % 3 == 0 ? 0 : i);
+}
+
+bool checkArchive(VDFSArchive& archive, const std::vector<size_t>& indices)
+{
+    for(const size_t i : indices)
+    {
+        if(!readsContent(archive, files.pathOf(i), contentOf(i))) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief sharesPayload checks, if two entries of an archive point to the same payload.
+ */
+bool sharesPayload(const Path& filepath, const size_t a, const size_t b)
+{
+    VDFSArchive archive(filepath);
+    const char* dataA = nullptr;
+    const char* dataB = nullptr;
+    size_t length = 0;
+    return archive.open(VdfsAccessMode::READ_ONLY_MAPPED) &&
+           archive.getFileView(archive.getFile(files.pathOf(a)), dataA, length) &&
+           archive.getFileView(archive.getFile(files.pathOf(b)), dataB, length) && dataA == dataB;
+}
+
+bool checkMemoryManagerReferences()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    MemoryManager manager(100);
+    if(!manager.alloc(0, 50)) return false;
+    if(manager.addReference(MemoryBlock(40, 20)) || !manager.addReference(MemoryBlock(10, 20)))
+    {
+        LogError() << "Only used memory can be shared!";
+        return false;
+    }
+    if(!manager.isShared(10) || !manager.free(10, 20) || manager.isShared(10) || manager.getFreeMemorySize() != 50)
+    {
+        LogError() << "First free of a shared block has to drop the reference only!";
+        return false;
+    }
+    if(!manager.free(10, 20) || manager.getFreeMemorySize() != 70)
+    {
+        LogError() << "Last free has to release the block!";
+        return false;
+    }
+    return true;
+}
+
+bool checkSharedPayloads()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const Path filepath = "testDedup.vdfs";
+    const Path plainpath = "testDedupPlain.vdfs";
+    for(const bool deduplication : {true, false})
+    {
+        VDFSArchive archive(deduplication ? filepath : plainpath);
+        if(!archive.create() || !archive.setDeduplication(deduplication)) return false;
+        for(size_t i = 0; i < files.count; i++)
+        {
+            if(!archive.writeFile(archive.createFile(files.pathOf(i)), contentOf(i))) return false;
+        }
+        if(!archive.close()) return false;
+    }
+    if(File(plainpath).getSize() - File(filepath).getSize() != 2 * contentOf(0).size() ||
+       !sharesPayload(filepath, 0, 3) || !sharesPayload(filepath, 0, 6) || sharesPayload(plainpath, 0, 3))
+    {
+        LogError() << "Identical payloads aren't shared!";
+        return false;
+    }
+    {
+        VDFSArchive archive(filepath);
+        if(!archive.open() || !checkArchive(archive, {0, 1, 2, 3, 4, 5, 6, 7, 8}))
+        {
+            LogError() << "Shared payloads not recognized on reopen!";
+            return false;
+        }
+        const double dispersion = archive.getDispersionRatio();
+        if(!archive.setDeduplication(true)) return false;
+        if(!archive.removeFile(archive.getFile(files.pathOf(0))) || !archive.removeFile(archive.getFile(files.pathOf(3))) ||
+           !checkArchive(archive, {1, 2, 4, 5, 6, 7, 8}) || archive.getDispersionRatio() != dispersion)
+        {
+            LogError() << "Removing entries must keep shared payloads!";
+            return false;
+        }
+        //Released payloads are referenced by the index on disk until the next commit:
+        if(!archive.removeFile(archive.getFile(files.pathOf(6))) || !archive.finalize() || archive.getDispersionRatio() <= dispersion)
+        {
+            LogError() << "Removing the last user has to release the payload!";
+            return false;
+        }
+        //Content known by setDeduplication gets shared again:
+        if(!archive.writeFile(archive.createFile(files.pathOf(0)), contentOf(1)) || !archive.close()) return false;
+    }
+    if(!sharesPayload(filepath, 0, 1))
+    {
+        LogError() << "Existing payloads not indexed by setDeduplication!";
+        return false;
+    }
+    return true;
+}
+
+bool checkCompactShared()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const Path filepath = "testDedupCompact.vdfs";
+    {
+        VDFSArchive archive(filepath);
+        if(!archive.create() || !archive.setDeduplication(true)) return false;
+        for(size_t i = 0; i < files.count; i++)
+        {
+            if(!archive.writeFile(archive.createFile(files.pathOf(i)), contentOf(i))) return false;
+        }
+        if(!archive.removeFile(archive.getFile(files.pathOf(1))) || !archive.removeFile(archive.getFile(files.pathOf(4)))) return false;
+        if(!archive.compact() || archive.getDispersionRatio() != 0.0)
+        {
+            LogError() << "Compaction with shared payloads failed!";
+            return false;
+        }
+        if(!checkArchive(archive, {0, 2, 3, 5, 6, 7, 8})) return false;
+        if(!archive.close()) return false;
+    }
+    VDFSArchive reopened(filepath);
+    return sharesPayload(filepath, 0, 6) && reopened.open() && reopened.getDispersionRatio() == 0.0 && checkArchive(reopened, {0, 2, 3, 5, 6, 7, 8});
+}
+
+bool checkOverlapNotShared()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const Path filepath = "testDedupOverlap.vdfs";
+    {
+        VDFSArchive archive(filepath);
+        if(!archive.create() || !archive.setDeduplication(true)) return false;
+        for(size_t i = 0; i < files.count; i++)
+        {
+            if(!archive.writeFile(archive.createFile(files.pathOf(i)), contentOf(i))) return false;
+        }
+        if(!archive.close()) return false;
+    }
+    //Entry 6 keeps the offset of the payload shared by 0 and 3, but covers only a part of it:
+    const uint32_t corruptSize = static_cast<uint32_t>(contentOf(0).size() / 2);
+    if(!patchArchive(filepath, "file6.dat", 64 + sizeof(uint32_t), &corruptSize, sizeof(corruptSize))) return false;
+
+    VDFSArchive archive(filepath);
+    if(!archive.open()) return false;
+    const size_t contentSize = archive.getHeader().getContentSize();
+    //Only the identical entries 0 and 3 reference the payload, so removing them has to release it:
+    if(!archive.removeFile(archive.getFile(files.pathOf(0))) || !archive.removeFile(archive.getFile(files.pathOf(3))) ||
+       archive.getHeader().getContentSize() != contentSize - contentOf(0).size())
+    {
+        LogError() << "Partially overlapping entry treated as shared payload!";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,121 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#include "testFixture.h"
+#include <ClippedFilesystem/cFile.h>
+
+using namespace Clipped;
+
+bool checkPatchedStages();
+bool checkLayoutChange();
+
+int main(void)
+{
+    bool status = true;
+    Logger() << Logger::MessageType::Debug;
+
+    status &= checkPatchedStages();
+    status &= checkLayoutChange();
+
+    if(status)
+        LogInfo() << "All tests passed!";
+    else
+        LogError() << "At least one test failed!";
+    return !status; //success => true => Return code 0
+}
+
+const TestFiles files("Stage", 4, 300, 64, 1, 50);
+
+/**
+ * @brief checkArchive checks all files. File changed is expected in version, all others in version 0.
+ */
+bool checkArchive(VDFSArchive& archive, const size_t changed, const size_t version)
+{
+    for(size_t i = 0; i < files.count; i++)
+    {
+        if(!readsContent(archive, files.pathOf(i), files.contentOf(i, i == changed ? version : 0))) return false;
+    }
+    return true;
+}
+
+bool checkPatchedStages()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const Path filepath = "testIncrementalFlush.vdfs";
+    if(!createArchive(filepath, files)) return false;
+
+    VDFSArchive archive(filepath);
+    if(!archive.open()) return false;
+    archive.setIncrementalFlush(true);
+    for(size_t version = 1; version <= 3; version++)
+    {
+        const size_t sizeBefore = File(filepath).getSize();
+        if(!archive.writeFile(archive.getFile(files.pathOf(42)), files.contentOf(42, version)) || !archive.finalize()) return false;
+        //The index got patched in place. A full rewrite would have stored a second index:
+        if(File(filepath).getSize() > sizeBefore + files.sizeOf(42))
+        {
+            LogError() << "Index rewritten in commit " << version << "! Size: " << File(filepath).getSize();
+            return false;
+        }
+        VDFSArchive reader(filepath);
+        if(!reader.open(VdfsAccessMode::READ_ONLY_MAPPED) || !checkArchive(reader, 42, version))
+        {
+            LogError() << "Patched index not readable in commit " << version << "!";
+            return false;
+        }
+    }
+    return archive.close();
+}
+
+bool checkLayoutChange()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const Path filepath = "testIncrementalFlushLayout.vdfs";
+    if(!createArchive(filepath, files)) return false;
+    {
+        VDFSArchive archive(filepath);
+        if(!archive.open()) return false;
+        archive.setIncrementalFlush(true);
+        //Added entries shift the following ones. The whole index has to be written:
+        if(!archive.writeFile(archive.createFile(Path("Stage1/added.dat")), files.contentOf(7, 1)) ||
+           !archive.writeFile(archive.getFile(files.pathOf(7)), files.contentOf(7, 2)) || !archive.finalize())
+        {
+            return false;
+        }
+        //Positions of the rewritten index are known. Patch again:
+        if(!archive.writeFile(archive.getFile(files.pathOf(9)), files.contentOf(9, 3)) ||
+           !archive.removeFile(archive.getFile(Path("Stage1/added.dat"))) || !archive.close())
+        {
+            return false;
+        }
+    }
+    VDFSArchive archive(filepath);
+    std::vector<char> first, second;
+    return archive.open() && nullptr == archive.getFile(Path("Stage1/added.dat")) &&
+           archive.readFile(archive.getFile(files.pathOf(7)), first) && first == files.contentOf(7, 2) &&
+           archive.readFile(archive.getFile(files.pathOf(9)), second) && second == files.contentOf(9, 3);
+}
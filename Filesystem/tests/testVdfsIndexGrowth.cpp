@@ -0,0 +1,104 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#include "testFixture.h"
+
+using namespace Clipped;
+
+bool checkIndexGrowth();
+bool checkSharedPayloadRelocation();
+
+int main(void)
+{
+    bool status = true;
+    Logger() << Logger::MessageType::Debug;
+
+    status &= checkIndexGrowth();
+    status &= checkSharedPayloadRelocation();
+
+    if(status)
+        LogInfo() << "All tests passed!";
+    else
+        LogError() << "At least one test failed!";
+    return !status; //success => true => Return code 0
+}
+
+const TestFiles files("Dir", 5, 4000, 16, 29, 200, ".bin");
+
+bool checkIndexGrowth()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const size_t fileCount = files.count;
+    const Path filepath = "testIndexGrowth.vdfs";
+    {
+        VDFSArchive archive(filepath);
+        //The index starts empty - All payloads behind the header have to move out of its way:
+        if(!archive.create() || !writeFiles(archive, files, 0, fileCount / 2) || !archive.close())
+        {
+            LogError() << "Can't create the test archive!";
+            return false;
+        }
+    }
+    {
+        VDFSArchive archive(filepath);
+        //The index grows again over the payloads stored by the first session:
+        if(!archive.open() || !checkFiles(archive, files, 0, fileCount / 2) ||
+           !writeFiles(archive, files, fileCount / 2, fileCount) || !archive.close())
+        {
+            LogError() << "Can't extend the test archive!";
+            return false;
+        }
+    }
+    VDFSArchive archive(filepath);
+    return archive.open() && checkFiles(archive, files, 0, fileCount);
+}
+
+bool checkSharedPayloadRelocation()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const size_t fileCount = 500;
+    const Path filepath = "testSharedRelocation.vdfs";
+    {
+        VDFSArchive archive(filepath);
+        if(!archive.create() || !archive.setDeduplication(true)) return false;
+        for(size_t i = 0; i < fileCount; i++) //Every payload is stored once and shared by two entries.
+        {
+            auto* entry = archive.createFile(files.pathOf(i));
+            auto* copy = archive.createFile(Path("Copies/" + String(files.pathOf(i))));
+            if(!entry || !copy || !archive.writeFile(entry, files.contentOf(i)) || !archive.writeFile(copy, files.contentOf(i))) return false;
+        }
+        if(!archive.close()) return false;
+    }
+
+    VDFSArchive archive(filepath);
+    if(!archive.open() || !checkFiles(archive, files, 0, fileCount)) return false;
+    for(size_t i = 0; i < fileCount; i++)
+    {
+        if(!readsContent(archive, Path("Copies/" + String(files.pathOf(i))), files.contentOf(i))) return false;
+    }
+    return true;
+}
@@ -0,0 +1,188 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#include "testFixture.h"
+#include <ClippedFilesystem/cFile.h>
+
+using namespace Clipped;
+
+bool checkPeriodicFinalize();
+bool checkInterruptedSession();
+bool checkSpaceReuse();
+
+int main(void)
+{
+    bool status = true;
+    Logger() << Logger::MessageType::Debug;
+
+    status &= checkPeriodicFinalize();
+    status &= checkInterruptedSession();
+    status &= checkSpaceReuse();
+
+    if(status)
+        LogInfo() << "All tests passed!";
+    else
+        LogError() << "At least one test failed!";
+    return !status; //success => true => Return code 0
+}
+
+const TestFiles files("Journal", 1, 20, 500, 17);
+
+/**
+ * @brief checkFile checks, if file i exists in the given version. A negative version expects no such file.
+ */
+bool checkFile(VDFSArchive& archive, const size_t i, const int version = 0)
+{
+    if(0 > version) return nullptr == archive.getFile(files.pathOf(i));
+    return readsContent(archive, files.pathOf(i), files.contentOf(i, static_cast<size_t>(version)));
+}
+
+/**
+ * @brief snapshot copies the archive file, like it would be found after a crash.
+ */
+bool snapshot(const Path& filepath, const Path& snapshotpath)
+{
+    File target(snapshotpath);
+    if(target.exists() && !target.remove()) return false;
+    return File(filepath).copy(snapshotpath);
+}
+
+bool checkPeriodicFinalize()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const Path filepath = "testJournalPeriodic.vdfs";
+    VDFSArchive archive(filepath);
+    if(!archive.create()) return false;
+    for(size_t i = 0; i < 20; i++)
+    {
+        if(!archive.writeFile(archive.createFile(files.pathOf(i)), files.contentOf(i))) return false;
+        if(i % 5 != 4) continue;
+        if(!archive.finalize()) //Commit every fifth file. The archive stays open.
+        {
+            LogError() << "Finalize failed after file " << i << "!";
+            return false;
+        }
+        VDFSArchive reader(filepath);
+        if(!reader.open(VdfsAccessMode::READ_ONLY_MAPPED) || !checkFile(reader, i) || !checkFile(reader, i + 1, -1))
+        {
+            LogError() << "Committed state after file " << i << " not readable!";
+            return false;
+        }
+    }
+    for(size_t i = 0; i < 20; i++)
+    {
+        if(!checkFile(archive, i))
+        {
+            LogError() << "File " << i << " broken after periodic finalize!";
+            return false;
+        }
+    }
+    return archive.close();
+}
+
+bool checkInterruptedSession()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const Path filepath = "testJournalInterrupted.vdfs";
+    const Path crashpath = "testJournalInterruptedCrash.vdfs";
+    {
+        VDFSArchive archive(filepath);
+        if(!archive.create()) return false;
+        if(!writeFiles(archive, files, 0, 10) || !archive.close()) return false;
+    }
+
+    VDFSArchive archive(filepath);
+    if(!archive.open()) return false;
+    for(size_t i = 0; i < 10; i += 2) //Overwrite, remove and add files. Not committed yet.
+    {
+        if(!archive.writeFile(archive.getFile(files.pathOf(i)), files.contentOf(i, 1))) return false;
+        if(!archive.removeFile(archive.getFile(files.pathOf(i + 1)))) return false;
+        if(!archive.writeFile(archive.createFile(files.pathOf(i + 10)), files.contentOf(i + 10))) return false;
+    }
+    if(!snapshot(filepath, crashpath)) return false;
+    {
+        VDFSArchive crashed(crashpath);
+        if(!crashed.open()) return false;
+        for(size_t i = 0; i < 10; i++)
+        {
+            if(!checkFile(crashed, i) || !checkFile(crashed, i + 10, -1))
+            {
+                LogError() << "Last committed state of file " << i << " lost!";
+                return false;
+            }
+        }
+    }
+
+    if(!archive.finalize() || !snapshot(filepath, crashpath)) return false;
+    VDFSArchive crashed(crashpath);
+    if(!crashed.open()) return false;
+    for(size_t i = 0; i < 10; i += 2)
+    {
+        if(!checkFile(crashed, i, 1) || !checkFile(crashed, i + 1, -1) || !checkFile(crashed, i + 10))
+        {
+            LogError() << "Committed modification of file " << i << " lost!";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkSpaceReuse()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const Path filepath = "testJournalReuse.vdfs";
+    VDFSArchive archive(filepath);
+    if(!archive.create()) return false;
+    if(!writeFiles(archive, files, 0, 10) || !archive.finalize()) return false;
+    const size_t initialSize = File(filepath).getSize();
+
+    for(size_t version = 1; version < 50; version++) //Released payloads and indices get reused by later commits.
+    {
+        if(!archive.writeFile(archive.getFile(files.pathOf(version % 10)), files.contentOf(version % 10, version)) ||
+           !archive.finalize())
+        {
+            return false;
+        }
+    }
+    const size_t indexSize = 11 * 80; //One directory and ten files.
+    //Committed and pending versions of the index and a payload coexist. Plus some fragmentation:
+    const size_t maximumSize = initialSize + 4 * (files.sizeOf(9) + indexSize);
+    if(File(filepath).getSize() > maximumSize)
+    {
+        LogError() << "Released memory not reused! Size: " << File(filepath).getSize() << " maximum: " << maximumSize;
+        return false;
+    }
+    for(size_t i = 0; i < 10; i++)
+    {
+        if(!checkFile(archive, i, static_cast<int>(40 + i))) //Last version written of file i.
+        {
+            LogError() << "File " << i << " broken after repeated commits!";
+            return false;
+        }
+    }
+    return archive.close();
+}
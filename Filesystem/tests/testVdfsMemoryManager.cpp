@@ -0,0 +1,188 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#include <ClippedUtils/cLogger.h>
+#include <ClippedFilesystem/Archives/cVdfsArchive.h>
+
+using namespace Clipped;
+
+bool checkBestFit();
+bool checkCoalescing();
+bool checkExpandLastFreeBlock();
+bool checkAllocAtOffset();
+bool checkAppendBehindFreeEnd();
+
+int main(void)
+{
+    bool status = true;
+    Logger() << Logger::MessageType::Debug;
+
+    status &= checkBestFit();
+    status &= checkCoalescing();
+    status &= checkExpandLastFreeBlock();
+    status &= checkAllocAtOffset();
+    status &= checkAppendBehindFreeEnd();
+
+    if(status)
+        LogInfo() << "All tests passed!";
+    else
+        LogError() << "At least one test failed!";
+    return !status; //success => true => Return code 0
+}
+
+bool checkBestFit()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    MemoryManager manager;
+    MemoryBlock a, b, c, d, e, result;
+    manager.alloc(100, a);
+    manager.alloc(10, b);
+    manager.alloc(30, c);
+    manager.alloc(10, d);
+    manager.alloc(20, e);
+    manager.free(a); //Gap of 100 bytes.
+    manager.free(c); //Gap of 30 bytes.
+
+    if(!manager.alloc(25, result) || result.offset != c.offset)
+    {
+        LogError() << "Smallest fitting gap not used! Got offset: " << result.offset << " expected: " << c.offset;
+        return false;
+    }
+    if(manager.getFreeMemorySize() != 105 || manager.getFreeMemoryBlockCount() != 2)
+    {
+        LogError() << "Unexpected free memory: " << manager.getFreeMemorySize() << " in " << manager.getFreeMemoryBlockCount() << " blocks.";
+        return false;
+    }
+    return true;
+}
+
+bool checkCoalescing()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    MemoryManager manager;
+    MemoryBlock blocks[5];
+    for(auto& block : blocks)
+        manager.alloc(16, block);
+
+    manager.free(blocks[1]);
+    manager.free(blocks[3]);
+    manager.free(blocks[2]); //Joins both neighbours.
+    if(manager.getFreeMemoryBlockCount() != 1 || manager.getFreeMemorySize() != 48)
+    {
+        LogError() << "Adjacent free blocks not combined!";
+        return false;
+    }
+    if(manager.free(blocks[2]))
+    {
+        LogError() << "Double free not detected!";
+        return false;
+    }
+    if(manager.getDispersionRatio() != 48.0 / 80.0)
+    {
+        LogError() << "Unexpected dispersion ratio: " << manager.getDispersionRatio();
+        return false;
+    }
+    return true;
+}
+
+bool checkExpandLastFreeBlock()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    MemoryManager manager;
+    MemoryBlock a, b, result;
+    manager.alloc(10, a);
+    manager.alloc(10, b);
+    manager.free(b); //Free block at the end of the handled memory.
+
+    if(!manager.alloc(30, result) || result.offset != b.offset || manager.getHandledMemorySize() != 40)
+    {
+        LogError() << "Last free block not expanded! Got offset: " << result.offset << " handled: " << manager.getHandledMemorySize();
+        return false;
+    }
+
+    manager.free(a); //Free block in front of used memory can't be expanded.
+    if(!manager.alloc(20, result) || result.offset != 40)
+    {
+        LogError() << "Used memory overlapped! Got offset: " << result.offset;
+        return false;
+    }
+    return true;
+}
+
+bool checkAllocAtOffset()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    MemoryManager manager(100);
+    if(!manager.alloc(20, 10) || manager.getFreeMemoryBlockCount() != 2)
+    {
+        LogError() << "Alloc inside a free block failed!";
+        return false;
+    }
+    if(manager.alloc(25, 10))
+    {
+        LogError() << "Alloc of used memory succeeded!";
+        return false;
+    }
+    if(!manager.alloc(120, 10) || manager.getHandledMemorySize() != 130 || manager.getFreeMemorySize() != 110)
+    {
+        LogError() << "Alloc behind handled memory failed!";
+        return false;
+    }
+    if(manager.getFreeMemoryBlockCount() != 2)
+    {
+        LogError() << "Gap in front of new memory not combined with the last free block!";
+        return false;
+    }
+    return true;
+}
+
+bool checkAppendBehindFreeEnd()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    MemoryManager manager;
+    manager.setAllocationPolicy(AllocationPolicy::APPEND_ONLY);
+    MemoryBlock a, b, result;
+    manager.alloc(10, a);
+    manager.alloc(100, b);
+    manager.free(b); //Free block at the end, larger than the following allocations.
+
+    for(const size_t size : {30u, 200u})
+    {
+        const size_t handled = manager.getHandledMemorySize();
+        if(!manager.alloc(size, result) || result.offset != handled || manager.getHandledMemorySize() != handled + size)
+        {
+            LogError() << "Not appended! Got offset: " << result.offset << " handled: " << manager.getHandledMemorySize();
+            return false;
+        }
+    }
+    if(manager.getFreeMemorySize() != 100 || manager.getFreeMemoryBlockCount() != 1)
+    {
+        LogError() << "Free block reused by append only policy!";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,141 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#include "testFixture.h"
+#include <ClippedFilesystem/cFile.h>
+
+using namespace Clipped;
+
+bool checkSizeUpdated();
+bool checkSpaceReleased();
+bool checkSharedPayloadKept();
+
+int main(void)
+{
+    bool status = true;
+    Logger() << Logger::MessageType::Debug;
+
+    status &= checkSizeUpdated();
+    status &= checkSpaceReleased();
+    status &= checkSharedPayloadKept();
+
+    if(status)
+        LogInfo() << "All tests passed!";
+    else
+        LogError() << "At least one test failed!";
+    return !status; //success => true => Return code 0
+}
+
+/**
+ * @brief contentOf creates size bytes of content, that differ by variant.
+ */
+std::vector<char> contentOf(const size_t size, const char variant)
+{
+    return textOf(static_cast<size_t>(variant), size);
+}
+
+bool checkSizeUpdated()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const Path filepath = "testOverwriteSize.vdfs";
+    {
+        VDFSArchive archive(filepath);
+        if(!archive.create()) return false;
+        for(const size_t size : {500u, 120u, 3000u})
+        {
+            for(const bool compressed : {false, true})
+            {
+                archive.setCompression(compressed);
+                FileEntry* entry = archive.createFile(Path("Dir/entry.bin"));
+                if(!archive.writeFile(entry, contentOf(size, 'a')) || !readsContent(archive, Path("Dir/entry.bin"), contentOf(size, 'a')))
+                {
+                    LogError() << "Size not updated after overwriting with " << size << " bytes!";
+                    return false;
+                }
+            }
+        }
+        if(!archive.close()) return false;
+    }
+    VDFSArchive archive(filepath);
+    return archive.open() && readsContent(archive, Path("Dir/entry.bin"), contentOf(3000, 'a'));
+}
+
+bool checkSpaceReleased()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const Path filepath = "testOverwriteSpace.vdfs";
+    VDFSArchive archive(filepath);
+    if(!archive.create() || !archive.writeFile(archive.createFile(Path("kept.bin")), contentOf(1000, 'k'))) return false;
+    size_t sizeAfterFirstRound = 0;
+    for(size_t round = 0; round < 20; round++)
+    {
+        if(!archive.writeFile(archive.createFile(Path("entry.bin")), contentOf(1000, static_cast<char>('a' + round % 5))) ||
+           !archive.finalize())
+        {
+            return false;
+        }
+        if(archive.getHeader().getContentSize() != 2000)
+        {
+            LogError() << "Overwritten payload still counted! Content size: " << archive.getHeader().getContentSize();
+            return false;
+        }
+        if(0 == round) sizeAfterFirstRound = File(filepath).getSize();
+    }
+    //Released payloads get reused. Without releasing, the archive would grow by 20 payloads:
+    if(File(filepath).getSize() > sizeAfterFirstRound + 2 * 1000 + 2 * 3 * 80)
+    {
+        LogError() << "Overwritten payloads not reused! Size: " << File(filepath).getSize() << " of " << sizeAfterFirstRound;
+        return false;
+    }
+    return readsContent(archive, Path("kept.bin"), contentOf(1000, 'k')) && archive.close();
+}
+
+bool checkSharedPayloadKept()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const Path filepath = "testOverwriteShared.vdfs";
+    VDFSArchive archive(filepath);
+    if(!archive.create() || !archive.setDeduplication(true)) return false;
+    if(!archive.writeFile(archive.createFile(Path("first.bin")), contentOf(800, 's')) ||
+       !archive.writeFile(archive.createFile(Path("second.bin")), contentOf(800, 's')) ||
+       archive.getHeader().getContentSize() != 800)
+    {
+        LogError() << "Identical payloads not shared!";
+        return false;
+    }
+    //Overwriting one entry must keep the payload of the other:
+    if(!archive.writeFile(archive.getFile(Path("first.bin")), contentOf(300, 'n')) ||
+       archive.getHeader().getContentSize() != 1100 || !readsContent(archive, Path("second.bin"), contentOf(800, 's')) ||
+       !archive.close())
+    {
+        LogError() << "Shared payload lost on overwrite!";
+        return false;
+    }
+    VDFSArchive reopened(filepath);
+    return reopened.open() && readsContent(reopened, Path("first.bin"), contentOf(300, 'n')) &&
+           readsContent(reopened, Path("second.bin"), contentOf(800, 's'));
+}
@@ -0,0 +1,136 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+#include <ClippedUtils/cLogger.h>
+#include <ClippedFilesystem/Archives/cVdfsArchive.h>
+
+using namespace Clipped;
+
+bool checkLeastRecentlyUsed();
+bool checkArchiveCache();
+
+int main(void)
+{
+    bool status = true;
+    Logger() << Logger::MessageType::Debug;
+
+    status &= checkLeastRecentlyUsed();
+    status &= checkArchiveCache();
+
+    if(status)
+        LogInfo() << "All tests passed!";
+    else
+        LogError() << "At least one test failed!";
+    return !status; //success => true => Return code 0
+}
+
+SharedFileContent bytes(const size_t count)
+{
+    return std::make_shared<const std::vector<char>>(count, 'c');
+}
+
+bool checkLeastRecentlyUsed()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    FileEntry a, b, c;
+    SharedFileContent content;
+    PayloadCache cache(0);
+    cache.insert(&a, bytes(10));
+    if(cache.get(&a, content) || cache.getMisses() != 0 || cache.getCachedBytes() != 0)
+    {
+        LogError() << "Disabled cache has to stay empty!";
+        return false;
+    }
+
+    cache.setSize(100);
+    cache.insert(&a, bytes(40));
+    cache.insert(&b, bytes(40));
+    if(!cache.get(&a, content) || content->size() != 40) return false; //b is least recently used now.
+    cache.insert(&c, bytes(40));
+    if(cache.get(&b, content) || !cache.get(&a, content) || !cache.get(&c, content) || cache.getCachedBytes() != 80)
+    {
+        LogError() << "Least recently used entry not dropped!";
+        return false;
+    }
+    cache.insert(&b, bytes(101));
+    cache.invalidate(&a);
+    if(cache.get(&b, content) || cache.get(&a, content) || cache.getCachedBytes() != 40 ||
+       cache.getHits() != 3 || cache.getMisses() != 3)
+    {
+        LogError() << "Unexpected cache state: " << cache.getHits() << " hits, " << cache.getMisses() << " misses.";
+        return false;
+    }
+    return true;
+}
+
+bool checkArchiveCache()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    const Path filepath = "testVdfsPayloadCache.vdfs";
+    const std::vector<char> hot(5000, 'h');
+    const std::vector<char> cold(7000, 'c');
+    VDFSArchive archive(filepath);
+    if(!archive.create()) return false;
+    archive.setCompression(true);
+    if(!archive.writeFile(archive.createFile("hot.cfg"), hot) || !archive.writeFile(archive.createFile("cold.cfg"), cold))
+        return false;
+    archive.setPayloadCacheSize(1024 * 1024);
+
+    SharedFileContent first, second;
+    std::vector<char> data;
+    if(!archive.readFileShared(archive.getFile("hot.cfg"), first) || !archive.readFileShared(archive.getFile("hot.cfg"), second) ||
+       first != second || *first != hot || !archive.readFile(archive.getFile("hot.cfg"), data) || data != hot)
+    {
+        LogError() << "Cached reads broken!";
+        return false;
+    }
+    const PayloadCache& cache = archive.getPayloadCache();
+    if(cache.getHits() != 2 || cache.getMisses() != 1)
+    {
+        LogError() << "Unexpected counters: " << cache.getHits() << " hits, " << cache.getMisses() << " misses.";
+        return false;
+    }
+
+    const std::vector<char> changed(3000, 'x');
+    if(!archive.writeFile(archive.getFile("hot.cfg"), changed) || !archive.readFileShared(archive.getFile("hot.cfg"), second) ||
+       *second != changed || *first != hot)
+    {
+        LogError() << "writeFile has to invalidate the cached entry!";
+        return false;
+    }
+    if(!archive.readFileShared(archive.getFile("cold.cfg"), first) || !archive.removeFile(archive.getFile("cold.cfg")) ||
+       cache.getCachedBytes() != changed.size())
+    {
+        LogError() << "removeFile has to invalidate the cached entry!";
+        return false;
+    }
+    if(!archive.close() || cache.getCachedBytes() != 0)
+    {
+        LogError() << "Closing has to clear the cache!";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,157 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+#include "testFixture.h"
+#include <atomic>
+
+using namespace Clipped;
+
+bool checkPrefetchFutures();
+bool checkPrefetchCache();
+bool checkPrefetchCanceledByWrite();
+
+int main(void)
+{
+    bool status = true;
+    Logger() << Logger::MessageType::Debug;
+
+    status &= checkPrefetchFutures();
+    status &= checkPrefetchCache();
+    status &= checkPrefetchCanceledByWrite();
+
+    if(status)
+        LogInfo() << "All tests passed!";
+    else
+        LogError() << "At least one test failed!";
+    return !status; //success => true => Return code 0
+}
+
+const TestFiles files("Prefetch", 1, 20, 10000, 100);
+const Path filepath = "testVdfsPrefetch.vdfs";
+const size_t fileCount = files.count;
+
+bool createPrefetchArchive()
+{
+    VDFSArchive archive(filepath);
+    if(!archive.create()) return false;
+    for(size_t i = 0; i < fileCount; i++)
+    {
+        archive.setCompression(i % 2 == 0);
+        if(!writeFiles(archive, files, i, i + 1)) return false;
+    }
+    return archive.close();
+}
+
+std::vector<const FileEntry*> reversedEntries(VDFSArchive& archive)
+{
+    std::vector<const FileEntry*> entries;
+    for(size_t i = fileCount; i > 0; i--)
+        entries.push_back(archive.getFile(files.pathOf(i - 1)));
+    return entries;
+}
+
+bool checkPrefetchFutures()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    if(!createPrefetchArchive()) return false;
+    for(const auto mode : {VdfsAccessMode::READ_WRITE, VdfsAccessMode::READ_ONLY_MAPPED})
+    {
+        VDFSArchive archive(filepath);
+        if(!archive.open(mode)) return false;
+        std::atomic<size_t> callbacks(0);
+        auto futures = archive.prefetch(reversedEntries(archive), [&callbacks](const FileEntry*, const PrefetchedFile& content)
+        {
+            if(content) callbacks++;
+        });
+        if(futures.size() != fileCount) return false;
+        for(size_t i = 0; i < fileCount; i++)
+        {
+            const PrefetchedFile content = futures[fileCount - 1 - i].get();
+            if(!content || *content != files.contentOf(i))
+            {
+                LogError() << "Prefetched content of entry " << i << " broken!";
+                return false;
+            }
+        }
+        if(callbacks != fileCount)
+        {
+            LogError() << "Expected " << fileCount << " callbacks, got " << callbacks << "!";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkPrefetchCache()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    VDFSArchive archive(filepath);
+    if(!archive.open(VdfsAccessMode::READ_ONLY_MAPPED)) return false;
+    const size_t budget = files.sizeOf(fileCount - 1) * 3;
+    archive.setPrefetchCacheSize(budget);
+    auto futures = archive.prefetch(reversedEntries(archive));
+    for(auto& future : futures)
+        future.wait();
+    if(archive.getPrefetchCachedBytes() == 0 || archive.getPrefetchCachedBytes() > budget)
+    {
+        LogError() << "Prefetch cache not bounded: " << archive.getPrefetchCachedBytes() << " of " << budget << " bytes.";
+        return false;
+    }
+    if(!checkFiles(archive, files, 0, fileCount)) return false; //Cached and uncached files have to be read correctly.
+    if(archive.getPrefetchCachedBytes() != 0)
+    {
+        LogError() << "Read files have to leave the prefetch cache!";
+        return false;
+    }
+    return true;
+}
+
+bool checkPrefetchCanceledByWrite()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    VDFSArchive archive(filepath);
+    if(!archive.open()) return false;
+    auto futures = archive.prefetch(reversedEntries(archive));
+    futures.front().wait();
+    const std::vector<char> replaced(5000, 'x');
+    if(!archive.writeFile(archive.getFile(files.pathOf(fileCount - 1)), replaced)) return false;
+    if(archive.getPrefetchCachedBytes() != 0)
+    {
+        LogError() << "Modifying calls have to clear the prefetch cache!";
+        return false;
+    }
+    for(auto& future : futures) //Every future is completed: Either read or canceled.
+    {
+        if(future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+    }
+    std::vector<char> data;
+    if(!archive.readFile(archive.getFile(files.pathOf(fileCount - 1)), data) || data != replaced)
+    {
+        LogError() << "Stale prefetched content returned!";
+        return false;
+    }
+    return archive.close();
+}
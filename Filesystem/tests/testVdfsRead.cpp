@@ -27,6 +27,7 @@
 
 #include <ClippedUtils/cLogger.h>
 #include <ClippedFilesystem/Archives/cVdfsArchive.h>
+#include <algorithm>
 
 using namespace Clipped;
 
@@ -36,6 +37,7 @@ bool addAFile(VDFSArchive& archive);
 bool removeAFile(VDFSArchive& archive);
 bool checkEmptyDirGetsRemoved(VDFSArchive& archive);
 bool checkSearchFile(VDFSArchive& archive);
+bool checkMappedRead(VDFSArchive& archive);
 
 int main(void)
 {
@@ -53,6 +55,7 @@ int main(void)
     status &= removeAFile(vdfsArchiver);
     status &= checkEmptyDirGetsRemoved(vdfsArchiver);
     status &= checkSearchFile(vdfsArchiver);
+    status &= checkMappedRead(vdfsArchiver);
 
     status &= vdfsArchiver.close();
 
@@ -274,7 +277,41 @@ bool checkEmptyDirGetsRemoved(VDFSArchive& archive)
         return false;
     }
 
-    return true;
+    //Remove the only file of a directory. The directory gets pruned on close:
+    const Path emptiedFile = Path("Level1/Level2/testfile2.txt").toUpper();
+    size_t entryCount = 0;
+    {
+        VDFSArchive emptyDirArchive(emptyDirTestFilepath);
+        if(!emptyDirArchive.open() || !emptyDirArchive.removeFile(emptyDirArchive.getFile(emptiedFile)) ||
+           !emptyDirArchive.close())
+        {
+            LogError() << "Removing " << emptiedFile << " failed!";
+            return false;
+        }
+        entryCount = emptyDirArchive.getHeader().getEntryCount();
+    }
+
+    //The header has to describe the pruned index:
+    VDFSArchive emptyDirArchive(emptyDirTestFilepath);
+    if(!emptyDirArchive.open())
+    {
+        LogError() << "Can't reopen archive with pruned directory: " << emptyDirTestFilepath;
+        return false;
+    }
+    size_t fileCount = 0;
+    for(FileEntry& entry : emptyDirArchive.listFiles())
+    {
+        (void)entry;
+        fileCount++;
+    }
+    if(emptyDirArchive.getFile(emptiedFile) || !emptyDirArchive.getFile(Path("Level1/Level1.2/testfile1.2.txt").toUpper()) ||
+       emptyDirArchive.getHeader().getEntryCount() != entryCount || emptyDirArchive.getHeader().getFileCount() != fileCount)
+    {
+        LogError() << "Index with pruned directory broken! Entries: " << emptyDirArchive.getHeader().getEntryCount()
+                   << ", files: " << emptyDirArchive.getHeader().getFileCount() << "/" << fileCount;
+        return false;
+    }
+    return emptyDirArchive.close();
 }
 
 bool checkSearchFile(VDFSArchive& archive)
@@ -300,3 +337,59 @@ bool checkSearchFile(VDFSArchive& archive)
 
     return result;
 }
+
+bool checkMappedRead(VDFSArchive& archive)
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    Path filepath = "Level1/Level2/testfile2.txt";
+
+    VDFSArchive mappedArchive(archive.getBasePath());
+    if(!mappedArchive.open(VdfsAccessMode::READ_ONLY_MAPPED))
+    {
+        LogError() << "Can't open archive mapped: " << mappedArchive.getBasePath();
+        return false;
+    }
+
+    FileEntry* streamEntry = archive.getFile(filepath.toUpper());
+    FileEntry* mappedEntry = mappedArchive.getFile(filepath.toUpper());
+    if(!streamEntry || !mappedEntry)
+    {
+        LogError() << "Entry: " << filepath << " not found in the archive!";
+        return false;
+    }
+
+    std::vector<char> expected;
+    if(!archive.readFile(streamEntry, expected))
+    {
+        LogError() << "Read file from vdfs failed!";
+        return false;
+    }
+
+    const char* data = nullptr;
+    size_t length = 0;
+    if(!mappedArchive.getFileView(mappedEntry, data, length))
+    {
+        LogError() << "Can't get a view of: " << filepath;
+        return false;
+    }
+    if(length != expected.size() || !std::equal(expected.begin(), expected.end(), data))
+    {
+        LogError() << "Mapped content differs from read content!";
+        return false;
+    }
+
+    std::vector<char> copied;
+    if(!mappedArchive.readFile(mappedEntry, copied) || copied != expected)
+    {
+        LogError() << "Read from mapped archive differs from read content!";
+        return false;
+    }
+
+    if(nullptr != mappedArchive.createFile("ReadOnly.txt"))
+    {
+        LogError() << "Mapped archive accepted a new file, but it is read only!";
+        return false;
+    }
+
+    return mappedArchive.close();
+}
@@ -70,6 +70,7 @@ namespace Clipped
         T finalXOR;                 //!< Final XOR operation.
         T generator;                //!< Generator polynom used for calculation.
         std::vector<T> lookupTable; //!< Lookup table with precalculations.
+        std::vector<T> reflectedTable; //!< Mirrored slicing-by-8 tables, if input and result are reflected. Empty otherwise.
 
         /**
          * @brief calculateTable fills the lookup table with precalculated data as performance optimization.
@@ -16,17 +16,37 @@ CRC<T>::CRC(const T generator, const T init, const T finalXOR, const bool reflec
     , name(name)
 {
     calculateTable();
+    begin();
 }
 
 template <class T>
 void CRC<T>::begin()
 {
-    crc = init;
+    crc = reflectedTable.empty() ? init : reflect(init);
 }
 
 template <class T>
 void CRC<T>::update(const uint8_t* data, size_t length)
 {
+    if(!reflectedTable.empty()) //Register kept reflected: Input bytes don't need to be mirrored.
+    {
+        const T* table = reflectedTable.data();
+        for(; length >= 8; data += 8, length -= 8) //Slicing by 8: One lookup per byte, but independent of each other.
+        {
+            T next = 0;
+            for(size_t j = 0; j < 8; j++)
+            {
+                const uint8_t dataByte = j < sizeof(T) ? static_cast<uint8_t>(data[j] ^ (crc >> (8 * j))) : data[j];
+                next ^= table[(7 - j) * 256 + dataByte];
+            }
+            crc = next;
+        }
+        for(size_t i = 0; i < length; i++)
+        {
+            crc = static_cast<T>((crc >> 8) ^ table[static_cast<uint8_t>(crc ^ data[i])]);
+        }
+        return;
+    }
     for(size_t i = 0; i < length; i++)
     {
         uint8_t dataByte = data[i];
@@ -48,7 +68,7 @@ void CRC<T>::update(const std::vector<uint8_t>& data)
 template <class T>
 T CRC<T>::finish()
 {
-    if(reflectResult)
+    if(reflectResult && reflectedTable.empty())
     {
         crc = reflect(crc);
     }
@@ -77,6 +97,20 @@ void CRC<T>::calculateTable()
         }
         lookupTable.push_back(currentByte);
     }
+
+    if(reflectInput && reflectResult) //Mirrored table for the reflected register.
+    {
+        reflectedTable.resize(8 * 256);
+        for(size_t i = 0; i < 256; i++)
+        {
+            reflectedTable[i] = reflect(lookupTable[reflect(static_cast<uint8_t>(i))]);
+        }
+        for(size_t i = 256; i < reflectedTable.size(); i++) //Table k advances a byte through k more zero bytes.
+        {
+            const T previous = reflectedTable[i - 256];
+            reflectedTable[i] = static_cast<T>((previous >> 8) ^ reflectedTable[static_cast<uint8_t>(previous)]);
+        }
+    }
 }
 
 // Please compile template class for the following types:
@@ -40,6 +40,7 @@ int main(void)
     { CRC16CCITTFALSE crc;  result &= test("123456789", (uint16_t)0x29B1, crc); }
     { CRC32 crc(0x04C11DB7, 0xFFFFFFFFu, 0xFFFFFFFFu, true, true); result &= test("123456789", (uint32_t)0xCBF43926u, crc); }
     { CRC32BZip2 crc;   result &= test("123456789", (uint32_t)0xFC891918u, crc); }
+    { CRC32ISCSI crc;   result &= test("123456789", (uint32_t)0xE3069283u, crc); }
     { CRC64ECMA182 crc;   result &= test("123456789", (uint64_t)0x6c40df5f0b497347u, crc); }
     { CRC64XZ crc;   result &= test("123456789", (uint64_t)0x995dc9bbdf1939fa, crc); }
 
@@ -0,0 +1,96 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+/** \file cLzCodec
+ * A small self-contained LZ77 block codec (LZ4 like sequence format).
+ * A block consists of sequences. Each sequence starts with a token byte, holding the literal length
+ * in the high and the match length in the low nibble, followed by optional length extension bytes,
+ * the literals, a 16 bit little endian match offset and optional match length extension bytes.
+ * The last sequence only contains literals.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace Clipped
+{
+    /**
+     * @brief The LzCodec class compresses and decompresses memory blocks.
+     *   Matches reference at most 64 KiB back, so blocks should be processed in chunks of that size.
+     *   All functions are stateless and may be called concurrently.
+     */
+    class LzCodec
+    {
+    public:
+        /**
+         * @brief getMaxCompressedSize calculates the maximum size of a compressed block (worst case).
+         * @param sourceSize amount of bytes to compress.
+         * @return amount of bytes, a destination buffer needs to compress any block of sourceSize.
+         */
+        static size_t getMaxCompressedSize(const size_t sourceSize);
+
+        /**
+         * @brief compress compresses a block.
+         * @param source data to compress.
+         * @param sourceSize amount of bytes to compress.
+         * @param dest buffer to store the compressed block in.
+         * @param destCapacity size of dest in bytes.
+         * @param compressedSize amount of bytes written to dest.
+         * @return true, if the block has been compressed. False, if dest is too small.
+         */
+        static bool compress(const char* source, const size_t sourceSize,
+                             char* dest, const size_t destCapacity, size_t& compressedSize);
+
+        /**
+         * @brief compress compresses a block and appends it to dest.
+         * @param source data to compress.
+         * @param sourceSize amount of bytes to compress.
+         * @param dest container to append the compressed block to.
+         * @return true, if the block has been compressed.
+         */
+        static bool compress(const char* source, const size_t sourceSize, std::vector<char>& dest);
+
+        /**
+         * @brief decompress decompresses a block.
+         * @param source compressed block.
+         * @param sourceSize size of the compressed block in bytes.
+         * @param dest buffer to store the decompressed data in.
+         * @param destSize exact size of the decompressed data.
+         * @return true, if the block has been decompressed to exactly destSize bytes. False if it's corrupt.
+         */
+        static bool decompress(const char* source, const size_t sourceSize, char* dest, const size_t destSize);
+
+        static const size_t MaxDistance;    //!< Maximum distance of a match in bytes.
+
+    private:
+        static const size_t MinMatch;       //!< Minimum length of a match.
+        static const size_t LastLiterals;   //!< Amount of bytes at the end of a block, that are always literals.
+        static const size_t HashBits;       //!< Size of the match finder hash table (2^HashBits entries).
+    }; //class LzCodec
+} //namespace Clipped
@@ -0,0 +1,299 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <ClippedUtils/cString.h>
+
+namespace Clipped
+{
+    template <class T>
+    /**
+     * @brief The FlatTree class is an alternative layout to Tree for big, mostly growing trees.
+     *   All nodes live in one contiguous array and are linked by indices (parent, first child and next sibling).
+     *   Keys are interned in a single character arena, identical keys are stored once.
+     *   Child lookups use an open addressing hash table over (parent, key), so no node needs a heap
+     *   allocation of its own. Building and clearing a tree only touches a handful of arrays.
+     *   Nodes are addressed by NodeId. Ids and element references stay valid until clear is called,
+     *   element references may get invalid by adding further elements.
+     *   Note: Nodes can't be removed one by one. Rebuild the tree instead.
+     */
+    class FlatTree
+    {
+    public:
+        using NodeId = uint32_t;
+        static const NodeId Root = 0;                   //!< The root stage, which exists in every tree.
+        static const NodeId InvalidNode = 0xFFFFFFFF;   //!< Returned, if a node doesn't exist.
+
+        FlatTree()
+        {
+            clear();
+        }
+
+        /**
+         * @brief reserve preallocates memory for the given amount of nodes and key characters.
+         * @param nodeCount expected amount of elements and subtrees.
+         * @param keyBytes expected amount of characters of all distinct keys.
+         */
+        void reserve(const size_t nodeCount, const size_t keyBytes)
+        {
+            nodes.reserve(nodeCount + 1);
+            elements.reserve(nodeCount);
+            keyArena.reserve(keyBytes);
+            rehash(childSlots, nodeCount * 2, &FlatTree::nodeHash);
+        }
+
+        /**
+         * @brief getSubtree returns the subtree specified by key below parent.
+         *   Note: A new subtree will be created if it doesn't exists already.
+         * @param parent subtree to look in.
+         * @param key of the subtree.
+         * @return id of the subtree or InvalidNode, if key names an element.
+         */
+        NodeId getSubtree(const NodeId parent, const String& key)
+        {
+            const NodeId existing = find(parent, key);
+            if(existing != InvalidNode) return isElement(existing) ? InvalidNode : existing;
+            return addNode(parent, intern(key), InvalidNode);
+        }
+
+        /**
+         * @brief addElement adds a new element below parent, specified by key.
+         * @param parent subtree to add the element to.
+         * @param key of the new element.
+         * @param element to store.
+         * @return id of the new element or InvalidNode, if key exists already below parent.
+         */
+        NodeId addElement(const NodeId parent, const String& key, const T& element)
+        {
+            if(find(parent, key) != InvalidNode) return InvalidNode; //Element already exists.
+            elements.push_back(element);
+            return addNode(parent, intern(key), static_cast<uint32_t>(elements.size() - 1));
+        }
+
+        /**
+         * @brief find looks up a direct child of parent.
+         * @param parent subtree to look in.
+         * @param key of the child.
+         * @return id of the child or InvalidNode.
+         */
+        NodeId find(const NodeId parent, const String& key) const
+        {
+            const uint32_t keyId = lookupKey(key.data(), key.size());
+            if(keyId == InvalidNode) return InvalidNode; //Unknown key - No node can have it.
+            const size_t mask = childSlots.size() - 1;
+            for(size_t slot = childHash(parent, keyId) & mask; childSlots[slot] != InvalidNode; slot = (slot + 1) & mask)
+            {
+                const Node& node = nodes[childSlots[slot]];
+                if(node.parent == parent && node.key == keyId) return childSlots[slot];
+            }
+            return InvalidNode;
+        }
+
+        /**
+         * @brief isElement checks, if a node is an element. Otherwise it is a subtree.
+         */
+        bool isElement(const NodeId node) const { return nodes[node].element != InvalidNode; }
+
+        /**
+         * @brief getElement returns the element stored in a node.
+         * @param node id of an element node.
+         * @return reference to the element.
+         */
+        T& getElement(const NodeId node) { return elements[nodes[node].element]; }
+        const T& getElement(const NodeId node) const { return elements[nodes[node].element]; }
+
+        /**
+         * @brief getElements returns all elements in insertion order. Iterating them is a plain array walk.
+         */
+        std::vector<T>& getElements() { return elements; }
+
+        /**
+         * @brief getKey returns the key of a node. The root has an empty key.
+         */
+        String getKey(const NodeId node) const
+        {
+            if(nodes[node].key == InvalidNode) return String();
+            const KeyRange& range = keys[nodes[node].key];
+            return String(keyArena.data() + range.offset, range.length);
+        }
+
+        NodeId getParent(const NodeId node) const { return nodes[node].parent; }            //!< InvalidNode for the root.
+        NodeId getFirstChild(const NodeId node) const { return nodes[node].firstChild; }    //!< InvalidNode, if there is none.
+        NodeId getNextSibling(const NodeId node) const { return nodes[node].nextSibling; }  //!< InvalidNode, if there is none.
+
+        size_t countElements() const { return elements.size(); }                        //!< All elements of the tree.
+        size_t countSubtrees() const { return nodes.size() - elements.size() - 1; }     //!< All subtrees without the root.
+        size_t countChildsAndElements() const { return nodes.size() - 1; }             //!< All nodes without the root.
+        size_t countKeys() const { return keys.size(); }                                //!< Distinct keys in the arena.
+
+        /**
+         * @brief clear drops all nodes and keys. Only the root stays.
+         */
+        void clear()
+        {
+            nodes.clear();
+            elements.clear();
+            keyArena.clear();
+            keys.clear();
+            keySlots.assign(16, InvalidNode);
+            childSlots.assign(16, InvalidNode);
+            nodes.push_back(Node{ InvalidNode, InvalidNode, InvalidNode, InvalidNode, InvalidNode, InvalidNode });
+        }
+
+    private:
+        /**
+         * @brief The Node struct links a node into the tree.
+         */
+        struct Node
+        {
+            NodeId parent;          //!< Stage, this node belongs to.
+            NodeId firstChild;      //!< First node of this stage.
+            NodeId lastChild;       //!< Last node of this stage. Appends keep the insertion order.
+            NodeId nextSibling;     //!< Next node of the parent stage.
+            uint32_t key;           //!< Index of the key range.
+            uint32_t element;       //!< Index of the element or InvalidNode for subtrees.
+        };
+
+        /**
+         * @brief The KeyRange struct locates an interned key inside the arena.
+         */
+        struct KeyRange
+        {
+            uint32_t offset;    //!< First character.
+            uint32_t length;    //!< Amount of characters.
+        };
+
+        NodeId addNode(const NodeId parent, const uint32_t key, const uint32_t element)
+        {
+            const NodeId id = static_cast<NodeId>(nodes.size());
+            nodes.push_back(Node{ parent, InvalidNode, InvalidNode, InvalidNode, key, element });
+            Node& stage = nodes[parent];
+            if(stage.lastChild == InvalidNode)
+                stage.firstChild = id;
+            else
+                nodes[stage.lastChild].nextSibling = id;
+            stage.lastChild = id;
+            insertSlot(childSlots, id, countChildsAndElements(), &FlatTree::nodeHash);
+            return id;
+        }
+
+        uint32_t intern(const String& key)
+        {
+            const uint32_t existing = lookupKey(key.data(), key.size());
+            if(existing != InvalidNode) return existing;
+            keys.push_back(KeyRange{ static_cast<uint32_t>(keyArena.size()), static_cast<uint32_t>(key.size()) });
+            keyArena.insert(keyArena.end(), key.begin(), key.end());
+            const uint32_t id = static_cast<uint32_t>(keys.size() - 1);
+            insertSlot(keySlots, id, keys.size(), &FlatTree::keyHash);
+            return id;
+        }
+
+        uint32_t lookupKey(const char* data, const size_t length) const
+        {
+            const size_t mask = keySlots.size() - 1;
+            for(size_t slot = hashBytes(data, length) & mask; keySlots[slot] != InvalidNode; slot = (slot + 1) & mask)
+            {
+                const KeyRange& range = keys[keySlots[slot]];
+                if(range.length == length && 0 == std::memcmp(keyArena.data() + range.offset, data, length))
+                    return keySlots[slot];
+            }
+            return InvalidNode;
+        }
+
+        static size_t hashBytes(const char* data, const size_t length)
+        {
+            uint64_t hash = 14695981039346656037ull; //FNV-1a
+            for(size_t i = 0; i < length; i++)
+                hash = (hash ^ static_cast<unsigned char>(data[i])) * 1099511628211ull;
+            return static_cast<size_t>(hash ^ (hash >> 32));
+        }
+
+        static size_t childHash(const NodeId parent, const uint32_t key)
+        {
+            uint64_t hash = (static_cast<uint64_t>(parent) << 32 | key) * 0x9E3779B97F4A7C15ull;
+            return static_cast<size_t>(hash ^ (hash >> 29));
+        }
+
+        size_t keyHash(const uint32_t key) const
+        {
+            return hashBytes(keyArena.data() + keys[key].offset, keys[key].length);
+        }
+
+        size_t nodeHash(const NodeId node) const
+        {
+            return childHash(nodes[node].parent, nodes[node].key);
+        }
+
+        /**
+         * @brief insertSlot adds an id to an open addressing table. Grows the table, if it gets half full.
+         */
+        void insertSlot(std::vector<uint32_t>& slots, const uint32_t id, const size_t count, size_t (FlatTree::*hash)(const uint32_t) const)
+        {
+            if(count * 2 > slots.size()) rehash(slots, count * 2, hash);
+            const size_t mask = slots.size() - 1;
+            size_t slot = (this->*hash)(id) & mask;
+            while(slots[slot] != InvalidNode) slot = (slot + 1) & mask;
+            slots[slot] = id;
+        }
+
+        /**
+         * @brief rehash resizes an open addressing table to the next power of two above minimumSize.
+         */
+        void rehash(std::vector<uint32_t>& slots, const size_t minimumSize, size_t (FlatTree::*hash)(const uint32_t) const)
+        {
+            size_t size = slots.size();
+            while(size < minimumSize) size *= 2;
+            if(size == slots.size()) return;
+            std::vector<uint32_t> old(size, InvalidNode);
+            old.swap(slots);
+            const size_t mask = size - 1;
+            for(const uint32_t id : old)
+            {
+                if(id == InvalidNode) continue;
+                size_t slot = (this->*hash)(id) & mask;
+                while(slots[slot] != InvalidNode) slot = (slot + 1) & mask;
+                slots[slot] = id;
+            }
+        }
+
+        std::vector<Node> nodes;            //!< All nodes. Index 0 is the root.
+        std::vector<T> elements;            //!< Payload of the element nodes.
+        std::vector<char> keyArena;         //!< Characters of all distinct keys.
+        std::vector<KeyRange> keys;         //!< Distinct keys inside the arena.
+        std::vector<uint32_t> keySlots;     //!< Open addressing table: Key hash -> key index.
+        std::vector<NodeId> childSlots;     //!< Open addressing table: (parent, key) -> node.
+    }; //class FlatTree
+
+    template <class T>
+    const typename FlatTree<T>::NodeId FlatTree<T>::Root;
+
+    template <class T>
+    const typename FlatTree<T>::NodeId FlatTree<T>::InvalidNode;
+}  // namespace Clipped
@@ -28,7 +28,9 @@
 #pragma once
 
 #include <functional>
+#include <iterator>
 #include <map>
+#include <vector>
 #include <ClippedUtils/cLogger.h>
 
 namespace Clipped
@@ -39,76 +41,196 @@ namespace Clipped
      *   template param I as key, T as payload.
      *   Element: payload in current tree layer.
      *   subtree: Next Tree stage possibly containing subtrees and elements.
+     *   Every stage caches the amount of elements and subtrees below it, so counting is O(1).
+     *   Note: Add or remove elements and subtrees with the methods of the tree only. Changing the
+     *   maps directly would bypass the cached counts.
      */
     class Tree
     {
-        class TreeIterator : public std::iterator<std::output_iterator_tag, T>
+        /**
+         * @brief The TreeIterator class visits all elements of a tree depth first.
+         *   The elements of a stage are visited before the elements of its subtrees.
+         *   A stack of positions replaces the recursion, so a full iteration is O(n).
+         */
+        class TreeIterator
         {
         public:
-            explicit TreeIterator(Tree<I, T>& container, size_t index = 0)
-                : container(container)
-                , index(index)
-            {}
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::pair<const I, T>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = value_type*;
+            using reference = value_type&;
+
+            /**
+             * @brief TreeIterator creates an end iterator.
+             */
+            TreeIterator() {}
 
-            std::pair<const I, T>& operator*()
+            /**
+             * @brief TreeIterator creates an iterator pointing to the first element of container.
+             * @param container to iterate.
+             */
+            explicit TreeIterator(Tree<I, T>& container)
             {
-                if(index < container.countLocalElements())
-                {
-                    auto iterator = container.elements.begin();
-                    for(size_t i = 0; i < index; i++) iterator++;
-                    return *iterator;
-                }
-                size_t childLookupIndex = index - container.countLocalElements();
-                for(auto& child : container.childs)
-                {
-                    if(childLookupIndex < child.second.countElements())
-                        return *(child.second.begin() + childLookupIndex);
-                    else
-                        childLookupIndex -= child.second.countElements();
-                }
-				//Should never happen.
-				LogError() << "Iterator end() overrun detected!";
-				auto iterator = container.elements.begin(); //Fallback return first element.
-				return *iterator;
+                enter(container);
+                settle();
+            }
+
+            reference operator*() const
+            {
+                return *stages.back().element;
+            }
+
+            pointer operator->() const
+            {
+                return &*stages.back().element;
             }
 
             TreeIterator& operator++()
             {
-                index++;
+                ++stages.back().element;
+                settle();
                 return *this;
             }
 
+            TreeIterator operator++(int)
+            {
+                TreeIterator previous = *this;
+                ++(*this);
+                return previous;
+            }
+
             TreeIterator& operator+(const size_t rhs)
             {
-                index += rhs;
+                for(size_t i = 0; i < rhs && !stages.empty(); i++) ++(*this);
                 return *this;
             }
 
-            bool operator !=(const TreeIterator& rhs)const
+            bool operator==(const TreeIterator& rhs) const
+            {
+                if(stages.empty() || rhs.stages.empty()) return stages.empty() == rhs.stages.empty();
+                return stages.back().element == rhs.stages.back().element;
+            }
+
+            bool operator !=(const TreeIterator& rhs) const
             {
-                return rhs.index != index;
+                return !(*this == rhs);
             }
 
         private:
-            Tree<I, T>& container;
-            size_t index;
+            /**
+             * @brief The Stage struct is the position inside a visited tree stage.
+             */
+            struct Stage
+            {
+                Tree<I, T>* tree;                                       //!< The visited stage.
+                typename std::map<I, T>::iterator element;              //!< Current element of the stage.
+                typename std::map<I, Tree<I, T>>::iterator child;       //!< Next subtree to enter.
+            };
+
+            void enter(Tree<I, T>& tree)
+            {
+                stages.push_back(Stage{ &tree, tree.elements.begin(), tree.childs.begin() });
+            }
+
+            /**
+             * @brief settle moves on, until the current position is an element or the end is reached.
+             */
+            void settle()
+            {
+                while(!stages.empty() && stages.back().element == stages.back().tree->elements.end())
+                {
+                    Stage& stage = stages.back();
+                    if(stage.child != stage.tree->childs.end())
+                        enter((stage.child++)->second); //Invalidates stage.
+                    else
+                        stages.pop_back();
+                }
+            }
+
+            std::vector<Stage> stages; //!< Stages from the iterated tree to the current one. Empty at the end.
         };
 
     public:
+        using iterator = TreeIterator;
+
         /**
          * @brief Tree creates a Tree identified by ident.
          * @param ident
          */
-        Tree() {}
+        Tree()
+            : parent(nullptr)
+            , elementCount(0)
+            , subtreeCount(0)
+        {}
+
+        /**
+         * @brief Tree copies a tree including all subtrees. The copy is a root tree.
+         */
+        Tree(const Tree<I, T>& rhs)
+            : childs(rhs.childs)
+            , elements(rhs.elements)
+            , parent(nullptr)
+            , elementCount(rhs.elementCount)
+            , subtreeCount(rhs.subtreeCount)
+        {
+            adoptChilds();
+        }
+
+        /**
+         * @brief Tree moves a tree including all subtrees. The new tree is a root tree.
+         */
+        Tree(Tree<I, T>&& rhs)
+            : childs(std::move(rhs.childs))
+            , elements(std::move(rhs.elements))
+            , parent(nullptr)
+            , elementCount(rhs.elementCount)
+            , subtreeCount(rhs.subtreeCount)
+        {
+            adoptChilds();
+            rhs.clear();
+        }
+
+        /**
+         * @brief operator = replaces the content of this tree with a copy of rhs. The position in a parent tree is kept.
+         */
+        Tree<I, T>& operator=(const Tree<I, T>& rhs)
+        {
+            if(this != &rhs)
+            {
+                Tree<I, T> copy(rhs);
+                *this = std::move(copy);
+            }
+            return *this;
+        }
+
+        /**
+         * @brief operator = moves the content of rhs to this tree. The position in a parent tree is kept.
+         */
+        Tree<I, T>& operator=(Tree<I, T>&& rhs)
+        {
+            if(this != &rhs)
+            {
+                updateCounts(static_cast<long>(rhs.elementCount) - static_cast<long>(elementCount),
+                             static_cast<long>(rhs.subtreeCount) - static_cast<long>(subtreeCount));
+                childs = std::move(rhs.childs);
+                elements = std::move(rhs.elements);
+                elementCount = rhs.elementCount;
+                subtreeCount = rhs.subtreeCount;
+                adoptChilds();
+                rhs.clear();
+            }
+            return *this;
+        }
 
         TreeIterator begin()
         {
-            return Tree<I, T>::TreeIterator(*this, 0);
+            return TreeIterator(*this);
         }
 
         TreeIterator end()
         {
-            return Tree<I, T>::TreeIterator(*this, countElements());
+            return TreeIterator();
         }
 
         /**
@@ -129,7 +251,13 @@ namespace Clipped
          * @param key to lookup
          * @return reference to element specified by key.
          */
-        T& getElement(const I& key) { return elements[key]; }
+        T& getElement(const I& key)
+        {
+            auto result = elements.find(key);
+            if(result != elements.end()) return result->second;
+            updateCounts(1, 0);
+            return elements[key];
+        }
 
         /**
          * @brief getElements gets a complete map of all elements of this tree layer.
@@ -147,6 +275,7 @@ namespace Clipped
         {
             if (elementExist(key)) return false;  // Element already exists.
             elements[key] = element;
+            updateCounts(1, 0);
             return true;
         }
 
@@ -157,7 +286,11 @@ namespace Clipped
         void removeElement(const I& key)
         {
             auto it = elements.find(key);
-            if (it != elements.end()) elements.erase(it);
+            if (it != elements.end())
+            {
+                elements.erase(it);
+                updateCounts(-1, 0);
+            }
         }
 
         /**
@@ -206,7 +339,15 @@ namespace Clipped
          * @param key of the subtree.
          * @return reference to subtree specified by key.
          */
-        Tree<I, T>& getSubtree(const I& key) { return childs[key]; }
+        Tree<I, T>& getSubtree(const I& key)
+        {
+            auto result = childs.find(key);
+            if(result != childs.end()) return result->second;
+            Tree<I, T>& child = childs[key];
+            child.parent = this;
+            updateCounts(0, 1);
+            return child;
+        }
 
         /**
          * @brief getSubtrees gets a complete map of all subtrees of this tree layer.
@@ -222,7 +363,7 @@ namespace Clipped
         Tree<I, T>& addSubtree(const I& key)
         {
             if (subtreeExist(key)) LogWarn() << "Subtree already exists!";
-            return childs[key];
+            return getSubtree(key);
         }
 
         /**
@@ -232,19 +373,26 @@ namespace Clipped
         void removeSubtree(const I& key)
         {
             auto it = childs.find(key);
-            if (it != childs.end()) childs.erase(it);
+            if (it != childs.end())
+            {
+                updateCounts(-static_cast<long>(it->second.elementCount), -static_cast<long>(it->second.subtreeCount + 1));
+                childs.erase(it);
+            }
         }
 
+        /**
+         * @brief getParent returns the tree stage, this stage is a subtree of.
+         * @return the parent or nullptr for root trees.
+         */
+        Tree<I, T>* getParent() const { return parent; }
+
         /**
          * @brief countSubtrees counts all subtrees in this tree.
          * @return amount of child trees.
          */
         size_t countSubtrees() const
         {
-            size_t count = childs.size();
-            for(const auto& child : childs)
-                count += child.second.countSubtrees();
-            return count;
+            return subtreeCount;
         }
 
         /**
@@ -263,10 +411,7 @@ namespace Clipped
          */
         size_t countElements() const
         {
-            size_t count = elements.size();
-            for(const auto& child : childs)
-                count += child.second.countElements();
-            return count;
+            return elementCount;
         }
 
         /**
@@ -284,28 +429,67 @@ namespace Clipped
          */
         size_t countChildsAndElements() const
         {
-            size_t count = elements.size();
-            count += childs.size();
-            for(const auto& child : childs)
-                count += child.second.countChildsAndElements();
-            return count;
+            return elementCount + subtreeCount;
         }
 
         /**
          * @brief removeEmptyChilds recursive cleanup of empty child trees.
+         *   Subtrees, that only contain empty subtrees, get removed, too.
          */
         void removeEmptyChilds()
         {
-            for(auto child : childs) //Cleanup this stage.
+            for(auto child = childs.begin(); child != childs.end();)
             {
-                if(child.second.countLocalElements() == 0 && child.second.countLocalSubtrees() == 0)
-                    removeSubtree(child.first);
+                child->second.removeEmptyChilds(); //Cleanup childs first.
+                if(child->second.countLocalElements() == 0 && child->second.countLocalSubtrees() == 0)
+                {
+                    updateCounts(0, -1);
+                    child = childs.erase(child);
+                }
+                else
+                {
+                    ++child;
+                }
             }
-            for(auto child : childs) //Cleanup childs.
-                child.second.removeEmptyChilds();
         }
 
         std::map<I, Tree<I, T>> childs;  //!< subtrees identified by key of type I.
         std::map<I, T> elements;         //!< Key, elements map.
+
+    private:
+        /**
+         * @brief updateCounts adds deltas to the cached counts of this stage and all parents.
+         */
+        void updateCounts(const long elementDelta, const long subtreeDelta)
+        {
+            for(Tree<I, T>* stage = this; stage; stage = stage->parent)
+            {
+                stage->elementCount = static_cast<size_t>(static_cast<long>(stage->elementCount) + elementDelta);
+                stage->subtreeCount = static_cast<size_t>(static_cast<long>(stage->subtreeCount) + subtreeDelta);
+            }
+        }
+
+        /**
+         * @brief adoptChilds points the parent of all direct subtrees to this stage.
+         */
+        void adoptChilds()
+        {
+            for(auto& child : childs)
+                child.second.parent = this;
+        }
+
+        /**
+         * @brief clear drops all contents. Used by moved-from trees.
+         */
+        void clear()
+        {
+            updateCounts(-static_cast<long>(elementCount), -static_cast<long>(subtreeCount));
+            childs.clear();
+            elements.clear();
+        }
+
+        Tree<I, T>* parent;     //!< Stage, this tree is a subtree of. nullptr for root trees.
+        size_t elementCount;    //!< Elements in this stage and all subtrees.
+        size_t subtreeCount;    //!< Subtrees below this stage.
     };
 }  // namespace Clipped
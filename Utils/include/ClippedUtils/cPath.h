@@ -137,6 +137,15 @@ namespace Clipped
          */
         bool wildcardMatch(const BasicString<T>& pattern) const;
 
+        /**
+         * @brief globMatch matchs the whole path with a glob pattern.
+         *   ? matchs a single character, * any characters inside a directory level and ** any characters
+         *   across directory levels, also none. Other characters have to match exactly.
+         * @param pattern glob pattern with / as directory delimiter.
+         * @return true, if the pattern matchs with this path.
+         */
+        bool globMatch(const BasicString<T>& pattern) const;
+
     }; // class BasicPath
 
     using Path = BasicPath<char>;
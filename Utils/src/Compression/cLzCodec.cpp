@@ -0,0 +1,206 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#include "Compression/cLzCodec.h"
+#include <cstdint>
+#include <cstring>
+
+using namespace Clipped;
+
+const size_t LzCodec::MaxDistance = 65535;
+const size_t LzCodec::MinMatch = 4;
+const size_t LzCodec::LastLiterals = 5;
+const size_t LzCodec::HashBits = 14;
+
+namespace
+{
+    uint32_t read32(const unsigned char* position)
+    {
+        uint32_t value;
+        std::memcpy(&value, position, sizeof(value));
+        return value;
+    }
+
+    /**
+     * @brief writeLength writes the extension bytes of a length, that didn't fit into its nibble.
+     * @return false, if the destination is too small.
+     */
+    bool writeLength(size_t length, unsigned char*& out, const unsigned char* outEnd)
+    {
+        while(length >= 255)
+        {
+            if(out >= outEnd) return false;
+            *out++ = 255;
+            length -= 255;
+        }
+        if(out >= outEnd) return false;
+        *out++ = static_cast<unsigned char>(length);
+        return true;
+    }
+
+    /**
+     * @brief readLength reads the extension bytes of a length and adds them to length.
+     * @return false, if the source ends within the length.
+     */
+    bool readLength(size_t& length, const unsigned char*& in, const unsigned char* inEnd)
+    {
+        unsigned char value = 255;
+        while(value == 255)
+        {
+            if(in >= inEnd) return false;
+            value = *in++;
+            length += value;
+        }
+        return true;
+    }
+
+    /**
+     * @brief writeSequence writes literals and an optional match (matchLength 0 for the last sequence).
+     * @return false, if the destination is too small.
+     */
+    bool writeSequence(const unsigned char* literals, const size_t literalLength, const size_t offset,
+                       const size_t matchLength, unsigned char*& out, const unsigned char* outEnd)
+    {
+        if(out >= outEnd) return false;
+        unsigned char* token = out++;
+        *token = static_cast<unsigned char>((literalLength < 15 ? literalLength : 15) << 4);
+        if(literalLength >= 15 && !writeLength(literalLength - 15, out, outEnd)) return false;
+        if(static_cast<size_t>(outEnd - out) < literalLength) return false;
+        std::memcpy(out, literals, literalLength);
+        out += literalLength;
+
+        if(0 == matchLength) return true; //Last sequence: literals only.
+
+        if(outEnd - out < 2) return false;
+        *out++ = static_cast<unsigned char>(offset & 0xFF);
+        *out++ = static_cast<unsigned char>((offset >> 8) & 0xFF);
+        const size_t length = matchLength - 4; //Minimum match is implied.
+        *token |= static_cast<unsigned char>(length < 15 ? length : 15);
+        if(length >= 15 && !writeLength(length - 15, out, outEnd)) return false;
+        return true;
+    }
+}
+
+size_t LzCodec::getMaxCompressedSize(const size_t sourceSize)
+{
+    return sourceSize + sourceSize / 255 + 16;
+}
+
+bool LzCodec::compress(const char* source, const size_t sourceSize,
+                       char* dest, const size_t destCapacity, size_t& compressedSize)
+{
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(source);
+    unsigned char* out = reinterpret_cast<unsigned char*>(dest);
+    const unsigned char* outEnd = out + destCapacity;
+    size_t anchor = 0; //First byte not yet written.
+    size_t position = 0;
+
+    if(sourceSize > MinMatch + LastLiterals)
+    {
+        std::vector<uint32_t> hashTable(static_cast<size_t>(1) << HashBits, UINT32_MAX); //Last positions of 4 byte sequences.
+        const size_t matchLimit = sourceSize - LastLiterals;
+        while(position + MinMatch <= matchLimit)
+        {
+            const uint32_t sequence = read32(in + position);
+            const uint32_t hash = (sequence * 2654435761u) >> (32 - HashBits);
+            const size_t candidate = hashTable[hash];
+            hashTable[hash] = static_cast<uint32_t>(position);
+
+            if(candidate != UINT32_MAX && position - candidate <= MaxDistance && read32(in + candidate) == sequence)
+            {
+                size_t matchLength = MinMatch;
+                while(position + matchLength < matchLimit && in[candidate + matchLength] == in[position + matchLength])
+                    matchLength++;
+                if(!writeSequence(in + anchor, position - anchor, position - candidate, matchLength, out, outEnd))
+                    return false;
+                position += matchLength;
+                anchor = position;
+            }
+            else
+            {
+                position++;
+            }
+        }
+    }
+    if(!writeSequence(in + anchor, sourceSize - anchor, 0, 0, out, outEnd)) return false;
+    compressedSize = static_cast<size_t>(out - reinterpret_cast<unsigned char*>(dest));
+    return true;
+}
+
+bool LzCodec::compress(const char* source, const size_t sourceSize, std::vector<char>& dest)
+{
+    const size_t start = dest.size();
+    size_t compressedSize = 0;
+    dest.resize(start + getMaxCompressedSize(sourceSize));
+    const bool success = compress(source, sourceSize, dest.data() + start, dest.size() - start, compressedSize);
+    dest.resize(success ? start + compressedSize : start);
+    return success;
+}
+
+bool LzCodec::decompress(const char* source, const size_t sourceSize, char* dest, const size_t destSize)
+{
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(source);
+    const unsigned char* inEnd = in + sourceSize;
+    unsigned char* out = reinterpret_cast<unsigned char*>(dest);
+    unsigned char* const outStart = out;
+    const unsigned char* outEnd = out + destSize;
+
+    while(in < inEnd)
+    {
+        const unsigned char token = *in++;
+        size_t literalLength = token >> 4;
+        if(literalLength == 15 && !readLength(literalLength, in, inEnd)) return false;
+        if(static_cast<size_t>(inEnd - in) < literalLength || static_cast<size_t>(outEnd - out) < literalLength)
+            return false;
+        std::memcpy(out, in, literalLength);
+        in += literalLength;
+        out += literalLength;
+
+        if(in == inEnd) break; //Last sequence without match.
+
+        if(inEnd - in < 2) return false;
+        const size_t offset = static_cast<size_t>(in[0]) | (static_cast<size_t>(in[1]) << 8);
+        in += 2;
+        size_t matchLength = token & 15;
+        if(matchLength == 15 && !readLength(matchLength, in, inEnd)) return false;
+        matchLength += MinMatch;
+        if(0 == offset || offset > static_cast<size_t>(out - outStart) || static_cast<size_t>(outEnd - out) < matchLength)
+            return false;
+        const unsigned char* match = out - offset;
+        if(offset >= matchLength) //Match doesn't overlap the bytes it produces.
+        {
+            std::memcpy(out, match, matchLength);
+        }
+        else
+        {
+            for(size_t i = 0; i < matchLength; i++) //Byte by byte: The match repeats the bytes it produces.
+                out[i] = match[i];
+        }
+        out += matchLength;
+    }
+    return out == outEnd;
+}
@@ -187,6 +187,43 @@ bool BasicPath<T>::wildcardMatch(const BasicString<T>& pattern) const
     return match.empty() | endsWithWildcard;
 }
 
+namespace
+{
+    /**
+     * @brief globMatchAt matchs the rest of a path with the rest of a glob pattern.
+     */
+    template <class T>
+    bool globMatchAt(const T* pattern, const T* path)
+    {
+        while(*pattern)
+        {
+            if(*pattern == '*')
+            {
+                const bool crossLevels = pattern[1] == '*';
+                pattern += crossLevels ? 2 : 1;
+                if(crossLevels && *pattern == '/' && globMatchAt(pattern + 1, path))
+                    return true; //"**/" matched no directory level at all.
+                for(;; path++) //Let the wildcard consume more and more characters.
+                {
+                    if(globMatchAt(pattern, path)) return true;
+                    if(!*path || (!crossLevels && *path == '/')) return false;
+                }
+            }
+            if(!*path) return false; //Path too short.
+            if(*pattern == '?' ? *path == '/' : *pattern != *path) return false;
+            pattern++;
+            path++;
+        }
+        return !*path;
+    }
+}
+
+template <class T>
+bool BasicPath<T>::globMatch(const BasicString<T>& pattern) const
+{
+    return globMatchAt(pattern.c_str(), this->c_str());
+}
+
 // Please compile template class for the following types:
 namespace Clipped
 {
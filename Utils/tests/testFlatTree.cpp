@@ -0,0 +1,129 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+#include <ClippedUtils/cLogger.h>
+#include <ClippedUtils/DataStructures/cFlatTree.h>
+
+using namespace Clipped;
+
+bool checkBuildAndFind();
+bool checkInternedKeys();
+bool checkBigTree();
+
+int main(void)
+{
+    bool status = true;
+    Logger() << Logger::MessageType::Debug;
+
+    status &= checkBuildAndFind();
+    status &= checkInternedKeys();
+    status &= checkBigTree();
+
+    if(status)
+        LogInfo() << "All tests passed!";
+    else
+        LogError() << "At least one test failed!";
+    return !status; //success => true => Return code 0
+}
+
+using IntTree = FlatTree<int>;
+
+bool checkBuildAndFind()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    IntTree tree;
+    const IntTree::NodeId textures = tree.getSubtree(IntTree::Root, "TEXTURES");
+    const IntTree::NodeId wall = tree.addElement(textures, "WALL.TGA", 1);
+    const IntTree::NodeId floor = tree.addElement(textures, "FLOOR.TGA", 2);
+    tree.addElement(IntTree::Root, "README.TXT", 3);
+    if(tree.getSubtree(IntTree::Root, "TEXTURES") != textures || tree.addElement(textures, "WALL.TGA", 4) != IntTree::InvalidNode ||
+       tree.getSubtree(textures, "WALL.TGA") != IntTree::InvalidNode)
+    {
+        LogError() << "Existing nodes have to be reused or rejected!";
+        return false;
+    }
+    if(tree.find(textures, "FLOOR.TGA") != floor || tree.find(IntTree::Root, "FLOOR.TGA") != IntTree::InvalidNode ||
+       tree.find(textures, "UNKNOWN") != IntTree::InvalidNode || tree.getElement(floor) != 2 || tree.isElement(textures))
+    {
+        LogError() << "Lookup failed!";
+        return false;
+    }
+    if(tree.getFirstChild(textures) != wall || tree.getNextSibling(wall) != floor || tree.getNextSibling(floor) != IntTree::InvalidNode ||
+       tree.getParent(wall) != textures || tree.getKey(wall) != "WALL.TGA" || tree.getKey(IntTree::Root) != "")
+    {
+        LogError() << "Links broken!";
+        return false;
+    }
+    if(tree.countElements() != 3 || tree.countSubtrees() != 1 || tree.countChildsAndElements() != 4) return false;
+    tree.clear();
+    return tree.countChildsAndElements() == 0 && tree.find(IntTree::Root, "TEXTURES") == IntTree::InvalidNode;
+}
+
+bool checkInternedKeys()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    IntTree tree;
+    for(int i = 0; i < 100; i++)
+    {
+        const IntTree::NodeId stage = tree.getSubtree(IntTree::Root, String(i));
+        tree.addElement(stage, "MESH.3DS", i);
+        tree.addElement(stage, "TEXTURE.TGA", i);
+    }
+    if(tree.countKeys() != 102 || tree.countElements() != 200)
+    {
+        LogError() << "Identical keys have to be stored once, got " << tree.countKeys() << " keys!";
+        return false;
+    }
+    return tree.getElement(tree.find(tree.find(IntTree::Root, "42"), "MESH.3DS")) == 42;
+}
+
+bool checkBigTree()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    IntTree tree;
+    const int directories = 200;
+    const int filesPerDirectory = 1000;
+    for(int d = 0; d < directories; d++)
+    {
+        const IntTree::NodeId stage = tree.getSubtree(tree.getSubtree(IntTree::Root, String(d % 10)), "DIR" + String(d));
+        for(int f = 0; f < filesPerDirectory; f++)
+            tree.addElement(stage, "FILE" + String(f) + ".DAT", d * filesPerDirectory + f);
+    }
+    if(tree.countElements() != directories * filesPerDirectory || tree.countSubtrees() != directories + 10) return false;
+    for(int d = 0; d < directories; d += 17) //Every node is reachable by its path.
+    {
+        const IntTree::NodeId stage = tree.find(tree.find(IntTree::Root, String(d % 10)), "DIR" + String(d));
+        for(int f = 0; f < filesPerDirectory; f += 101)
+        {
+            const IntTree::NodeId file = tree.find(stage, "FILE" + String(f) + ".DAT");
+            if(file == IntTree::InvalidNode || tree.getElement(file) != d * filesPerDirectory + f) return false;
+        }
+    }
+    size_t visited = 0;
+    for(IntTree::NodeId child = tree.getFirstChild(IntTree::Root); child != IntTree::InvalidNode; child = tree.getNextSibling(child))
+        visited++;
+    return visited == 10;
+}
@@ -0,0 +1,147 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#include <ClippedUtils/cLogger.h>
+#include <ClippedUtils/Compression/cLzCodec.h>
+#include <cstdlib>
+
+using namespace Clipped;
+
+bool roundTrip(const std::vector<char>& data, const char* name);
+bool checkRoundTrips();
+bool checkCompressionRatio();
+bool checkCorruptInput();
+
+int main(void)
+{
+    bool status = true;
+    Logger() << Logger::MessageType::Debug;
+
+    status &= checkRoundTrips();
+    status &= checkCompressionRatio();
+    status &= checkCorruptInput();
+
+    if(status)
+        LogInfo() << "All tests passed!";
+    else
+        LogError() << "At least one test failed!";
+    return !status; //success => true => Return code 0
+}
+
+bool roundTrip(const std::vector<char>& data, const char* name)
+{
+    std::vector<char> compressed;
+    if(!LzCodec::compress(data.data(), data.size(), compressed))
+    {
+        LogError() << "Compression of " << name << " failed!";
+        return false;
+    }
+    if(compressed.size() > LzCodec::getMaxCompressedSize(data.size()))
+    {
+        LogError() << "Compressed size of " << name << " exceeds the maximum!";
+        return false;
+    }
+    std::vector<char> decompressed(data.size());
+    if(!LzCodec::decompress(compressed.data(), compressed.size(), decompressed.data(), decompressed.size()) ||
+       decompressed != data)
+    {
+        LogError() << "Round trip of " << name << " failed!";
+        return false;
+    }
+    LogDebug() << name << ": " << data.size() << " -> " << compressed.size() << " bytes.";
+    return true;
+}
+
+bool checkRoundTrips()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    bool result = true;
+    std::srand(42);
+
+    result &= roundTrip(std::vector<char>(), "empty");
+    result &= roundTrip(std::vector<char>(1, 'x'), "single byte");
+    result &= roundTrip(std::vector<char>(70000, 'a'), "run");
+
+    std::vector<char> random(65536);
+    for(char& c : random) c = static_cast<char>(std::rand() & 0xFF);
+    result &= roundTrip(random, "random");
+
+    std::vector<char> text;
+    const std::string words[] = { "vdfs ", "archive ", "entry ", "payload ", "index ", "compressed " };
+    while(text.size() < 65536)
+    {
+        const std::string& word = words[std::rand() % 6];
+        text.insert(text.end(), word.begin(), word.end());
+    }
+    result &= roundTrip(text, "text");
+
+    for(size_t size = 0; size < 64; size++) //Short blocks around the literal only limits.
+        result &= roundTrip(std::vector<char>(text.begin(), text.begin() + size), "short text");
+    return result;
+}
+
+bool checkCompressionRatio()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    std::vector<char> data;
+    for(int i = 0; data.size() < 65536; i++)
+    {
+        const std::string line = "Line " + std::to_string(i % 100) + ": The quick brown fox jumps over the lazy dog.\n";
+        data.insert(data.end(), line.begin(), line.end());
+    }
+    std::vector<char> compressed;
+    if(!LzCodec::compress(data.data(), data.size(), compressed) || compressed.size() * 4 > data.size())
+    {
+        LogError() << "Repetitive data not compressed well: " << data.size() << " -> " << compressed.size();
+        return false;
+    }
+    return true;
+}
+
+bool checkCorruptInput()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    std::vector<char> data(1000, 'z');
+    std::vector<char> compressed;
+    LzCodec::compress(data.data(), data.size(), compressed);
+    std::vector<char> decompressed(data.size());
+
+    if(LzCodec::decompress(compressed.data(), compressed.size(), decompressed.data(), decompressed.size() - 1))
+    {
+        LogError() << "Too small destination not detected!";
+        return false;
+    }
+    if(LzCodec::decompress(compressed.data(), compressed.size() - 1, decompressed.data(), decompressed.size()))
+    {
+        LogError() << "Truncated block not detected!";
+        return false;
+    }
+    compressed[compressed.size() - 6] = 0x7F; //Points the match offset far behind the start.
+    compressed[compressed.size() - 5] = 0x7F;
+    LzCodec::decompress(compressed.data(), compressed.size(), decompressed.data(), decompressed.size()); //Must not crash.
+    return true;
+}
@@ -0,0 +1,172 @@
+/*
+** Clipped -- a Multipurpose C++ Library.
+**
+** Copyright (C) 2019-2020 Christian Löpke. All rights reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+** CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+** SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+#include <ClippedUtils/cLogger.h>
+#include <ClippedUtils/cString.h>
+#include <ClippedUtils/DataStructures/cTree.h>
+#include <iterator>
+
+using namespace Clipped;
+
+bool checkCachedCounts();
+bool checkIteration();
+bool checkCopies();
+bool checkRemoveEmptyChilds();
+
+int main(void)
+{
+    bool status = true;
+    Logger() << Logger::MessageType::Debug;
+
+    status &= checkCachedCounts();
+    status &= checkIteration();
+    status &= checkCopies();
+    status &= checkRemoveEmptyChilds();
+
+    if(status)
+        LogInfo() << "All tests passed!";
+    else
+        LogError() << "At least one test failed!";
+    return !status; //success => true => Return code 0
+}
+
+bool checkCounts(Tree<String, int>& tree, const size_t elements, const size_t subtrees)
+{
+    if(tree.countElements() != elements || tree.countSubtrees() != subtrees || tree.countChildsAndElements() != elements + subtrees)
+    {
+        LogError() << "Expected " << elements << " elements and " << subtrees << " subtrees, got "
+                   << tree.countElements() << " and " << tree.countSubtrees() << "!";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief buildTree creates a tree with 3 levels:
+ *   root: a, b and subtrees X, Y. X: c and subtree Z. Z: d, e. Y: empty.
+ */
+Tree<String, int> buildTree()
+{
+    Tree<String, int> tree;
+    tree.addElement("a", 1);
+    tree.getElement("b") = 2;
+    Tree<String, int>& x = tree.addSubtree("X");
+    x.addElement("c", 3);
+    Tree<String, int>& z = x.getSubtree("Z");
+    z.addElement("d", 4);
+    z.getElement("e") = 5;
+    tree.getSubtree("Y");
+    return tree;
+}
+
+bool checkCachedCounts()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    Tree<String, int> tree = buildTree();
+    if(!checkCounts(tree, 5, 3) || !checkCounts(tree.getSubtree("X"), 3, 1)) return false;
+
+    tree.getElement("a") = 10; //Existing element - No new one.
+    tree.getSubtree("X").getSubtree("Z").removeElement("d");
+    if(!checkCounts(tree, 4, 3) || tree.addElement("a", 0)) return false;
+
+    if(!tree.removeElement("e", &tree.getSubtree("X").getSubtree("Z").getElement("e")) || !checkCounts(tree, 3, 3))
+        return false;
+    tree.removeSubtree("X");
+    if(!checkCounts(tree, 2, 1) || tree.getSubtree("Y").getParent() != &tree || tree.getParent() != nullptr)
+        return false;
+    return true;
+}
+
+bool checkIteration()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    Tree<String, int> tree = buildTree();
+    std::vector<int> visited;
+    for(auto& element : tree)
+        visited.push_back(element.second);
+    if(visited != std::vector<int>({1, 2, 3, 4, 5}))
+    {
+        LogError() << "Unexpected iteration order!";
+        return false;
+    }
+    if(std::distance(tree.getSubtree("X").begin(), tree.getSubtree("X").end()) != 3 ||
+       tree.getSubtree("Y").begin() != tree.getSubtree("Y").end() || (tree.begin() + 3)->first != "d")
+    {
+        LogError() << "Subtree iteration broken!";
+        return false;
+    }
+
+    Tree<String, int> big; //Linear iteration over a wide and deep tree.
+    Tree<String, int>* stage = &big;
+    for(int level = 0; level < 100; level++)
+    {
+        for(int i = 0; i < 1000; i++)
+            stage->addElement(String(i), i);
+        stage = &stage->getSubtree(String(level));
+    }
+    size_t count = 0;
+    for(auto it = big.begin(); it != big.end(); ++it)
+        count++;
+    return count == 100000 && checkCounts(big, 100000, 100);
+}
+
+bool checkCopies()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    Tree<String, int> original = buildTree();
+    Tree<String, int> copy = original;
+    copy.getSubtree("X").getSubtree("Z").addElement("f", 6);
+    if(!checkCounts(copy, 6, 3) || !checkCounts(original, 5, 3) || copy.getSubtree("X").getParent() != &copy)
+    {
+        LogError() << "Copies have to update their own counts!";
+        return false;
+    }
+    Tree<String, int> holder;
+    holder.getSubtree("Sub") = std::move(copy);
+    holder.getSubtree("Sub").getSubtree("X").removeElement("c");
+    if(!checkCounts(holder, 5, 4) || holder.getSubtree("Sub").getSubtree("X").getParent() != &holder.getSubtree("Sub"))
+    {
+        LogError() << "Moved trees have to update their new parents!";
+        return false;
+    }
+    return true;
+}
+
+bool checkRemoveEmptyChilds()
+{
+    LogInfo() << "Testcase: " << __FUNCTION__;
+    Tree<String, int> tree = buildTree();
+    tree.getSubtree("X").getSubtree("Z").removeElement("d");
+    tree.getSubtree("X").getSubtree("Z").removeElement("e");
+    tree.getSubtree("Y").getSubtree("Empty");
+    tree.removeEmptyChilds();
+    if(!checkCounts(tree, 3, 1) || !tree.subtreeExist("X") || tree.subtreeExist("Y") || tree.getSubtree("X").subtreeExist("Z"))
+    {
+        LogError() << "Empty subtrees have to be removed recursively!";
+        return false;
+    }
+    return true;
+}